@@ -15,11 +15,12 @@ struct AlgorithmInfo {
     std::string author;
     std::string type;
     bool supportsProgress;
+    bool builtIn = false;  // Runs inside the server: no path, no executable
     json parameters;
     
     static AlgorithmInfo fromInfoFile(const std::string& infoPath);
     bool isValid() const;
     std::vector<std::string> validateParameters(const json& config) const;
     
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(AlgorithmInfo, name, displayName, version, description, author, type, supportsProgress, parameters)
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE(AlgorithmInfo, name, displayName, version, description, author, type, supportsProgress, builtIn, parameters)
 };
@@ -5,7 +5,13 @@
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <memory>
+#include <ostream>
 #include "extern/nlohmann/json.hpp"
+#include "dataset/Dataset.hpp"
+#include "metrics/MetricsRegistry.hpp"
+#include "metrics/PerfCounters.hpp"
+#include "metrics/Tracer.hpp"
 
 using json = nlohmann::json;
 
@@ -14,13 +20,41 @@ public:
     // Callback types
     using ProgressCallback = std::function<void(float progress, const std::string& status, const json& data)>;
     using CompletionCallback = std::function<void(const json& result)>;
+    /**
+     * @brief Algorithm run on the runner thread, without files or a process
+     *
+     * Polls shouldStop, which turns true on stop() or timeout, and reports
+     * progress through report; returns the same result object an external
+     * algorithm writes to its output file.
+     */
+    using InProcessAlgorithm = std::function<json(const std::function<bool()>& shouldStop,
+                                                  const std::function<void(float, const std::string&)>& report)>;
     
-    AlgorithmRunner();
+    static constexpr int DEFAULT_TIMEOUT_SECONDS = 300;
+    
+    explicit AlgorithmRunner(MetricsRegistry* metrics = nullptr, Tracer* tracer = nullptr);
     ~AlgorithmRunner();
     
     bool start(const std::string& algorithmPath, const json& inputData, const json& config, 
                ProgressCallback progressCb = nullptr, CompletionCallback completionCb = nullptr, 
-               int timeoutSeconds = 300);
+               int timeoutSeconds = DEFAULT_TIMEOUT_SECONDS, const std::string& traceId = "");
+    /**
+     * @brief Runs on a stored dataset, streamed to the input file
+     * @param extraSections Sections written next to the dataset's own, e.g. derived lesson requirements
+     */
+    bool start(const std::string& algorithmPath, std::shared_ptr<const Dataset> dataset, const json& config,
+               ProgressCallback progressCb = nullptr, CompletionCallback completionCb = nullptr,
+               int timeoutSeconds = DEFAULT_TIMEOUT_SECONDS, const std::string& traceId = "",
+               const DatasetSections& extraSections = {});
+    /**
+     * @brief Runs a built-in algorithm with the same job lifecycle, callbacks and metrics as a process
+     * @param algorithmName Label for metrics
+     * @param dataset Version the algorithm reads, held until it finishes
+     */
+    bool startInProcess(const std::string& algorithmName, InProcessAlgorithm algorithm,
+                        ProgressCallback progressCb = nullptr, CompletionCallback completionCb = nullptr,
+                        int timeoutSeconds = DEFAULT_TIMEOUT_SECONDS, const std::string& traceId = "",
+                        std::shared_ptr<const Dataset> dataset = nullptr);
     void stop();
     bool isRunning() const;
     float getProgress() const;
@@ -36,21 +70,32 @@ private:
     std::thread processThread;
     std::atomic<bool> running;
     std::atomic<bool> stopRequested;
+    std::atomic<bool> processExited;
     std::atomic<float> progress;
     json resultData;
     std::string statusMessage;
     int exitCode;
     int timeoutSeconds;
     std::chrono::steady_clock::time_point startTime;
+    MetricsRegistry* metrics;
+    Tracer* tracer;
+    std::string traceId;  // messageId of the run request, used for spans
+    std::shared_ptr<const Dataset> pinnedDataset;  // Version the running job reads, held until it finishes
     
     // Callbacks
     ProgressCallback progressCallback;
     CompletionCallback completionCallback;
     
+    bool startWithInput(const std::string& algorithmPath, const std::function<void(std::ostream&)>& writeInput,
+                        const json& config, ProgressCallback progressCb, CompletionCallback completionCb,
+                        int timeoutSeconds, const std::string& traceId,
+                        std::shared_ptr<const Dataset> dataset = nullptr);
     void runAlgorithmProcess();
+    void runInProcess(InProcessAlgorithm algorithm);
     void monitorProgress();
     void cleanupTempFiles();
     std::string generateTempFile(const std::string& prefix);
     bool validateResult(const json& result);
     void updateProgress();
+    void recordRunMetrics();
 };
@@ -34,6 +34,7 @@ private:
     std::string algorithmsDirectory;
     std::map<std::string, AlgorithmInfo> algorithms;
     
+    void registerBuiltins();
     void loadAlgorithmFromDirectory(const std::string& algorithmDir);
     bool isValidAlgorithmDirectory(const std::string& path) const;
 };
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "extern/nlohmann/json.hpp"
+#include "metrics/MetricsRegistry.hpp"
+#include "storage/StorageLog.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * @brief Metadata and results of algorithm runs
+ *
+ * Each run is a job with an ID. With a data directory, job starts and
+ * finishes are recorded in jobs.log and each result is written to
+ * results/<job_id>.json, so results survive a restart. Replaying the log
+ * only restores metadata, and open() compacts it to one record per job once
+ * enough records are superseded.
+ * Jobs that were running when the server stopped come back as "interrupted".
+ *
+ * Only the most recently used results are held in memory; older ones are
+ * read back from their files. Without a data directory, results that fall
+ * out of that set are gone.
+ */
+class JobStore {
+public:
+    static constexpr size_t MAX_CACHED_RESULTS = 16;
+
+private:
+    Gauge& storedJobs;
+    Counter& resultLoads;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, json> jobs;  // job_id, algorithm, dataset_id, content_hash, config, status, ...
+    std::list<std::pair<std::string, std::shared_ptr<const json>>> results;  // Most recent first
+    uint64_t nextId;
+
+    std::string dataDirectory;  // Empty: jobs are kept in memory only
+    StorageLog log;
+
+    void replay(const json& record);
+    void cacheResult(const std::string& jobId, std::shared_ptr<const json> result);  // Caller holds mutex
+    std::string resultPath(const std::string& jobId) const;
+
+public:
+    explicit JobStore(MetricsRegistry& metrics);
+
+    /**
+     * @brief Persists jobs in a directory and restores the ones recorded there
+     * @return false if the directory or its log cannot be used
+     */
+    bool open(const std::string& directory);
+
+    /**
+     * @brief Records the start of a run
+     * @param contentHash Hash of the input dataset, empty for inline data
+     * @return New job ID
+     */
+    std::string begin(const std::string& algorithm, const std::string& datasetId, const std::string& contentHash,
+                      const json& config);
+
+    /**
+     * @brief Records the outcome and result of a run
+     * @param status Final runner status: completed, failed, stopped or timeout
+     */
+    void finish(const std::string& jobId, const std::string& status, const json& result);
+
+    /**
+     * @brief Gets a job's result, reading it from disk unless it was used recently
+     * @return Result, or nullptr if the job is unknown or unfinished
+     */
+    std::shared_ptr<const json> getResult(const std::string& jobId);
+
+    /**
+     * @brief Gets a job's metadata
+     * @return Job info, or null if the job is unknown
+     */
+    json getInfo(const std::string& jobId) const;
+
+    /**
+     * @brief Finds the latest completed job for the same algorithm, content and configuration
+     * @return Job ID, or an empty string if there is none
+     */
+    std::string findCompleted(const std::string& algorithm, const std::string& contentHash, const json& config) const;
+
+    /**
+     * @brief Gets the metadata of all jobs, oldest first
+     */
+    std::vector<json> list() const;
+};
@@ -15,9 +15,13 @@ private:
     void handleRun(const std::string& messageId, const json& request, System& system);
     void handleStop(const std::string& messageId, System& system);
     void handleStatus(const std::string& messageId, System& system);
+    void handleJobs(const std::string& messageId, System& system);
+    void handleResult(const std::string& messageId, const json& request, System& system);
+    void handleEvaluate(const std::string& messageId, const json& request, System& system);
     
     // Callback functions
     void onProgress(float progress, const std::string& status, const json& progressData, 
                    const std::string& messageId, System& system);
-    void onCompletion(const json& resultData, const std::string& messageId, System& system);
+    void onCompletion(const json& resultData, const std::string& messageId, const std::string& jobId,
+                      System& system);
 };
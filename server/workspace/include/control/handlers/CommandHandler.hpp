@@ -14,4 +14,5 @@ private:
     void handleStopCommand(const std::string& messageId, const json& commandData, System& system);
     void handleStatusCommand(const std::string& messageId, const json& commandData, System& system);
     void handlePingCommand(const std::string& messageId, const json& commandData, System& system);
+    void handleMetricsCommand(const std::string& messageId, const json& commandData, System& system);
 };
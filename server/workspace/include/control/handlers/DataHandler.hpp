@@ -1,9 +1,52 @@
 #pragma once
 
+#include <string>
 #include "control/IMessageHandler.hpp"
+#include "dataset/Dataset.hpp"
+#include "extern/nlohmann/json.hpp"
+
+using json = nlohmann::json;
 
 class DataHandler : public IMessageHandler {
 public:
+    /**
+     * @param importDirectory Directory that import may read CSV files from; empty disables file imports
+     */
+    explicit DataHandler(std::string importDirectory = "");
+
     void handle(const std::string& messageId, const std::string& payload, System& system) override;
     MessageType getHandledType() const override;
-};
\ No newline at end of file
+
+private:
+    void handleUpload(const std::string& messageId, json& request, System& system);
+    void handleHas(const std::string& messageId, const json& request, System& system);
+    void handlePatch(const std::string& messageId, const json& request, System& system);
+    void handleGet(const std::string& messageId, const json& request, System& system);
+    void handleList(const std::string& messageId, System& system);
+    void handleDelete(const std::string& messageId, const json& request, System& system);
+    void handleImport(const std::string& messageId, json& request, System& system);
+    void handleValidate(const std::string& messageId, const json& request, System& system);
+    void handleCompile(const std::string& messageId, const json& request, System& system);
+    void handleDemand(const std::string& messageId, const json& request, System& system);
+    void handleDiagnose(const std::string& messageId, const json& request, System& system);
+
+    /**
+     * @brief Runs the integrity validator before new content is stored
+     *
+     * Sends INVALID_DATASET and returns false when errors are found, unless the
+     * request sets "allow_invalid"; the errors are then returned for the response.
+     */
+    bool checkIntegrity(const std::string& messageId, const std::string& command, const DatasetSections& sections,
+                        const json& request, json& validationErrors, System& system);
+
+    /**
+     * @brief Reads a file below the import directory
+     * @return false with error set if the path is outside it or unreadable
+     */
+    bool readImportFile(const std::string& relativePath, std::string& content, std::string& error) const;
+
+    std::string importDirectory;
+
+    void sendError(const std::string& messageId, const std::string& command, const std::string& message,
+                   const std::string& errorCode, System& system);
+};
@@ -14,4 +14,7 @@ private:
     void handlePrintPayload(const std::string& messageId, const json& debugData, System& system);
     void handleUptime(const std::string& messageId, const json& debugData, System& system);
     void handleServerInfo(const std::string& messageId, const json& debugData, System& system);
+    void handleTrace(const std::string& messageId, const json& debugData, System& system);
+    void handleProfile(const std::string& messageId, const json& debugData, System& system);
+    void handleProfileStop(const std::string& messageId, const json& debugData, System& system);
 };
\ No newline at end of file
@@ -10,17 +10,37 @@
 #include "control/HandlerDispatcher.hpp"
 #include "algorithm/AlgorithmScanner.hpp"
 #include "algorithm/AlgorithmRunner.hpp"
+#include "algorithm/JobStore.hpp"
+#include "dataset/DatasetStore.hpp"
+#include "schedule/ModelCache.hpp"
+#include "metrics/MetricsRegistry.hpp"
+#include "metrics/MetricsExporter.hpp"
+#include "metrics/Tracer.hpp"
+#include "metrics/TelemetrySampler.hpp"
+#include "metrics/SamplingProfiler.hpp"
 
 class System {
 private:
+    // Declared first: every other component resolves its metrics on construction
+    MetricsRegistry metrics;
+    Tracer tracer;
+    std::chrono::steady_clock::time_point startTime;
+    
     MessageProcessor messageProcessor;
     HandlerDispatcher dispatcher;
     AlgorithmScanner algorithmScanner;
     AlgorithmRunner algorithmRunner;
+    DatasetStore datasetStore;
+    JobStore jobStore;
+    ModelCache modelCache;
     
     std::vector<std::unique_ptr<IMessageHandler>> handlers;
     std::atomic<bool> running;
     
+    std::unique_ptr<MetricsExporter> metricsExporter;
+    TelemetrySampler telemetrySampler;
+    SamplingProfiler profiler;
+    
 public:
     System(int port);
     ~System();
@@ -81,6 +101,19 @@ public:
      */
     void printStats() const;
     
+    /**
+     * @brief Gets seconds elapsed since the system was created
+     * @return Uptime in seconds
+     */
+    long long getUptimeSeconds() const;
+    
+    /**
+     * @brief Starts serving metrics in Prometheus text format on a local port
+     * @param port TCP port on the loopback interface
+     * @return true if the exporter is listening
+     */
+    bool startMetricsExporter(int port);
+    
     /**
      * @brief Handles a complete message from MessageProcessor
      * @param messageId Message ID
@@ -101,4 +134,53 @@ public:
      * @return Reference to algorithm runner
      */
     AlgorithmRunner& getAlgorithmRunner();
+    
+    /**
+     * @brief Gets the store of uploaded datasets
+     * @return Reference to dataset store
+     */
+    DatasetStore& getDatasetStore();
+    
+    /**
+     * @brief Gets the store of algorithm jobs and their results
+     * @return Reference to job store
+     */
+    JobStore& getJobStore();
+    
+    /**
+     * @brief Gets the cache of compiled dataset versions
+     * @return Reference to model cache
+     */
+    ModelCache& getModelCache();
+    
+    /**
+     * @brief Persists datasets and job results in a directory and restores earlier ones
+     * @param directory Data directory, created if missing
+     * @return true if both stores are persistent
+     */
+    bool openStorage(const std::string& directory);
+    
+    /**
+     * @brief Gets the metrics registry
+     * @return Reference to metrics registry
+     */
+    MetricsRegistry& getMetrics();
+    
+    /**
+     * @brief Gets the request tracer
+     * @return Reference to tracer
+     */
+    Tracer& getTracer();
+    
+    /**
+     * @brief Gets the process telemetry sampler
+     * @return Reference to telemetry sampler
+     */
+    TelemetrySampler& getTelemetry();
+    
+    /**
+     * @brief Gets the sampling CPU profiler
+     * @return Reference to profiler
+     */
+    SamplingProfiler& getProfiler();
 };
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "dataset/Dataset.hpp"
+#include "metrics/MetricsRegistry.hpp"
+
+/**
+ * @brief One CSV table of an import
+ */
+struct CsvTableInput {
+    std::string name;  // Section name, e.g. "teachers", or CsvImport::AVAILABILITY_TABLE
+    std::string text;
+    char delimiter = ',';
+};
+
+/**
+ * @brief Builds dataset sections from CSV tables
+ *
+ * The first record of each table names the fields. Values are converted by
+ * the DatasetSchema type of their field: list fields are split on the list
+ * separator, "data" of constraints is parsed as JSON, and fields the schema
+ * does not know become integers or numbers when they parse as such and
+ * strings otherwise. Empty cells are left out, except for string fields
+ * (empty string) and list fields (empty list).
+ *
+ * The availability table has the columns teacherId and timeBlock with one
+ * row per available block; it replaces availableTimeBlocks of the listed
+ * teachers.
+ */
+class CsvImport {
+public:
+    static constexpr const char* AVAILABILITY_TABLE = "teacherAvailability";
+    static constexpr size_t MAX_THREADS = 8;
+
+    /**
+     * @brief Parses the tables on up to MAX_THREADS threads and merges the results into base
+     * @param base Sections to start from, empty for a new dataset; imported tables replace sections of the same name
+     * @param listSeparator Separator inside list cells, e.g. "MATH;PHYSICS"
+     * @param stats Receives rows and parse time per table
+     * @param errors Receives one message per rejected value, prefixed with table and line
+     * @param metrics Registry for import metrics, may be null
+     * @return New sections; only meaningful when errors is empty
+     */
+    static DatasetSections build(const DatasetSections& base, const std::vector<CsvTableInput>& tables,
+                                 char listSeparator, json& stats, std::vector<std::string>& errors,
+                                 MetricsRegistry* metrics);
+};
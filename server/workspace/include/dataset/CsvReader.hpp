@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief RFC 4180 record reader over an in-memory buffer
+ *
+ * Unquoted fields are returned as views into the buffer without copying.
+ * The scan for the next delimiter, quote or line break compares 16 bytes at
+ * a time with SSE2 (32 with AVX2 when the build enables it) and falls back to
+ * a byte loop elsewhere. Quoted fields may contain delimiters, line breaks and
+ * doubled quotes; they are unescaped into storage owned by the reader.
+ * Both "\n" and "\r\n" end a record.
+ */
+class CsvReader {
+public:
+    CsvReader(std::string_view text, char delimiter);
+
+    /**
+     * @brief Reads the next record
+     * @param fields Receives the fields; views stay valid until the next call
+     * @return false at the end of the input or on malformed quoting (see error())
+     */
+    bool next(std::vector<std::string_view>& fields);
+
+    /**
+     * @brief Gets the 1-based line on which the last record started
+     */
+    size_t line() const { return recordLine; }
+
+    /**
+     * @brief Gets the reason reading stopped early, empty at a regular end
+     */
+    const std::string& error() const { return errorMessage; }
+
+private:
+    std::string_view text;
+    char delimiter;
+    size_t position;
+    size_t currentLine;
+    size_t recordLine;
+    std::string errorMessage;
+    std::deque<std::string> unescaped;  // Quoted fields of the current record
+    size_t unescapedUsed;
+
+    size_t findSpecial(size_t from) const;
+    bool readQuoted(std::string_view& field);
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "extern/nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * @brief One top-level entry of a dataset, e.g. "teachers"
+ *
+ * Array elements are kept behind their own shared pointers, so a patched
+ * version copies pointers instead of entities and shares everything it did not
+ * touch with its parent. Non-array values are stored as a single item.
+ */
+struct DatasetSection {
+    bool isArray = true;
+    std::vector<std::shared_ptr<const json>> items;
+};
+
+// Ordered by key, which is also the key order of the canonical JSON
+using DatasetSections = std::map<std::string, std::shared_ptr<const DatasetSection>>;
+
+class SnapshotSections;
+
+/**
+ * @brief Parsed schedule dataset kept on the server
+ *
+ * Never modified after it is stored, so any number of handlers and algorithm
+ * runs can read it through a shared pointer without locking. A dataset
+ * restored from disk reads its content from the mapped snapshot and decodes
+ * each section the first time it is accessed.
+ */
+struct Dataset {
+    std::string id;
+    std::string parentId;    // Dataset this version was patched from, empty for uploads
+    uint64_t version = 1;    // 1 for uploads, parent version + 1 for patches
+    std::string contentHash; // SHA-256 of the canonical JSON
+    size_t sizeBytes = 0;    // Size of the canonical JSON
+    int64_t createdAt = 0;   // Unix timestamp
+
+    /**
+     * @brief Sets the content of a dataset built in memory
+     */
+    void setSections(DatasetSections content);
+
+    /**
+     * @brief Backs the content by a mapped snapshot, nothing is decoded yet
+     */
+    void setSnapshot(std::shared_ptr<const SnapshotSections> content);
+
+    /**
+     * @brief Gets the whole content, decoding whatever the snapshot has not decoded yet
+     * @throws json::exception if the snapshot is corrupt
+     */
+    const DatasetSections& sections() const;
+
+    /**
+     * @brief Describes the dataset without its content
+     * @return id, hash, version, size, creation time and entity count per section
+     */
+    json summary() const;
+
+    /**
+     * @brief Builds a standalone JSON copy of the content
+     */
+    json toJson() const;
+
+    /**
+     * @brief Streams the canonical JSON without building a copy
+     */
+    void writeJson(std::ostream& out) const;
+
+    /**
+     * @brief Gets a section by name, decoding only that section from a snapshot
+     * @return Section, or nullptr if the dataset has no such key
+     * @throws json::exception if the snapshot is corrupt
+     */
+    const DatasetSection* findSection(const std::string& name) const;
+
+    /**
+     * @brief Normalizes content and splits it into shareable sections
+     * @param content Dataset object, consumed
+     */
+    static DatasetSections split(json content);
+
+    /**
+     * @brief Rewrites numbers so equal values have one representation
+     *
+     * Floats without a fractional part become integers (4.0 -> 4, -0.0 -> 0).
+     * Object keys need no work, the parsed tree already keeps them sorted.
+     */
+    static void normalize(json& value);
+
+    /**
+     * @brief Hashes sections as canonical JSON: compact dump with sorted keys
+     * @param sizeBytes Receives the length of the canonical JSON
+     * @return Hex SHA-256 digest
+     */
+    static std::string computeHash(const DatasetSections& sections, size_t& sizeBytes);
+
+    static void writeSections(const DatasetSections& sections, std::ostream& out);
+
+private:
+    DatasetSections content;                    // Used when snapshot is not set
+    std::shared_ptr<const SnapshotSections> snapshot;
+};
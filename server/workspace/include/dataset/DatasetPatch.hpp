@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "dataset/Dataset.hpp"
+
+/**
+ * @brief Applies typed edit operations to dataset sections
+ *
+ * Operations address array sections ("teachers", "rooms", ...) and their
+ * entities by "id" or by "index" (constraints have no ids):
+ *
+ *   {"op": "add",    "section": "rooms",    "value": {...}}
+ *   {"op": "update", "section": "teachers", "id": "T1", "value": {"availableTimeBlocks": [1, 2]}}
+ *   {"op": "remove", "section": "constraints", "index": 4}
+ *
+ * "update" is an RFC 7386 merge patch of the entity, so null removes a field.
+ * Only touched sections are copied, and of those only the pointer arrays; every
+ * entity that is not edited stays shared with the base version.
+ */
+class DatasetPatch {
+public:
+    /**
+     * @brief Applies all operations or none
+     * @param base Sections of the dataset being patched
+     * @param operations Array of operation objects
+     * @param errors Receives one message per rejected operation
+     * @return New sections; only meaningful when errors is empty
+     */
+    static DatasetSections apply(const DatasetSections& base, const json& operations, std::vector<std::string>& errors);
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Value kinds of entity fields
+ */
+enum class FieldType {
+    String,
+    Integer,
+    Number,
+    StringList,
+    IntegerSet,  // Strictly increasing non-negative ids, e.g. availableTimeBlocks
+    Json         // Free-form value, e.g. constraint data
+};
+
+struct FieldSpec {
+    const char* name;
+    FieldType type;
+};
+
+/**
+ * @brief Expected fields of one entity section
+ */
+struct EntitySchema {
+    const char* section;
+    std::vector<FieldSpec> fields;
+
+    /**
+     * @return Field spec, or nullptr if the entity has no such field
+     */
+    const FieldSpec* findField(const std::string& name) const;
+};
+
+/**
+ * @brief Field layout of the structs in schedule/ScheduleData.hpp
+ *
+ * Datasets stay schemaless JSON; this only tells typed consumers (snapshots,
+ * CSV import) which representation to expect for each known field.
+ */
+class DatasetSchema {
+public:
+    static const std::vector<EntitySchema>& entities();
+
+    /**
+     * @return Schema of a section, or nullptr if the section is not an entity list
+     */
+    static const EntitySchema* find(const std::string& section);
+};
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include "dataset/Dataset.hpp"
+
+/*
+SNAPSHOT FILE LAYOUT (version 1, little endian, every block 8-byte aligned):
+
+    SnapshotFileHeader
+    SnapshotTableHeader[tableCount]
+    string table:  uint64 count, uint64 offsets[count + 1], UTF-8 bytes
+    per table:     SnapshotColumnHeader[columnCount], then column blocks
+    extra blob:    MessagePack object with sections that have no table layout
+
+Every entity section with a known schema (timeBlocks, subjects, groups, rooms,
+teachers, constraints) becomes a table with one column per field. Strings are
+interned once per file and referenced by uint32 id. Each column has a presence
+bitmap; fields that are missing or do not fit the column type are kept in the
+row's "$residual" MessagePack blob, so a snapshot always converts back to
+exactly the JSON it was written from.
+
+Column blocks by type:
+    String      uint32 ids[rows]
+    Integer     int64 values[rows]
+    Number      double values[rows]
+    StringList  uint64 index[rows + 1] into uint32 ids[dataCount]
+    Bitmap      uint64 index[rows + 1] into uint64 words[dataCount], bit n = value n
+    Blob        uint64 index[rows + 1] into bytes[dataCount]
+*/
+
+enum class SnapshotColumnType : uint32_t {
+    String = 1,
+    Integer = 2,
+    Number = 3,
+    StringList = 4,
+    Bitmap = 5,
+    Blob = 6
+};
+
+struct SnapshotFileHeader {
+    char magic[8];              // "PLNSNAP\0"
+    uint32_t version;
+    uint32_t tableCount;
+    uint64_t fileSize;
+    uint64_t stringTableOffset;
+    uint64_t extraOffset;
+    uint64_t extraSize;
+    char contentHash[64];       // Hex SHA-256 of the canonical JSON
+};
+
+struct SnapshotTableHeader {
+    uint32_t nameId;
+    uint32_t columnCount;
+    uint64_t rowCount;
+    uint64_t columnsOffset;
+};
+
+struct SnapshotColumnHeader {
+    uint32_t nameId;
+    uint32_t type;              // SnapshotColumnType
+    uint64_t presenceOffset;
+    uint64_t dataOffset;
+    uint64_t indexOffset;       // 0 for fixed-width types
+    uint64_t dataCount;         // Elements in the data block
+};
+
+class SnapshotView;
+
+/**
+ * @brief Typed, bounds-checked-on-open access to one column of a mapped snapshot
+ */
+class SnapshotColumn {
+public:
+    SnapshotColumn(const SnapshotView& view, const SnapshotColumnHeader& header, uint64_t rowCount);
+
+    std::string_view name() const;
+    SnapshotColumnType type() const { return static_cast<SnapshotColumnType>(header.type); }
+
+    bool has(size_t row) const;
+    std::string_view string(size_t row) const;
+    int64_t integer(size_t row) const;
+    double number(size_t row) const;
+    size_t listSize(size_t row) const;
+    std::string_view listString(size_t row, size_t position) const;
+    const uint64_t* bitmapWords(size_t row, size_t& wordCount) const;
+    std::string_view blob(size_t row) const;
+
+private:
+    const SnapshotView& view;
+    const SnapshotColumnHeader& header;
+    uint64_t rowCount;
+
+    template <typename T>
+    const T* at(uint64_t offset) const;
+    uint64_t indexAt(size_t row) const;
+};
+
+/**
+ * @brief One table of a mapped snapshot
+ */
+class SnapshotTable {
+public:
+    SnapshotTable(const SnapshotView& view, const SnapshotTableHeader& header);
+
+    std::string_view name() const;
+    uint64_t rowCount() const { return header.rowCount; }
+    size_t columnCount() const { return header.columnCount; }
+    SnapshotColumn column(size_t index) const;
+
+private:
+    const SnapshotView& view;
+    const SnapshotTableHeader& header;
+};
+
+/**
+ * @brief Read-only memory mapping of a snapshot file
+ *
+ * open() maps the file and validates every offset, index and string id once,
+ * after which all accessors are plain pointer arithmetic into the mapping.
+ * Nothing is parsed or copied until a caller asks for a value.
+ */
+class SnapshotView {
+public:
+    SnapshotView() = default;
+    ~SnapshotView();
+
+    SnapshotView(const SnapshotView&) = delete;
+    SnapshotView& operator=(const SnapshotView&) = delete;
+
+    /**
+     * @brief Maps and validates a snapshot file
+     * @param error Receives the reason when the file is rejected
+     * @return true if the snapshot can be read
+     */
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    std::string contentHash() const;
+    size_t tableCount() const;
+    SnapshotTable table(size_t index) const;
+    std::string_view string(uint32_t id) const;
+    std::string_view extraBlob() const;
+
+    const uint8_t* data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t* base = nullptr;
+    size_t length = 0;
+    uint64_t stringCount = 0;
+
+    const SnapshotFileHeader& header() const;
+    bool validate(std::string& error);
+};
+
+/**
+ * @brief Conversion between dataset sections and snapshot files
+ */
+class DatasetSnapshot {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    /**
+     * @brief Encodes sections into snapshot bytes
+     */
+    static std::string encode(const DatasetSections& sections, const std::string& contentHash);
+
+    /**
+     * @brief Writes a snapshot atomically (temporary file, then rename)
+     * @return false with error set if the file could not be written
+     */
+    static bool write(const DatasetSections& sections, const std::string& contentHash,
+                      const std::string& path, std::string& error);
+
+    /**
+     * @brief Rebuilds dataset sections from a mapped snapshot
+     * @throws json::exception if a MessagePack blob is corrupt; strings are
+     *         not UTF-8 checked until the sections are dumped
+     */
+    static DatasetSections toSections(const SnapshotView& view);
+
+    /**
+     * @brief Rebuilds the section stored in one table
+     * @throws json::exception if a MessagePack blob in the table is corrupt
+     */
+    static std::shared_ptr<const DatasetSection> toSection(const SnapshotTable& table);
+
+    /**
+     * @brief Rebuilds the sections kept in the extra blob
+     * @throws json::exception if the blob is corrupt
+     */
+    static DatasetSections extraSections(const SnapshotView& view);
+};
+
+/**
+ * @brief Content of a mapped snapshot, decoded one section at a time
+ *
+ * Keeps the file mapped and decodes a table the first time its section is
+ * asked for; the sections of the extra blob are decoded together. Decoded
+ * sections are kept, so each one is decoded at most once. Safe to share
+ * between threads.
+ */
+class SnapshotSections {
+public:
+    explicit SnapshotSections(std::unique_ptr<const SnapshotView> view);
+
+    /**
+     * @brief Gets one section, decoding it on first use
+     * @return Section, or nullptr if the snapshot has no such key
+     * @throws json::exception if the section's bytes are corrupt
+     */
+    std::shared_ptr<const DatasetSection> find(const std::string& name) const;
+
+    /**
+     * @brief Gets every section, decoding the ones not read yet
+     * @return Reference that stays valid and unchanged for the lifetime of this object
+     * @throws json::exception if a section's bytes are corrupt
+     */
+    const DatasetSections& all() const;
+
+private:
+    std::unique_ptr<const SnapshotView> view;
+    std::map<std::string, size_t> tables;  // Section name -> table index
+
+    mutable std::mutex mutex;
+    mutable DatasetSections decoded;
+    mutable bool extraDecoded;
+    mutable bool complete;  // Every section decoded, decoded no longer changes
+
+    void decodeExtra() const;
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "dataset/Dataset.hpp"
+#include "metrics/MetricsRegistry.hpp"
+#include "storage/StorageLog.hpp"
+
+/**
+ * @brief Registry of uploaded datasets
+ *
+ * Uploads are parsed once and referenced by ID afterwards, so a client can run
+ * algorithms on the same data many times without sending it again. Datasets
+ * are also addressed by content: uploading data equal to a stored dataset
+ * returns the stored one instead of keeping a second copy.
+ *
+ * With a data directory every dataset is written as <hash>.snap and recorded
+ * in datasets.log. After a restart only the log is replayed; a dataset's
+ * snapshot is mapped the first time get() asks for it, and each section is
+ * decoded from the mapping the first time it is read.
+ *
+ * Versions are multi-version concurrent in RCU style. The ID and hash
+ * indexes live in an immutable Index that readers load with one atomic
+ * shared_ptr read, so get(), findByHash() and list() never wait for a
+ * writer's copy, edit or I/O. The atomic shared_ptr functions are not
+ * lock-free in libstdc++: loads and publishes take a lock from a small
+ * global pool, so a reader may wait briefly behind a publish, for as long
+ * as a pointer swap takes. Writers serialize among themselves, copy the
+ * index, edit the copy and publish it atomically. Their latency depends on
+ * the number of stored datasets only, never on how many jobs hold a
+ * version. Datasets themselves are immutable; a job pins its version by
+ * holding the shared pointer, and a deleted version is freed when the last
+ * holder lets go.
+ */
+class DatasetStore {
+private:
+    struct Entry {
+        json summary;                           // Dataset::summary() of the stored version
+        std::shared_ptr<const Dataset> dataset; // nullptr until loaded; only via std::atomic_load/store
+        std::atomic<bool> persisted{false};     // Snapshot written and put record logged
+    };
+
+    struct Index {
+        uint64_t epoch = 0;  // Incremented on every publish
+        std::unordered_map<std::string, std::shared_ptr<Entry>> byId;
+        std::unordered_map<std::string, std::string> idsByHash;
+    };
+
+    Gauge& storedDatasets;
+    Gauge& storedBytes;
+    Gauge& loadedDatasets;
+    Gauge& retiredVersions;
+    Counter& deduplicatedUploads;
+    Counter& lazyLoads;
+    Counter& publishedEpochs;
+    Histogram& snapshotWrites;
+    Histogram& snapshotLoads;
+
+    std::shared_ptr<const Index> current;  // Only via std::atomic_load/store
+    std::mutex writeMutex;                 // Serializes writers, readers never take it
+    std::vector<std::weak_ptr<const Dataset>> retired;  // Deleted versions possibly still pinned
+    uint64_t nextId;
+
+    std::string dataDirectory;  // Empty: datasets are kept in memory only
+    StorageLog log;
+
+    std::shared_ptr<const Index> snapshot() const;
+    void publish(std::shared_ptr<Index> next);
+    std::pair<std::shared_ptr<const Dataset>, bool> insert(DatasetSections sections, const std::string& parentId,
+                                                           uint64_t version, bool* persisted);
+    bool isPersisted(const std::string& id) const;
+    std::shared_ptr<const Dataset> load(const json& summary);
+    void replay(Index& index, const json& record);
+    bool writeSnapshot(const Dataset& dataset);
+    void removeUnreferencedSnapshot(const Index& index, const std::string& contentHash);
+    void publishGauges(const Index& index);
+    std::string snapshotPath(const std::string& contentHash) const;
+
+public:
+    explicit DatasetStore(MetricsRegistry& metrics);
+
+    /**
+     * @brief Persists datasets in a directory and restores the ones stored there
+     *
+     * Only reads datasets.log, so it costs milliseconds however large the
+     * stored datasets are. Call before the first add().
+     * @param directory Created if missing
+     * @return false if the directory or its log cannot be used
+     */
+    bool open(const std::string& directory);
+
+    /**
+     * @brief Stores uploaded content unless an equal dataset exists
+     * @param content Dataset JSON object, consumed
+     * @param persisted Set to whether the dataset survives a restart: false without a data directory
+     *                  or when its snapshot or log record could not be written
+     * @return The dataset holding this content, and true if it was newly stored
+     */
+    std::pair<std::shared_ptr<const Dataset>, bool> add(json content, bool* persisted = nullptr);
+
+    /**
+     * @brief Stores content that was built as sections, e.g. by CSV import
+     * @param sections Normalized content
+     * @param persisted As for add()
+     * @return The dataset holding this content, and true if it was newly stored
+     */
+    std::pair<std::shared_ptr<const Dataset>, bool> addSections(DatasetSections sections, bool* persisted = nullptr);
+
+    /**
+     * @brief Stores a new version derived from a stored dataset
+     * @param parent Dataset the sections were derived from
+     * @param sections New content, sharing unchanged sections and items with the parent
+     * @param persisted As for add()
+     * @return The dataset holding this content, and true if it was newly stored
+     */
+    std::pair<std::shared_ptr<const Dataset>, bool> addVersion(const Dataset& parent, DatasetSections sections,
+                                                               bool* persisted = nullptr);
+
+    /**
+     * @brief Gets a stored dataset, loading its snapshot on first use
+     * @param id Dataset ID returned by add()
+     * @return Shared dataset, or nullptr if unknown or its snapshot is unreadable
+     */
+    std::shared_ptr<const Dataset> get(const std::string& id);
+
+    /**
+     * @brief Gets the ID of the stored dataset with the given content hash
+     * @return Dataset ID, or an empty string if no stored content has this hash
+     */
+    std::string findByHash(const std::string& contentHash) const;
+
+    /**
+     * @brief Drops a dataset; readers and derived versions keep their data
+     * @param persisted Set to false if the deletion could not be logged; the dataset is then kept
+     * @return false if the ID is unknown or the deletion could not be logged
+     */
+    bool remove(const std::string& id, bool* persisted = nullptr);
+
+    /**
+     * @brief Gets the summaries of all stored datasets, oldest first, without loading them
+     */
+    std::vector<json> list() const;
+
+    /**
+     * @brief Gets the number of index versions published so far
+     */
+    uint64_t epoch() const;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "dataset/Dataset.hpp"
+
+/**
+ * @brief Result of validating a dataset
+ */
+struct ValidationReport {
+    json errors = json::array();  // {code, section, index, id?, field, value?, message}
+    bool truncated = false;       // More errors exist than were collected
+};
+
+/**
+ * @brief Referential-integrity checks for schedule datasets
+ *
+ * Builds one hash index of entity ids per section, then checks every
+ * reference against it, so a validation is a single linear pass:
+ *
+ *   DUPLICATE_ID       two entities of a section share an id
+ *   UNKNOWN_REFERENCE  Teacher.subjects, Group.parentGroupId or an id in
+ *                      constraint data (teacherId, subjectIds, roomIds,
+ *                      timeBlocks, ...) names no entity; "*" matches all
+ *   PARENT_CYCLE       following parentGroupId leads back to the group
+ *
+ * Entities without a string id are skipped; shape errors are left to the
+ * consumers that read the fields.
+ */
+class DatasetValidator {
+public:
+    static constexpr size_t DEFAULT_MAX_ERRORS = 1000;
+
+    static ValidationReport validate(const DatasetSections& sections, size_t maxErrors = DEFAULT_MAX_ERRORS);
+};
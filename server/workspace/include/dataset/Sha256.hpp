@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Incremental SHA-256 (FIPS 180-4)
+ *
+ * Used for content addresses that clients compute on their side, so it has to
+ * be a standard digest rather than a fast in-process hash.
+ */
+class Sha256 {
+public:
+    Sha256();
+
+    void update(const void* data, size_t length);
+    void update(const std::string& data) { update(data.data(), data.size()); }
+
+    /**
+     * @brief Finishes the digest; the object must not be updated afterwards
+     * @return Lowercase hex digest, 64 characters
+     */
+    std::string hexDigest();
+
+    static std::string hash(const std::string& data);
+
+private:
+    std::array<uint32_t, 8> state;
+    std::array<uint8_t, 64> block;
+    size_t blockLength;
+    uint64_t totalLength;
+
+    void transform(const uint8_t* chunk);
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <chrono>
 #include <vector>
 #include <string>
 #include <optional>
@@ -15,6 +16,8 @@ struct CompleteMessage
 class MessageAssembler {
 private:
     std::map<std::string, std::vector<MessageFrame>> incompleteMessages;
+    std::map<std::string, std::chrono::steady_clock::time_point> firstFragmentTimes;
+    size_t pendingBytes = 0;
     
 public:
     /**
@@ -45,6 +48,13 @@ public:
      */
     std::optional<MessageType> getMessageType(const std::string& messageId) const;
     
+    /**
+     * @brief Gets time elapsed since the first fragment of a message arrived
+     * @param messageId The message ID
+     * @return Optional containing the elapsed time, or std::nullopt if message not found
+     */
+    std::optional<std::chrono::steady_clock::duration> getAssemblyDuration(const std::string& messageId) const;
+    
     /**
      * @brief Cleans up message fragments after processing
      * @param messageId The message ID to cleanup
@@ -56,4 +66,10 @@ public:
      * @return Number of incomplete messages
      */
     size_t getIncompleteMessageCount() const;
+    
+    /**
+     * @brief Gets total payload bytes held in fragments awaiting assembly
+     * @return Number of buffered payload bytes
+     */
+    size_t getPendingBytes() const;
 };
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include "message/MessageFrame.hpp"
 #include "message/MessageAssembler.hpp"
 #include "message/MessageFragmenter.hpp"
+#include "metrics/MetricsRegistry.hpp"
+#include "metrics/PerfCounters.hpp"
+#include "metrics/Tracer.hpp"
 #include <queue>
 #include <mutex>
 #include <condition_variable>
@@ -35,6 +38,16 @@ private:
     // Owned ServerSocket for network communication
     std::unique_ptr<ServerSocket> serverSocket;
     
+    // Pipeline instrumentation, resolved once from the system registry
+    Tracer& tracer;
+    Histogram& queueWaitHistogram;
+    Histogram& reassemblyHistogram;
+    Counter& messagesCompleted;
+    Gauge& receiveQueueDepth;
+    Gauge& reassemblyBytes;
+    Gauge& incompleteMessages;
+    PerfPhase assemblyPhase;
+    
     // Main processing loop
     void processLoop();
     
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include "metrics/MetricsRegistry.hpp"
+
+/**
+ * @brief Minimal HTTP endpoint serving the registry in Prometheus text format
+ *
+ * Binds to the loopback interface only and answers every request with the
+ * current metrics snapshot, which is all a Prometheus scraper needs.
+ */
+class MetricsExporter {
+private:
+    MetricsRegistry& registry;
+    int port;
+    int listenSocket;
+
+    std::thread serveThread;
+    std::atomic<bool> running;
+
+    void serveLoop();
+    void handleClient(int clientSocket);
+
+public:
+    MetricsExporter(MetricsRegistry& registry, int port);
+    ~MetricsExporter();
+
+    /**
+     * @brief Opens the listening socket and starts the serving thread
+     * @return true if the exporter is listening
+     */
+    bool start();
+
+    /**
+     * @brief Stops the serving thread and closes the socket
+     */
+    void stop();
+
+    /**
+     * @brief Checks if exporter is serving
+     * @return true if running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Gets the port the exporter listens on
+     */
+    int getPort() const { return port; }
+};
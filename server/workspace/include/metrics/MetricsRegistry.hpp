@@ -0,0 +1,202 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "extern/nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+enum class MetricKind {
+    Counter,
+    Gauge,
+    Histogram
+};
+
+/**
+ * @brief Common part of every registered metric (identity and kind)
+ */
+class Metric {
+public:
+    Metric(MetricKind kind, std::string name, std::string labels, std::string help);
+    virtual ~Metric() = default;
+
+    MetricKind getKind() const { return kind; }
+    const std::string& getName() const { return name; }
+    const std::string& getLabels() const { return labels; }
+    const std::string& getHelp() const { return help; }
+
+private:
+    MetricKind kind;
+    std::string name;
+    std::string labels;  // Rendered Prometheus label set, e.g. type="Command"
+    std::string help;
+};
+
+/**
+ * @brief Monotonically increasing counter
+ */
+class Counter : public Metric {
+public:
+    Counter(std::string name, std::string labels, std::string help);
+
+    void increment(uint64_t amount = 1) { count.fetch_add(amount, std::memory_order_relaxed); }
+    uint64_t value() const { return count.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> count{0};
+};
+
+/**
+ * @brief Value that can go up and down (queue depths, connections)
+ */
+class Gauge : public Metric {
+public:
+    Gauge(std::string name, std::string labels, std::string help);
+
+    void set(int64_t newValue) { current.store(newValue, std::memory_order_relaxed); }
+    void add(int64_t delta) { current.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t value() const { return current.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> current{0};
+};
+
+/**
+ * @brief HDR-style log-linear histogram
+ *
+ * Values below 16 get exact buckets, every following power of two is split
+ * into 16 linear sub-buckets, so the relative error stays below 6.25% across
+ * the whole range. Recording is a handful of relaxed atomic increments.
+ */
+class Histogram : public Metric {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_MAGNITUDE = 40;  // Values are clamped to 2^40
+    static constexpr int BUCKET_COUNT = SUB_BUCKET_COUNT * (MAX_MAGNITUDE - SUB_BUCKET_BITS + 1);
+
+    Histogram(std::string name, std::string labels, std::string help);
+
+    /**
+     * @brief Records a single observation
+     * @param value Observed value (unit is defined by the metric name, usually microseconds)
+     */
+    void record(uint64_t value);
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return valueSum.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maxValue.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Estimates a quantile from the bucket counts
+     * @param quantile Quantile in range [0, 1]
+     * @return Upper bound of the bucket containing the quantile, 0 if empty
+     */
+    uint64_t percentile(double quantile) const;
+
+    static int bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(int index);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> valueSum{0};
+    std::atomic<uint64_t> maxValue{0};
+};
+
+/**
+ * @brief Records elapsed microseconds into a histogram when it goes out of scope
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram);
+    ~ScopedTimer();
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    /**
+     * @brief Gets microseconds elapsed since construction
+     */
+    uint64_t elapsedMicros() const;
+
+private:
+    Histogram& histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * @brief Lock-free registry of named counters, gauges and histograms
+ *
+ * Metrics live in a fixed-size open addressing table whose slots are
+ * published with compare-and-swap, so lookups and updates never take a lock.
+ * Metrics are never removed; callers on hot paths should look a metric up once
+ * and keep the returned reference.
+ */
+class MetricsRegistry {
+public:
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    static constexpr size_t MAX_METRICS = 1024;
+
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    /**
+     * @brief Gets or creates a counter
+     * @param name Metric name (Prometheus naming rules)
+     * @param labels Label set distinguishing series of the same metric
+     * @param help Description used in the Prometheus HELP line
+     * @return Reference valid for the lifetime of the registry
+     */
+    Counter& counter(const std::string& name, const Labels& labels = {}, const std::string& help = "");
+
+    /**
+     * @brief Gets or creates a gauge
+     */
+    Gauge& gauge(const std::string& name, const Labels& labels = {}, const std::string& help = "");
+
+    /**
+     * @brief Gets or creates a histogram
+     */
+    Histogram& histogram(const std::string& name, const Labels& labels = {}, const std::string& help = "");
+
+    /**
+     * @brief Serializes all metrics for the Command protocol
+     * @return JSON object keyed by metric name
+     */
+    json toJson() const;
+
+    /**
+     * @brief Serializes all metrics in the Prometheus text exposition format
+     */
+    std::string toPrometheus() const;
+
+    /**
+     * @brief Gets number of registered metric series
+     */
+    size_t size() const;
+
+private:
+    std::array<std::atomic<Metric*>, MAX_METRICS> slots{};
+    std::atomic<size_t> registered{0};
+
+    // Returned once the table is full so instrumentation never fails
+    Counter overflowCounter;
+    Gauge overflowGauge;
+    Histogram overflowHistogram;
+
+    Metric* findOrInsert(MetricKind kind, const std::string& name, const Labels& labels, const std::string& help);
+    std::vector<const Metric*> sortedMetrics() const;
+
+    static std::string renderLabels(const Labels& labels);
+};
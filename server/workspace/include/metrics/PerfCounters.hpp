@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "metrics/MetricsRegistry.hpp"
+
+/**
+ * @brief Hardware events collected around instrumented phases
+ */
+enum class PerfEvent {
+    Cycles = 0,
+    Instructions,
+    LlcMisses,
+    BranchMisses
+};
+
+/**
+ * @brief Raw counter values of the calling thread at one point in time
+ */
+struct PerfReading {
+    static constexpr size_t EVENT_COUNT = 4;
+
+    bool valid = false;                          // false when counters are unavailable
+    std::array<bool, EVENT_COUNT> present{};     // Events the kernel/PMU accepted
+    std::array<uint64_t, EVENT_COUNT> values{};
+    uint64_t timeEnabled = 0;                    // For multiplexing correction
+    uint64_t timeRunning = 0;
+};
+
+/**
+ * @brief Per-thread hardware counters backed by perf_event_open
+ *
+ * Each thread lazily opens one event group (user space only) on first use and
+ * keeps it for its lifetime, so a reading is a single read() on the group
+ * leader. When the syscall is refused (perf_event_paranoid, seccomp in
+ * containers, no PMU in VMs) counters are disabled process wide after the
+ * first attempt and every reading comes back invalid.
+ */
+class PerfCounters {
+public:
+    /**
+     * @brief Reads all counters of the calling thread
+     */
+    static PerfReading read();
+
+    /**
+     * @brief Checks if hardware counters work, opening them on this thread if needed
+     */
+    static bool isAvailable();
+
+    /**
+     * @brief Difference between two readings, scaled when the PMU was multiplexed
+     * @return Event count, or 0 if the event is missing from either reading
+     */
+    static uint64_t delta(const PerfReading& start, const PerfReading& end, PerfEvent event);
+
+    static const char* eventName(PerfEvent event);
+};
+
+/**
+ * @brief Metric handles for one named phase
+ *
+ * Resolves planner_phase_* series labelled with the phase once, so hot loops
+ * can keep a PerfPhase around instead of looking metrics up per scope.
+ * Constructed with a null registry it records nothing.
+ */
+class PerfPhase {
+public:
+    PerfPhase(MetricsRegistry* metrics, const std::string& phase);
+
+    void record(const PerfReading& start, const PerfReading& end, uint64_t elapsedMicros) const;
+
+private:
+    Histogram* duration;
+    std::array<Counter*, PerfReading::EVENT_COUNT> events;
+};
+
+/**
+ * @brief RAII helper recording wall time and hardware counters of a phase
+ */
+class PerfScope {
+public:
+    explicit PerfScope(const PerfPhase& phase);
+    PerfScope(MetricsRegistry* metrics, const std::string& phase);
+    ~PerfScope();
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    PerfPhase phase;
+    std::chrono::steady_clock::time_point startTime;
+    PerfReading startReading;
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <signal.h>
+#include "extern/nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * @brief Outcome of one profiling session
+ */
+struct ProfileResult {
+    std::string folded;        // "root;caller;leaf count" lines for flamegraph.pl / speedscope
+    uint64_t samples = 0;
+    uint64_t droppedSamples = 0;
+    int frequencyHz = 0;
+    double durationSeconds = 0.0;
+
+    json toJson() const;
+};
+
+/**
+ * @brief SIGPROF based sampling CPU profiler
+ *
+ * While idle it costs nothing: no timer is armed and no handler installed.
+ * During a session ITIMER_PROF fires proportionally to CPU time used by any
+ * thread of the process, and the signal handler only stores raw return
+ * addresses into a preallocated buffer. Symbolization and stack folding happen
+ * on the controller thread after the timer is disarmed.
+ *
+ * The handler unwinds by walking frame pointers from the interrupted context
+ * (x86-64 and AArch64), since backtrace() is not async-signal-safe. The server
+ * is built with -fno-omit-frame-pointer; a stack ends early at a library
+ * frame compiled without them, such as most of libc.
+ *
+ * Only one session can run per process because signal dispositions are global.
+ */
+class SamplingProfiler {
+public:
+    using CompletionCallback = std::function<void(const ProfileResult& result)>;
+
+    static constexpr int DEFAULT_FREQUENCY_HZ = 99;
+    static constexpr int MAX_FREQUENCY_HZ = 1000;
+    static constexpr int MAX_DURATION_SECONDS = 120;
+    static constexpr size_t MAX_SAMPLES = 16384;
+    static constexpr int MAX_STACK_DEPTH = 48;
+
+    SamplingProfiler();
+    ~SamplingProfiler();
+
+    SamplingProfiler(const SamplingProfiler&) = delete;
+    SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+    /**
+     * @brief Starts a profiling session in the background
+     * @param seconds Session length, clamped to MAX_DURATION_SECONDS
+     * @param frequencyHz Samples per CPU second, clamped to MAX_FREQUENCY_HZ
+     * @param completionCb Called from the controller thread with the folded stacks
+     * @return false if a session is already running in this process
+     */
+    bool start(int seconds, int frequencyHz, CompletionCallback completionCb);
+
+    /**
+     * @brief Ends the running session early; the completion callback still fires
+     */
+    void stop();
+
+    /**
+     * @brief Checks if a session is in progress
+     */
+    bool isRunning() const;
+
+private:
+    struct Sample {
+        int depth;
+        void* frames[MAX_STACK_DEPTH];
+    };
+
+    std::unique_ptr<Sample[]> samples;
+    std::atomic<size_t> sampleCount;
+    std::atomic<uint64_t> droppedSamples;
+    std::atomic<int> handlersInFlight;
+
+    std::thread controllerThread;
+    std::atomic<bool> running;
+    bool stopRequested;
+    std::mutex stopMutex;
+    std::condition_variable stopCondition;
+
+    int frequencyHz;
+    std::chrono::steady_clock::time_point startTime;
+    CompletionCallback completionCallback;
+
+    void runSession(int seconds);
+    ProfileResult buildResult() const;
+
+    static void handleSignal(int signal, siginfo_t* info, void* context);
+    void recordSample(void* context);
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "metrics/MetricsRegistry.hpp"
+
+/**
+ * @brief Process resource usage captured at one point in time
+ */
+struct ProcessTelemetry {
+    int64_t sampledAt = 0;           // Unix timestamp of the sample
+    int64_t residentBytes = 0;       // VmRSS
+    int64_t peakResidentBytes = 0;   // VmHWM
+    int64_t virtualBytes = 0;        // VmSize
+    double userCpuSeconds = 0.0;
+    double systemCpuSeconds = 0.0;
+    double cpuPercent = 0.0;         // Over the last sampling interval, 100 = one core
+    int64_t voluntaryContextSwitches = 0;
+    int64_t involuntaryContextSwitches = 0;
+    int64_t threadCount = 0;
+    int64_t openFileDescriptors = 0;
+    int64_t receiveQueueDepth = 0;
+    int64_t sendQueueDepth = 0;
+    int64_t reassemblyBytes = 0;
+    int64_t incompleteMessages = 0;
+
+    json toJson() const;
+};
+
+/**
+ * @brief Background sampler of /proc/self and getrusage
+ *
+ * Samples on its own thread and publishes an immutable snapshot, so request
+ * handlers only copy a shared pointer and never touch /proc themselves. Each
+ * sample is mirrored into process_* gauges of the metrics registry.
+ */
+class TelemetrySampler {
+private:
+    MetricsRegistry& metrics;
+    std::chrono::milliseconds interval;
+
+    std::thread samplerThread;
+    std::atomic<bool> running;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+
+    std::shared_ptr<const ProcessTelemetry> latest;  // Accessed with std::atomic_load/store
+
+    // Previous CPU reading for the utilisation estimate
+    double lastCpuSeconds;
+    std::chrono::steady_clock::time_point lastSampleTime;
+
+    void sampleLoop();
+    ProcessTelemetry takeSample();
+    void publishGauges(const ProcessTelemetry& sample);
+
+public:
+    static constexpr std::chrono::milliseconds DEFAULT_INTERVAL{1000};
+
+    explicit TelemetrySampler(MetricsRegistry& metrics, std::chrono::milliseconds interval = DEFAULT_INTERVAL);
+    ~TelemetrySampler();
+
+    /**
+     * @brief Takes a first sample and starts the sampling thread
+     */
+    void start();
+
+    /**
+     * @brief Stops the sampling thread
+     */
+    void stop();
+
+    /**
+     * @brief Gets the most recent sample without blocking
+     * @return Latest snapshot, never null after start()
+     */
+    std::shared_ptr<const ProcessTelemetry> getLatest() const;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "extern/nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * @brief One timed pipeline stage of a message
+ */
+struct TraceSpan {
+    static constexpr size_t MAX_ID_LENGTH = 48;
+    static constexpr size_t MAX_NAME_LENGTH = 32;
+
+    char messageId[MAX_ID_LENGTH];
+    char name[MAX_NAME_LENGTH];
+    int64_t startNs;    // Relative to tracer creation
+    int64_t endNs;
+    uint32_t threadId;
+};
+
+/**
+ * @brief Lightweight span tracer keyed by messageId
+ *
+ * Every recording thread owns a fixed ring buffer, so recording never takes
+ * a lock and never allocates. Readers copy slots under a per-slot sequence
+ * number and skip those that are being overwritten. Buffers of exited threads
+ * are handed to the next new thread instead of being freed.
+ */
+class Tracer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t SPANS_PER_THREAD = 2048;
+
+    Tracer();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    /**
+     * @brief Records a finished span on the calling thread
+     * @param messageId Message the span belongs to
+     * @param name Pipeline stage name, e.g. "socket.receive"
+     * @param start Stage start time
+     * @param end Stage end time
+     */
+    void record(const std::string& messageId, const char* name, Clock::time_point start, Clock::time_point end);
+
+    /**
+     * @brief Names the calling thread in exported traces
+     * @param name Human readable thread name
+     */
+    void nameCurrentThread(const std::string& name);
+
+    /**
+     * @brief Enables or disables recording
+     */
+    void setEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Collects recorded spans
+     * @param windowMs Only spans that ended within this many milliseconds, 0 for all
+     * @param messageId Only spans of this message, empty for all
+     * @return Spans sorted by start time
+     */
+    std::vector<TraceSpan> collect(uint64_t windowMs = 0, const std::string& messageId = "") const;
+
+    /**
+     * @brief Exports spans in Chrome about:tracing / Perfetto JSON format
+     * @param windowMs Only spans that ended within this many milliseconds, 0 for all
+     * @param messageId Only spans of this message, empty for all
+     * @return JSON object with a traceEvents array
+     */
+    json exportChromeTrace(uint64_t windowMs = 0, const std::string& messageId = "") const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};  // Odd while the slot is being written
+        TraceSpan span;
+    };
+
+    struct ThreadBuffer {
+        uint32_t threadId;  // Reassigned when the buffer is reused
+        std::atomic<bool> inUse{true};
+        std::atomic<uint64_t> writeIndex{0};
+        std::array<Slot, SPANS_PER_THREAD> slots;
+    };
+
+    // Per-thread handle releasing the buffer for reuse when the thread exits
+    struct LocalHandle {
+        uint64_t ownerId = 0;
+        std::shared_ptr<ThreadBuffer> buffer;
+        ~LocalHandle();
+    };
+
+    uint64_t instanceId;  // Distinguishes tracers created at the same address
+    Clock::time_point epoch;
+    std::atomic<bool> enabled;
+
+    mutable std::mutex buffersMutex;  // Guards registration only, never recording
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::map<uint32_t, std::string> threadNames;
+    uint32_t nextThreadId;
+
+    ThreadBuffer& localBuffer();
+    int64_t toRelativeNs(Clock::time_point time) const;
+};
+
+/**
+ * @brief Records a span covering its own lifetime
+ *
+ * The messageId reference must outlive the scope.
+ */
+class TraceScope {
+public:
+    TraceScope(Tracer* tracer, const std::string& messageId, const char* name);
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    Tracer* tracer;
+    const std::string& messageId;
+    const char* name;
+    Tracer::Clock::time_point start;
+};
@@ -1,7 +1,11 @@
 #pragma once
 
 #include "message/MessageFrame.hpp"
+#include "metrics/MetricsRegistry.hpp"
+#include "metrics/Tracer.hpp"
 #include <string>
+#include <chrono>
+#include <functional>
 #include <thread>
 #include <mutex>
 #include <atomic>
@@ -15,6 +19,12 @@
 #include <unistd.h>
 #include <cstring>
 
+// Frame waiting in a send or receive queue together with its enqueue time
+struct QueuedFrame {
+    MessageFrame frame;
+    std::chrono::steady_clock::time_point queuedAt;
+};
+
 class ServerSocket {
 private:
     void receiveMessages();
@@ -32,19 +42,29 @@ private:
 
     std::atomic<bool> running;
 
-    std::queue<MessageFrame> sendQueue;
+    std::queue<QueuedFrame> sendQueue;
     std::mutex sendMutex;
     std::condition_variable sendCondition;
 
-    std::queue<MessageFrame> receiveQueue;
+    std::queue<QueuedFrame> receiveQueue;
     std::mutex receiveMutex;
     std::condition_variable receiveCondition;
 
     std::function<void()> onConnectedCallback;
     std::function<void()> onDisconnectedCallback;
 
+    // Optional instrumentation, owned by System
+    Counter* framesReceivedTotal;
+    Counter* bytesReceivedTotal;
+    Counter* framesSentTotal;
+    Counter* bytesSentTotal;
+    Counter* parseErrorsTotal;
+    Gauge* sendQueueDepth;
+    Gauge* receiveQueueDepth;
+    Tracer* tracer;
+
 public:
-    ServerSocket(int port);
+    ServerSocket(int port, MetricsRegistry* metrics = nullptr, Tracer* tracer = nullptr);
     ~ServerSocket();
 
     bool accept();
@@ -54,7 +74,7 @@ public:
 
     std::mutex& getReceiveMutex();
     std::condition_variable& getReceiveCondition();
-    std::queue<MessageFrame>& getReceiveQueue();
+    std::queue<QueuedFrame>& getReceiveQueue();
     
     void setOnConnectedCallback(std::function<void()> callback);
     void setOnDisconnectedCallback(std::function<void()> callback);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "schedule/ProblemModel.hpp"
+
+/**
+ * @brief One scheduled class in dense indices
+ */
+struct Placement {
+    EntityId subject = NO_ENTITY;
+    EntityId teacher = NO_ENTITY;
+    EntityId group = NO_ENTITY;
+    EntityId room = NO_ENTITY;
+    EntityId timeBlock = NO_ENTITY;
+};
+
+/**
+ * @brief A schedule (Schedule::events) resolved against a ProblemModel
+ *
+ * Events keep their position; eventIds holds the original "id" values so a
+ * result can be written back in the client's terms.
+ */
+struct Assignment {
+    std::vector<Placement> events;
+    std::vector<json> eventIds;
+
+    /**
+     * @brief Resolves {"events": [...]} or a bare event array
+     * @param errors Receives {index, field, value, message} for every event that was left out
+     * @return Assignment of the events whose ids all resolved
+     */
+    static Assignment fromJson(const ProblemModel& model, const json& schedule, json& errors);
+
+    /**
+     * @brief Writes the events back with string ids
+     */
+    json toJson(const ProblemModel& model) const;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Word-parallel kernels over bit rows
+ *
+ * A row is an array of 64-bit words, bit i of the row is bit i % 64 of word
+ * i / 64. The loops process 256 bits at a time with AVX2, 128 bits with SSE2,
+ * and single words elsewhere. On x86-64 the AVX2 loops are compiled for that
+ * target alone and used when the CPU reports AVX2 at startup, so the default
+ * build runs them without -mavx2; a build with -mavx2 uses them directly.
+ * Popcount uses a nibble lookup (pshufb) under AVX2 and in-register bit sums
+ * under SSE2, so it does not depend on the popcnt instruction. Rows of a
+ * BitMatrix are padded to whole 256-bit blocks, so the vector loops need no
+ * tail for them, but every kernel accepts any word count.
+ */
+class BitKernels {
+public:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    // out &= a
+    static void andAssign(uint64_t* out, const uint64_t* a, size_t words);
+    // out |= a
+    static void orAssign(uint64_t* out, const uint64_t* a, size_t words);
+    // out &= ~a
+    static void andNotAssign(uint64_t* out, const uint64_t* a, size_t words);
+    // out = a & b
+    static void andInto(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t words);
+
+    static size_t popcount(const uint64_t* a, size_t words);
+
+    /**
+     * @brief Counts the bits set in both rows without materializing a & b
+     */
+    static size_t andPopcount(const uint64_t* a, const uint64_t* b, size_t words);
+
+    /**
+     * @return true if a & b has any bit set
+     */
+    static bool intersects(const uint64_t* a, const uint64_t* b, size_t words);
+
+    /**
+     * @return Index of the lowest set bit, or NPOS
+     */
+    static size_t firstSet(const uint64_t* a, size_t words);
+
+    /**
+     * @return Index of the lowest bit set in both rows, or NPOS
+     */
+    static size_t firstSetAnd(const uint64_t* a, const uint64_t* b, size_t words);
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Dense rows x columns bit matrix
+ *
+ * Each row is a run of 64-bit words padded to a multiple of 256 bits, so
+ * rows can be handed straight to BitKernels. Padding bits are always zero;
+ * a popcount of a row counts columns only.
+ */
+class BitMatrix {
+public:
+    static constexpr size_t WORD_BITS = 64;
+    static constexpr size_t ROW_ALIGN_WORDS = 4;
+
+    BitMatrix() = default;
+    BitMatrix(size_t rows, size_t columns, bool value = false);
+
+    size_t rows() const { return rowCount; }
+    size_t columns() const { return columnCount; }
+    size_t rowWords() const { return wordsPerRow; }
+
+    uint64_t* row(size_t r) { return bits.data() + r * wordsPerRow; }
+    const uint64_t* row(size_t r) const { return bits.data() + r * wordsPerRow; }
+
+    bool test(size_t r, size_t c) const { return (row(r)[c / WORD_BITS] >> (c % WORD_BITS)) & 1; }
+    void set(size_t r, size_t c) { row(r)[c / WORD_BITS] |= uint64_t(1) << (c % WORD_BITS); }
+    void reset(size_t r, size_t c) { row(r)[c / WORD_BITS] &= ~(uint64_t(1) << (c % WORD_BITS)); }
+
+    /**
+     * @brief Sets every column of a row
+     */
+    void fillRow(size_t r);
+
+    /**
+     * @brief Builds the columns x rows matrix
+     */
+    BitMatrix transposed() const;
+
+    /**
+     * @brief Gets the set columns of a row in ascending order
+     */
+    std::vector<uint32_t> columnsOf(size_t r) const;
+
+    /**
+     * @brief Words needed for one row of the given width, including padding
+     */
+    static size_t wordsFor(size_t columns);
+
+private:
+    size_t rowCount = 0;
+    size_t columnCount = 0;
+    size_t wordsPerRow = 0;
+    std::vector<uint64_t> bits;
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+/**
+ * @brief Names and versions of the algorithms that run in-process
+ *
+ * Kept apart from the solvers so the algorithm list can name them without
+ * pulling in the schedule stack.
+ */
+class BuiltInAlgorithms {
+public:
+    static constexpr const char* GREEDY_NAME = "greedy_dsatur";
+    static constexpr const char* GREEDY_VERSION = "1.0";
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <memory>
+#include "schedule/LessonDemand.hpp"
+#include "schedule/LessonDomains.hpp"
+
+/**
+ * @brief Lessons that can never share a time block, as an undirected graph in CSR form
+ *
+ * Every lesson of every LessonRequirement is one node, numbered requirement
+ * by requirement. Two lessons are joined when they always clash:
+ *
+ *   - their groups are related (same group, or one an ancestor of the
+ *     other), except the same lesson of the parallel sections of a split
+ *   - both requirements have the same single teacher left in LessonDomains
+ *   - both requirements have the same single room left in LessonDomains
+ *
+ * Each group chain, fixed teacher and fixed room is a clique. One with more
+ * lessons than there are time blocks can never be placed in full; it is
+ * still joined and counted in oversized_cliques. Pairs cost memory
+ * quadratically, so cliques are expanded into edges smallest first up to
+ * MAX_PAIRS. The rest stay implicit: only their member requirements are
+ * kept, and forEachNeighbour() walks them next to the edges, so the
+ * relation is complete either way. Workers take cliques in turn and emit
+ * their pairs into buckets by source lesson range. Each worker then sorts
+ * and deduplicates one range, and the ranges are copied into one offsets
+ * array and one neighbour array. Explicit neighbours of a lesson are
+ * ascending and contiguous, so a scan reads one run of memory.
+ */
+class ConflictGraph {
+public:
+    static constexpr size_t PARALLEL_THRESHOLD = 4096;  // Fewer lessons are built on the calling thread
+    static constexpr size_t MAX_THREADS = 8;
+    static constexpr uint64_t MAX_PAIRS = uint64_t(1) << 24;  // Directed pairs emitted, 128 MB in buckets
+
+    static std::shared_ptr<const ConflictGraph> build(const ProblemModel& model, const LessonDemand& demand,
+                                                      const LessonDomains& domains);
+
+    size_t lessons() const { return requirementIndex.size(); }
+
+    /**
+     * @return Edges stored explicitly, without the pairs of implicit cliques
+     */
+    size_t edges() const { return neighbourIds.size() / 2; }
+
+    /**
+     * @brief Calls visit(v) for every lesson v that can never share a time block with lesson
+     *
+     * Explicit neighbours come first, in ascending order, then the members of
+     * the implicit cliques of the lesson. A lesson joined through several
+     * cliques may be visited more than once.
+     */
+    template <typename Visit>
+    void forEachNeighbour(EntityId lesson, Visit visit) const {
+        for (uint64_t i = offsets[lesson]; i < offsets[lesson + 1]; ++i) {
+            visit(neighbourIds[i]);
+        }
+
+        uint32_t a = requirementIndex[lesson];
+        EntityId k = lesson - requirementLessons[a];
+        for (uint64_t i = cliqueOffsets[a]; i < cliqueOffsets[a + 1]; ++i) {
+            const ImplicitClique& clique = implicitCliques[cliqueIds[i]];
+            for (uint32_t j = clique.begin; j < clique.end; ++j) {
+                uint32_t b = implicitRequirements[j];
+                bool parallel = clique.group && sameSplit(a, b);
+                for (EntityId v = requirementLessons[b]; v < requirementLessons[b + 1]; ++v) {
+                    if (v != lesson && !(parallel && v - requirementLessons[b] == k)) {
+                        visit(v);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @return Number of lessons joined with this one; one joined through several cliques counts once per clique
+     */
+    uint32_t degree(EntityId lesson) const {
+        return static_cast<uint32_t>(offsets[lesson + 1] - offsets[lesson]) + implicitDegree[requirementIndex[lesson]];
+    }
+    uint32_t maxDegree() const { return highestDegree; }
+
+    /**
+     * @return Lessons by descending degree, ties by lesson number
+     */
+    const std::vector<EntityId>& degreeOrder() const { return byDegree; }
+
+    size_t requirementOf(EntityId lesson) const { return requirementIndex[lesson]; }
+    EntityId firstLesson(size_t requirement) const { return requirementLessons[requirement]; }
+
+    /**
+     * @brief Size, degrees, clique count and build time
+     */
+    json summary() const;
+
+private:
+    static constexpr uint32_t NO_SPLIT = static_cast<uint32_t>(-1);
+
+    struct ImplicitClique {
+        uint32_t begin;  // Range in implicitRequirements
+        uint32_t end;
+        bool group;      // Parallel sections of a split may share blocks
+    };
+
+    std::vector<uint64_t> offsets;         // Per lesson, plus one, into neighbourIds
+    std::vector<EntityId> neighbourIds;
+    std::vector<EntityId> byDegree;
+    std::vector<uint32_t> requirementIndex;   // Per lesson
+    std::vector<EntityId> requirementLessons; // Per requirement, plus one: its first lesson
+    std::vector<uint32_t> splitOf;            // Per requirement: first requirement of its parallel split, or NO_SPLIT
+
+    std::vector<ImplicitClique> implicitCliques;  // Over MAX_PAIRS, kept as member lists
+    std::vector<uint32_t> implicitRequirements;
+    std::vector<uint64_t> cliqueOffsets;          // Per requirement, plus one, into cliqueIds
+    std::vector<uint32_t> cliqueIds;              // Implicit cliques each requirement belongs to
+    std::vector<uint32_t> implicitDegree;         // Per requirement: lessons joined through implicit cliques
+
+    uint32_t highestDegree = 0;
+    size_t cliqueCount = 0;
+    size_t oversizedCliques = 0;  // More lessons than time blocks
+    size_t threadCount = 1;
+    int64_t buildMicros = 0;
+
+    bool sameSplit(uint32_t a, uint32_t b) const { return splitOf[a] != NO_SPLIT && splitOf[a] == splitOf[b]; }
+
+    friend class ConflictGraphBuilder;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include "schedule/ConstraintRules.hpp"
+
+/**
+ * @brief Constraints of a ProblemModel compiled into typed rules
+ *
+ * Every Constraint::data is read once, here: ids become EntitySets, time
+ * selections become time block sets, thresholds become integers in minutes
+ * or counts, and importance becomes a penalty tier and weight. Evaluating a
+ * schedule afterwards touches no JSON and compares no strings.
+ *
+ * Rules are indexed by scope and owner, so an evaluator looking at one
+ * teacher's Monday visits only the rules that can apply to that teacher.
+ * GroupSplit, GroupMerge and Custom describe permissions or application
+ * data rather than penalties and are listed as not evaluated.
+ */
+class CompiledConstraints {
+public:
+    static std::shared_ptr<const CompiledConstraints> compile(const ProblemModel& model);
+
+    const std::vector<ConstraintRule>& rules() const { return ruleList; }
+    const RuleTables& tables() const { return ruleTables; }
+    ConstraintType typeOf(size_t rule) const { return ruleTypes[rule]; }
+
+    /**
+     * @brief Gets the rules of a scope that apply to an owner
+     * @param owner Teacher for teacher scopes, group for group scopes, 0 for Event and Global
+     * @return Indices into rules()
+     */
+    IdRange rulesFor(RuleScope scope, EntityId owner) const;
+    bool hasRules(RuleScope scope) const { return !scopes[static_cast<size_t>(scope)].rules.empty(); }
+
+    static RuleScope scopeOf(const ConstraintRule& rule);
+
+    /**
+     * @brief Constraints that were not compiled, with the reason
+     * @return Array of {index, type, code, message}
+     */
+    const json& skipped() const { return skippedList; }
+
+    /**
+     * @brief Describes the rules: counts per type and tier, skipped constraints
+     */
+    json summary() const;
+
+private:
+    struct ScopeIndex {
+        std::vector<uint32_t> offsets;  // Per owner, plus one
+        std::vector<EntityId> rules;
+    };
+
+    std::vector<ConstraintRule> ruleList;
+    std::vector<ConstraintType> ruleTypes;
+    RuleTables ruleTables;
+    ScopeIndex scopes[RULE_SCOPES];
+    json skippedList = json::array();
+
+    friend class ConstraintCompiler;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <initializer_list>
+#include <vector>
+#include "schedule/ProblemModel.hpp"
+
+/**
+ * @brief Readers for the shared fields of Constraint::data
+ *
+ * The shapes are documented in ScheduleData.hpp and CONSTRAINT_SYSTEM.md.
+ * Every compiled form of a constraint (feasibility matrices, evaluators)
+ * reads ids and times through these, so all of them agree on what a
+ * constraint covers.
+ */
+class ConstraintData {
+public:
+    enum class Scope {
+        Absent,  // None of the keys is present
+        All,     // "*"
+        Listed
+    };
+
+    /**
+     * @brief Collects the entities named under any of keys
+     *
+     * Values may be a string or an array of strings. Unknown ids are
+     * skipped, the validator reports them.
+     */
+    static Scope resolveIds(const json& data, std::initializer_list<const char*> keys, const IdTable& table,
+                            std::vector<EntityId>& ids);
+
+    /**
+     * @brief Sets the time blocks a constraint names
+     *
+     * "timeBlocks" selects by id; "days" and "timeRanges" together select
+     * blocks on one of the days that overlap one of the ranges, either may
+     * be left out. Data naming no time selects every block.
+     *
+     * @param row BitMatrix::wordsFor(timeBlocks) words, overwritten
+     */
+    static void selectTimeBlocks(const json& data, const ProblemModel& model, uint64_t* row);
+
+    /**
+     * @return Minutes since midnight of an hhmm time (1350 -> 830)
+     */
+    static int minutesOf(int hhmm) { return (hhmm / 100) * 60 + hhmm % 100; }
+};
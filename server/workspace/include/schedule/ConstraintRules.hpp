@@ -0,0 +1,314 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <variant>
+#include <vector>
+#include "schedule/Assignment.hpp"
+#include "schedule/BitMatrix.hpp"
+#include "schedule/ProblemModel.hpp"
+
+/**
+ * @brief Penalty tier of a rule, from Constraint::importance
+ */
+enum class PenaltyTier : uint8_t {
+    Hard,       // Critical: the schedule is invalid while violated
+    Important,
+    Optional
+};
+
+constexpr size_t PENALTY_TIERS = 3;
+
+// Cost of one violation per tier; a constraint's "priority" (1-10) multiplies it
+constexpr int64_t TIER_WEIGHTS[PENALTY_TIERS] = {1000000, 1000, 1};
+
+inline const char* tierName(PenaltyTier tier) {
+    switch (tier) {
+        case PenaltyTier::Hard: return "hard";
+        case PenaltyTier::Important: return "important";
+        default: return "optional";
+    }
+}
+
+/**
+ * @brief Events a rule looks at together
+ *
+ * Event rules judge one placement alone. The other scopes see the events of
+ * one owner (teacher or group) in time order, per day or for the whole
+ * week; Global sees every event. A move only changes the buckets of the
+ * owners and days it touches, which is what incremental evaluation relies on.
+ */
+enum class RuleScope : uint8_t {
+    Event,
+    TeacherDay,
+    TeacherWeek,
+    GroupDay,
+    GroupWeek,
+    Global
+};
+
+constexpr size_t RULE_SCOPES = 6;
+
+/**
+ * @brief Subset of the entities of one kind, or all of them
+ */
+class EntitySet {
+public:
+    EntitySet() = default;
+    explicit EntitySet(size_t universe, bool all = false) : everything(all), bits(BitMatrix::wordsFor(universe), 0) {}
+
+    void add(EntityId id) { bits[id / 64] |= uint64_t(1) << (id % 64); }
+    bool contains(EntityId id) const { return everything || ((bits[id / 64] >> (id % 64)) & 1); }
+    bool all() const { return everything; }
+
+private:
+    bool everything = false;
+    std::vector<uint64_t> bits;
+};
+
+/**
+ * @brief Precomputed time and qualification tables the rules read
+ *
+ * Times are minutes from the start of the week, with days in the order of
+ * ProblemModel::days(), so comparisons need no day lookups.
+ */
+struct RuleTables {
+    std::vector<EntityId> blockDay;   // Per time block
+    std::vector<int32_t> blockStart;  // Week minutes
+    std::vector<int32_t> blockEnd;
+    std::vector<int32_t> roomCapacity;
+    BitMatrix qualified;              // teachers x subjects, from Teacher.subjects
+};
+
+/**
+ * @brief Events of one bucket in time order, as indices into an event array
+ */
+struct EventRange {
+    const uint32_t* first;
+    const uint32_t* last;
+    const Placement* events;
+
+    const uint32_t* begin() const { return first; }
+    const uint32_t* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    const Placement& operator[](size_t i) const { return events[first[i]]; }
+};
+
+struct RuleBase {
+    uint32_t constraint = 0;  // Position in ProblemModel::constraints()
+    PenaltyTier tier = PenaltyTier::Optional;
+    int64_t weight = 1;       // Cost of one violation
+};
+
+/**
+ * @brief TeacherUnavailable, GroupUnavailable (inside the window violates)
+ *        and TeacherPreferred (outside violates); one violation per event
+ */
+struct TimeWindowRule : RuleBase {
+    bool byTeacher = true;  // Owners are teachers, else groups
+    EntitySet owners;
+    EntitySet subjects;
+    EntitySet window;       // Time blocks
+    bool mustBeInside = false;
+
+    int64_t violations(const Placement& event, const RuleTables&) const {
+        if (!owners.contains(byTeacher ? event.teacher : event.group) || !subjects.contains(event.subject)) {
+            return 0;
+        }
+        return window.contains(event.timeBlock) != mustBeInside ? 1 : 0;
+    }
+};
+
+/**
+ * @brief RequiredRoomFeature, PreferredRoom (a room outside the set violates)
+ *        and ForbiddenRoom (inside violates); one violation per event
+ */
+struct RoomRule : RuleBase {
+    EntitySet subjects;
+    EntitySet rooms;
+    bool mustBeInside = true;
+
+    int64_t violations(const Placement& event, const RuleTables&) const {
+        if (!subjects.contains(event.subject)) {
+            return 0;
+        }
+        return rooms.contains(event.room) != mustBeInside ? 1 : 0;
+    }
+};
+
+/**
+ * @brief MinimumRoomCapacity; one violation per event in a room too small for its group
+ */
+struct CapacityRule : RuleBase {
+    std::vector<int32_t> required;  // Per group, 0 where the rule does not apply
+
+    int64_t violations(const Placement& event, const RuleTables& tables) const {
+        return tables.roomCapacity[event.room] < required[event.group] ? 1 : 0;
+    }
+};
+
+/**
+ * @brief TeacherSubjectMatch; one violation per event of a subject the teacher may not teach
+ */
+struct QualificationRule : RuleBase {
+    EntitySet teachers;
+    bool ownSubjects = true;  // Teacher.subjects, else allowedSubjects
+    EntitySet allowedSubjects;
+
+    int64_t violations(const Placement& event, const RuleTables& tables) const {
+        if (!teachers.contains(event.teacher)) {
+            return 0;
+        }
+        bool allowed = ownSubjects ? tables.qualified.test(event.teacher, event.subject)
+                                   : allowedSubjects.contains(event.subject);
+        return allowed ? 0 : 1;
+    }
+};
+
+/**
+ * @brief MaxTeachingHours; one violation per started hour over the limit
+ */
+struct TeachingLoadRule : RuleBase {
+    EntitySet teachers;
+    int32_t maxMinutes = 0;
+    bool perWeek = false;  // "period": "week", else per day
+
+    int64_t violations(const EventRange& events, const RuleTables& tables) const;
+};
+
+/**
+ * @brief MinBreakBetweenClasses; one violation per pair of neighbouring
+ *        classes closer than the break (overlaps are clashes, not counted)
+ */
+struct BreakRule : RuleBase {
+    EntitySet teachers;
+    int32_t minBreakMinutes = 0;
+
+    int64_t violations(const EventRange& events, const RuleTables& tables) const;
+};
+
+/**
+ * @brief MaxClassesPerDay; one violation per class over the limit
+ */
+struct DailyLoadRule : RuleBase {
+    EntitySet groups;
+    int32_t maxClasses = 0;
+
+    int64_t violations(const EventRange& events, const RuleTables&) const {
+        int64_t count = static_cast<int64_t>(events.size());
+        return count > maxClasses ? count - maxClasses : 0;
+    }
+};
+
+/**
+ * @brief AvoidConsecutive and ConsecutiveClasses over back-to-back runs of
+ *        the rule's subjects: a run longer than the limit violates once per
+ *        extra class (avoid), a run shorter than the limit violates once (require)
+ */
+struct ConsecutiveRule : RuleBase {
+    EntitySet groups;
+    EntitySet subjects;
+    int32_t limit = 1;
+    bool avoid = true;
+
+    int64_t violations(const EventRange& events, const RuleTables& tables) const;
+};
+
+/**
+ * @brief SpreadAcrossWeek: one violation per class on a day already used or
+ *        closer than minDaysBetween to the previous one, and per class on a
+ *        day outside preferredDays. SameDayClasses (sameDay): one violation
+ *        per extra day used.
+ */
+struct SpreadRule : RuleBase {
+    EntitySet groups;
+    EntitySet subjects;
+    int32_t minDaysBetween = 1;
+    EntitySet preferredDays;
+    bool sameDay = false;
+
+    int64_t violations(const EventRange& events, const RuleTables& tables) const;
+};
+
+/**
+ * @brief ClassBefore/ClassAfter; one violation per class of the later
+ *        subject without a class of the earlier subject before it within
+ *        the gap bounds (on the same day if sameDay)
+ */
+struct PrecedenceRule : RuleBase {
+    EntitySet groups;
+    EntityId before = NO_ENTITY;
+    EntityId after = NO_ENTITY;
+    bool sameDay = false;
+    int32_t minGapMinutes = 0;
+    int32_t maxGapMinutes = -1;  // -1: unbounded
+
+    int64_t violations(const EventRange& events, const RuleTables& tables) const;
+};
+
+/**
+ * @brief SameTeacherForSubject; one violation per extra teacher of a subject in a group
+ */
+struct SameTeacherRule : RuleBase {
+    EntitySet groups;
+    EntitySet subjects;
+
+    int64_t violations(const EventRange& events, const RuleTables& tables) const;
+};
+
+/**
+ * @brief SameTimeSlot; one violation per extra time block used by the rule's subjects
+ */
+struct SameTimeRule : RuleBase {
+    EntitySet groups;
+    EntitySet subjects;
+
+    bool matches(const Placement& event) const {
+        return groups.contains(event.group) && subjects.contains(event.subject);
+    }
+
+    int64_t violations(const EventRange& events, const RuleTables& tables) const;
+};
+
+/**
+ * @brief One compiled constraint; visited statically, never through JSON
+ */
+using ConstraintRule = std::variant<TimeWindowRule, RoomRule, CapacityRule, QualificationRule, TeachingLoadRule,
+                                    BreakRule, DailyLoadRule, ConsecutiveRule, SpreadRule, PrecedenceRule,
+                                    SameTeacherRule, SameTimeRule>;
+
+template <typename Rule>
+constexpr bool isEventRule = std::is_same_v<Rule, TimeWindowRule> || std::is_same_v<Rule, RoomRule> ||
+                             std::is_same_v<Rule, CapacityRule> || std::is_same_v<Rule, QualificationRule>;
+
+inline const RuleBase& ruleBase(const ConstraintRule& rule) {
+    return std::visit([](const auto& r) -> const RuleBase& { return r; }, rule);
+}
+
+/**
+ * @brief Violations of an event rule for one placement, 0 for other rules
+ */
+inline int64_t ruleViolations(const ConstraintRule& rule, const Placement& event, const RuleTables& tables) {
+    return std::visit([&](const auto& typed) -> int64_t {
+        using Rule = std::decay_t<decltype(typed)>;
+        if constexpr (isEventRule<Rule>) {
+            return typed.violations(event, tables);
+        } else {
+            return 0;
+        }
+    }, rule);
+}
+
+/**
+ * @brief Violations of a bucket rule for one bucket, 0 for event rules
+ */
+inline int64_t ruleViolations(const ConstraintRule& rule, const EventRange& events, const RuleTables& tables) {
+    return std::visit([&](const auto& typed) -> int64_t {
+        using Rule = std::decay_t<decltype(typed)>;
+        if constexpr (isEventRule<Rule>) {
+            return 0;
+        } else {
+            return typed.violations(events, tables);
+        }
+    }, rule);
+}
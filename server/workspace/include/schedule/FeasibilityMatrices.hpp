@@ -0,0 +1,72 @@
+#pragma once
+
+#include <memory>
+#include "schedule/BitMatrix.hpp"
+#include "schedule/ProblemModel.hpp"
+
+/**
+ * @brief Hard availability and room suitability of a ProblemModel as bit matrices
+ *
+ *   teacherTimeBlocks  teachers x time blocks: Teacher.availableTimeBlocks
+ *                      (an empty list means always available) minus Critical
+ *                      TeacherUnavailable constraints
+ *   groupTimeBlocks    groups x time blocks: all, minus Critical GroupUnavailable
+ *   roomFeatures       rooms x features, and featureRooms as its transpose
+ *   subjectRooms       subjects x rooms: rooms meeting every Critical
+ *                      RequiredRoomFeature (AND/OR) and not named by a
+ *                      Critical ForbiddenRoom of the subject
+ *   timeBlockRooms     time blocks x rooms: rooms usable at a time block;
+ *                      datasets carry no room availability yet, so all rooms
+ *
+ * "Rooms for subject S at time block T" is then one row intersection of
+ * subjectRooms and timeBlockRooms, 256 rooms per instruction on CPUs with
+ * AVX2 (see BitKernels). Constraints of lower importance are preferences and
+ * are not applied here.
+ */
+class FeasibilityMatrices {
+public:
+    /**
+     * @brief Builds the matrices of a model
+     */
+    static std::shared_ptr<const FeasibilityMatrices> build(const ProblemModel& model);
+
+    const BitMatrix& teacherTimeBlocks() const { return teacherTimes; }
+    const BitMatrix& groupTimeBlocks() const { return groupTimes; }
+    const BitMatrix& roomFeatures() const { return roomFeatureBits; }
+    const BitMatrix& featureRooms() const { return featureRoomBits; }
+    const BitMatrix& subjectRooms() const { return subjectRoomBits; }
+    const BitMatrix& timeBlockRooms() const { return timeBlockRoomBits; }
+
+    bool teacherAvailable(EntityId teacher, EntityId timeBlock) const { return teacherTimes.test(teacher, timeBlock); }
+    bool groupAvailable(EntityId group, EntityId timeBlock) const { return groupTimes.test(group, timeBlock); }
+
+    /**
+     * @brief Writes the rooms usable for a subject at a time block
+     * @param out Row of roomWords() words
+     */
+    void feasibleRooms(EntityId subject, EntityId timeBlock, uint64_t* out) const;
+    size_t countFeasibleRooms(EntityId subject, EntityId timeBlock) const;
+
+    /**
+     * @return Lowest-index usable room, or NO_ENTITY
+     */
+    EntityId firstFeasibleRoom(EntityId subject, EntityId timeBlock) const;
+
+    size_t roomWords() const { return subjectRoomBits.rowWords(); }
+
+    /**
+     * @brief Describes the matrices: usable rooms per subject, available slots per teacher, build time
+     */
+    json summary(const ProblemModel& model) const;
+
+private:
+    BitMatrix teacherTimes;
+    BitMatrix groupTimes;
+    BitMatrix roomFeatureBits;
+    BitMatrix featureRoomBits;
+    BitMatrix subjectRoomBits;
+    BitMatrix timeBlockRoomBits;
+    int64_t buildMicros = 0;
+
+    friend class FeasibilityBuilder;
+};
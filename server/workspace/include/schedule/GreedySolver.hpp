@@ -0,0 +1,39 @@
+#pragma once
+
+#include <functional>
+#include "schedule/BuiltInAlgorithms.hpp"
+#include "schedule/ModelCache.hpp"
+
+/**
+ * @brief Built-in constructive solver: DSATUR over the ConflictGraph with teacher and room matching
+ *
+ * Lessons are placed one at a time, the one with the fewest time blocks
+ * left first (its presolved domain minus blocks taken by placed neighbours),
+ * ties to the higher degree. A lesson goes to the block that aligns it with
+ * its parallel sections, then to the day where its requirement has the
+ * fewest lessons. At that block it needs a free related group, a teacher
+ * and the smallest free room of its domain that seats the students, or the
+ * largest if none does. Every block is tried with the requirement's teacher
+ * before any block is tried with another one, the least loaded first.
+ * Lessons without such a block stay unplaced and are listed; the schedule
+ * holds no clashes.
+ *
+ * Runs in-process on the compiled dataset and takes milliseconds, so it
+ * gives an instant baseline and a start for external improvers.
+ */
+class GreedySolver {
+public:
+    static constexpr const char* NAME = BuiltInAlgorithms::GREEDY_NAME;
+    static constexpr const char* VERSION = BuiltInAlgorithms::GREEDY_VERSION;
+    static constexpr size_t MAX_LISTED_UNPLACED = 100;
+
+    using ShouldStop = std::function<bool()>;
+    using Report = std::function<void(float progress, const std::string& status)>;
+
+    /**
+     * @param config maxLessonsPerDay: per requirement and day, 0 for no limit
+     * @return Algorithm result: status, schedule.events and metadata
+     */
+    static json solve(const CompiledDataset& compiled, const json& config, const ShouldStop& shouldStop,
+                      const Report& report);
+};
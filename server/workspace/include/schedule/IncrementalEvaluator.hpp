@@ -0,0 +1,154 @@
+#pragma once
+
+#include "schedule/ScheduleEvaluator.hpp"
+
+/**
+ * @brief A local-search move on a schedule
+ *
+ * Reassign gives one event a new time block and/or room; Swap exchanges the
+ * time blocks and rooms of two events. Teachers, groups and subjects stay
+ * with their events.
+ */
+struct Move {
+    enum class Kind : uint8_t {
+        Reassign,
+        Swap
+    };
+
+    Kind kind = Kind::Reassign;
+    uint32_t event = 0;
+    uint32_t other = 0;               // Swap: the second event
+    EntityId timeBlock = NO_ENTITY;   // Reassign: new time block, NO_ENTITY keeps the current one
+    EntityId room = NO_ENTITY;        // Reassign: new room, NO_ENTITY keeps the current one
+
+    static Move reassign(uint32_t event, EntityId timeBlock, EntityId room = NO_ENTITY) {
+        return {Kind::Reassign, event, 0, timeBlock, room};
+    }
+
+    static Move swap(uint32_t event, uint32_t other) {
+        return {Kind::Swap, event, other, NO_ENTITY, NO_ENTITY};
+    }
+};
+
+/**
+ * @brief Keeps the evaluation of a schedule current while it is changed move by move
+ *
+ * The schedule is held as per-bucket timelines: the events of every teacher
+ * and group, per day and for the week, sorted by start. Next to each bucket
+ * sit the violations its rules last reported, so a move removes the event
+ * from the timelines it leaves, inserts it where it lands, and re-runs only
+ * the rules of those few buckets. Event rules are re-run for the moved
+ * events only. Rules over all events (SameTimeSlot) keep per time block
+ * counters instead of a timeline. Clashes follow an OccupancyIndex.
+ *
+ * The work per move is proportional to the events of the teachers and
+ * groups it touches and independent of the size of the schedule. A move
+ * that only changes rooms skips the timelines altogether.
+ *
+ * Moves are applied in place. apply() logs every cached value it replaces,
+ * so undo() restores the latest applied move without running any rule;
+ * apply/undo pairs nest like a stack. delta() is apply followed by undo.
+ * The log grows with every applied move until commit() drops it.
+ * Not thread-safe: use one evaluator per search thread.
+ */
+class IncrementalEvaluator {
+public:
+    IncrementalEvaluator(const ProblemModel& model, const CompiledConstraints& constraints, Assignment assignment);
+
+    /**
+     * @return Cost change the move would cause; the schedule is left unchanged
+     */
+    int64_t delta(const Move& move);
+
+    /**
+     * @brief Applies a move
+     * @return Cost change
+     */
+    int64_t apply(const Move& move);
+
+    /**
+     * @brief Reverts a move; it must be the latest applied one that was not undone
+     */
+    void undo(const Move& move);
+
+    /**
+     * @brief Keeps the applied moves for good and drops their undo log
+     */
+    void commit();
+
+    int64_t cost() const { return current.cost; }
+    const Evaluation& evaluation() const { return current; }
+    const Assignment& assignment() const { return schedule; }
+    const OccupancyIndex& occupancy() const { return occupancyIndex; }
+
+private:
+    struct Relocation {
+        uint32_t event;
+        EntityId timeBlock;
+        EntityId room;
+    };
+
+    struct BucketScope {
+        RuleScope scope;
+        bool daily;
+        bool byTeacher;
+        bool active;                               // Any rule in this scope
+        std::vector<std::vector<uint32_t>> timelines;  // Per bucket, event indices by start
+        std::vector<std::vector<int64_t>> cached;      // Per bucket, violations of rulesFor(scope, owner)
+    };
+
+    struct BlockCounter {
+        EntityId rule;
+        std::vector<uint32_t> events;  // Per time block, matching events
+        int64_t usedBlocks = 0;
+    };
+
+    struct CachedChange {
+        uint32_t scope;
+        uint32_t slot;     // Position in rulesFor(scope, owner)
+        size_t bucket;
+        int64_t previous;
+    };
+
+    // Where an applied move's entries start in the logs
+    struct Frame {
+        size_t placements;
+        size_t violations;
+        size_t cached;
+    };
+
+    const CompiledConstraints& constraints;
+    const RuleTables& tables;
+    Assignment schedule;
+    Evaluation current;
+    OccupancyIndex occupancyIndex;
+    size_t dayCount;
+    IdRange eventRules;
+    std::vector<int64_t> weights;    // Per rule
+    std::vector<size_t> tiers;
+    std::vector<BucketScope> scopes;  // TeacherDay, TeacherWeek, GroupDay, GroupWeek
+    std::vector<BlockCounter> counters;
+    std::vector<Frame> frames;
+    std::vector<Relocation> placementLog;  // Previous placements of the moved events
+    std::vector<std::pair<EntityId, int64_t>> violationLog;
+    std::vector<CachedChange> cachedLog;
+    std::vector<std::pair<size_t, size_t>> touched;  // (scope, bucket) to re-run
+
+    /**
+     * Moves events and, if evaluate, re-runs the rules they affect; without
+     * evaluate only timelines and counters follow (undo restores the rest)
+     */
+    int64_t relocate(const Relocation* moves, size_t count, bool evaluate);
+
+    size_t bucketOf(const BucketScope& scope, const Placement& event) const;
+    EntityId ownerOf(const BucketScope& scope, size_t bucket) const;
+    void insert(BucketScope& scope, size_t bucket, uint32_t event);
+    void erase(BucketScope& scope, size_t bucket, uint32_t event);
+    void rerun(size_t scopeIndex, size_t bucket);
+
+    void changeEventRules(const Placement& event, int64_t sign);
+    void changeCounters(const Placement& event, bool add, bool evaluate);
+    void syncClashes();
+    void addViolations(EntityId rule, int64_t violations);
+    void countViolations(EntityId rule, int64_t violations);
+};
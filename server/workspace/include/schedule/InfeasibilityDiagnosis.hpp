@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include "schedule/FeasibilityMatrices.hpp"
+#include "schedule/LessonDemand.hpp"
+
+/**
+ * @brief Quick proof that a dataset's lesson demand cannot be scheduled
+ *
+ * Each check compares demand with an upper bound on supply, so a failed
+ * check is a proof; passing them all does not prove a schedule exists.
+ *
+ *   group_time     lessons of a group and its ancestors all clash, so they
+ *                  need that many non-overlapping blocks in which one of
+ *                  the groups is available
+ *   teacher_hours  lessons to teachers listing the subject, each teacher
+ *                  giving as many lessons as non-overlapping blocks it is
+ *                  available in
+ *   room_supply    lessons to rooms with the subject's features, likewise
+ *   block_supply   lessons to blocks their group is available in, each
+ *                  block holding as many lessons as it has rooms and
+ *                  available teachers
+ *
+ * The last three are max flows. When one falls short of the demand, the
+ * minimum cut names a set of requirements whose lessons exceed everything
+ * they can use (Hall's condition); those resources are the certificate.
+ */
+class InfeasibilityDiagnosis {
+public:
+    static constexpr size_t MAX_CERTIFICATES = 32;  // Per check
+    static constexpr size_t MAX_LISTED = 50;        // Requirements and resources per certificate
+
+    static std::shared_ptr<const InfeasibilityDiagnosis> diagnose(const ProblemModel& model,
+                                                                  const FeasibilityMatrices& feasibility,
+                                                                  const LessonDemand& demand);
+
+    bool feasible() const { return certificateList.empty(); }
+
+    /**
+     * @brief Certificates with string ids, per check demand and supply, run time
+     */
+    json toJson() const;
+
+private:
+    json certificateList = json::array();
+    json checkList = json::object();
+    int64_t diagnoseMicros = 0;
+
+    friend class Diagnoser;
+};
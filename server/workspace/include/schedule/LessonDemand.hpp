@@ -0,0 +1,68 @@
+#pragma once
+
+#include <memory>
+#include "schedule/ProblemModel.hpp"
+
+/**
+ * @brief One set of identical weekly lessons a schedule has to place
+ */
+struct LessonRequirement {
+    EntityId subject;
+    EntityId group;
+    uint16_t lessons;         // Per week
+    uint16_t duration;        // Minutes per lesson
+    uint16_t section;         // 0-based; a split group has one requirement per section
+    uint16_t sections;        // 1 unless split
+    uint32_t students;
+    uint32_t teachersBegin;   // Range of the subject's candidate teachers
+    uint32_t teachersEnd;
+    bool parallel;            // Sections of a split are taught at the same time
+};
+
+/**
+ * @brief Lessons to schedule, derived from the subjects and groups of a ProblemModel
+ *
+ * The dataset has no curriculum, so every top-level group takes every
+ * subject for Subject.hoursPerWeek. A lesson lasts as long as the most
+ * common TimeBlock.duration, and the weekly hours become that many lessons,
+ * rounded up. Subgroups only take what a GroupSplit hands down to them:
+ * a split subject goes to each child group of the split group instead, or,
+ * for a group without children, to ceil(size / maxSubgroupSize) sections
+ * of it. parallelTeaching marks the sections as taught at once.
+ *
+ * Each (subject, group, section) is one requirement carrying a lesson
+ * count, not one entry per lesson, and requirements of a subject share its
+ * list of candidate teachers (Teacher.subjects). Built once per dataset
+ * version through ModelCache and immutable afterwards.
+ */
+class LessonDemand {
+public:
+    static std::shared_ptr<const LessonDemand> expand(const ProblemModel& model);
+
+    const std::vector<LessonRequirement>& requirements() const { return requirementList; }
+
+    IdRange candidates(const LessonRequirement& requirement) const {
+        return {teacherIds.data() + requirement.teachersBegin, teacherIds.data() + requirement.teachersEnd};
+    }
+
+    uint16_t lessonMinutes() const { return minutesPerLesson; }
+    size_t totalLessons() const { return lessonCount; }
+
+    /**
+     * @brief Requirements with string ids, one object each, for algorithm input
+     */
+    json toJson(const ProblemModel& model) const;
+
+    /**
+     * @brief Counts, and the subjects no teacher can teach
+     */
+    json summary(const ProblemModel& model) const;
+
+private:
+    std::vector<LessonRequirement> requirementList;
+    std::vector<EntityId> teacherIds;  // Candidate teachers, grouped by subject
+    uint16_t minutesPerLesson = 0;
+    size_t lessonCount = 0;
+
+    friend class DemandExpander;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include "schedule/BitMatrix.hpp"
+#include "schedule/ConstraintCompiler.hpp"
+#include "schedule/FeasibilityMatrices.hpp"
+#include "schedule/LessonDemand.hpp"
+
+/**
+ * @brief Time blocks, rooms and teachers each lesson requirement can still use
+ *
+ * Presolve starts every requirement from FeasibilityMatrices (teacher and
+ * group availability, rooms with the subject's features) and the hard event
+ * rules of CompiledConstraints (time windows, room rules, MinimumRoomCapacity,
+ * TeacherSubjectMatch), with the subject's candidate teachers. The three
+ * domains then narrow each other: a time block needs an available teacher
+ * and a usable room, a teacher needs a block left in the time domain.
+ *
+ * Requirements whose time domain holds exactly as many blocks as lessons
+ * are forced: those blocks, and the blocks overlapping them, are taken from
+ * every requirement of a related group, and from every other requirement of
+ * the teacher when only one can teach it. This repeats until nothing
+ * changes. A requirement left with fewer blocks than lessons, or with no
+ * room or teacher, is reported as infeasible; its domains are kept as they
+ * are so the cause can be inspected.
+ */
+class LessonDomains {
+public:
+    static constexpr size_t MAX_ROUNDS = 32;
+
+    static std::shared_ptr<const LessonDomains> presolve(const ProblemModel& model,
+                                                         const CompiledConstraints& constraints,
+                                                         const FeasibilityMatrices& feasibility,
+                                                         const LessonDemand& demand);
+
+    /**
+     * @return Rows per requirement, parallel to LessonDemand::requirements()
+     */
+    const BitMatrix& timeBlocks() const { return timeBits; }
+    const BitMatrix& rooms() const { return roomBits; }
+    const BitMatrix& teachers() const { return teacherBits; }
+
+    bool forced(size_t requirement) const { return forcedFlags[requirement]; }
+
+    /**
+     * @brief Domains with string ids, one object per requirement, for algorithm input
+     */
+    json toJson(const ProblemModel& model) const;
+
+    /**
+     * @brief Domain sizes before and after, forced and infeasible requirements
+     */
+    json summary(const LessonDemand& demand) const;
+
+private:
+    BitMatrix timeBits;
+    BitMatrix roomBits;
+    BitMatrix teacherBits;
+    std::vector<bool> forcedFlags;
+    json infeasibleList = json::array();
+    double log10Before = 0.0;  // Sum over lessons of log10(blocks x rooms x teachers)
+    double log10After = 0.0;
+    size_t valuesBefore[3] = {};  // Domain values summed over requirements: time blocks, rooms, teachers
+    size_t valuesAfter[3] = {};
+    size_t rounds = 0;
+    int64_t presolveMicros = 0;
+
+    friend class DomainPresolver;
+};
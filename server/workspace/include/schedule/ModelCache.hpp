@@ -0,0 +1,59 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "dataset/Dataset.hpp"
+#include "metrics/MetricsRegistry.hpp"
+#include "schedule/ConflictGraph.hpp"
+#include "schedule/ConstraintCompiler.hpp"
+#include "schedule/FeasibilityMatrices.hpp"
+#include "schedule/InfeasibilityDiagnosis.hpp"
+#include "schedule/LessonDemand.hpp"
+#include "schedule/LessonDomains.hpp"
+#include "schedule/ProblemModel.hpp"
+
+/**
+ * @brief What the server derives from one dataset version before solving
+ */
+struct CompiledDataset {
+    std::shared_ptr<const ProblemModel> model;
+    std::shared_ptr<const CompiledConstraints> constraints;
+    std::shared_ptr<const FeasibilityMatrices> feasibility;
+    std::shared_ptr<const LessonDemand> demand;
+    std::shared_ptr<const LessonDomains> domains;  // Presolved, parallel to demand
+    std::shared_ptr<const ConflictGraph> conflicts;
+    std::shared_ptr<const InfeasibilityDiagnosis> diagnosis;
+};
+
+/**
+ * @brief Compiled forms of the most recently used dataset versions
+ *
+ * Keyed by content hash: stored versions never change, and versions with
+ * equal content share one entry. Compiling runs outside the lock, so a
+ * large dataset does not hold up lookups of others; when two requests miss
+ * on the same version at once, the first to finish is kept.
+ */
+class ModelCache {
+public:
+    static constexpr size_t MAX_ENTRIES = 8;
+
+    explicit ModelCache(MetricsRegistry& metrics);
+
+    /**
+     * @brief Gets the compiled form of a dataset, compiling it on a miss
+     * @param error Receives the reason if the dataset does not compile
+     * @param cached Set to whether the entry was already there
+     * @return Compiled dataset, or nullptr on error
+     */
+    std::shared_ptr<const CompiledDataset> get(const Dataset& dataset, std::string& error, bool* cached = nullptr);
+
+private:
+    Counter& hits;
+    Counter& misses;
+    Histogram& compileTimes;
+
+    std::mutex mutex;
+    std::list<std::pair<std::string, std::shared_ptr<const CompiledDataset>>> entries;  // Most recent first
+};
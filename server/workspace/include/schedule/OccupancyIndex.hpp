@@ -0,0 +1,106 @@
+#pragma once
+
+#include "schedule/Assignment.hpp"
+#include "schedule/ConstraintRules.hpp"
+#include "schedule/TimeIndex.hpp"
+
+/**
+ * @brief Kinds of resources an event occupies
+ */
+enum class Resource : uint8_t {
+    Teacher,
+    Room,
+    Group
+};
+
+constexpr size_t RESOURCE_KINDS = 3;
+
+// Cost of one double booking; clashes are hard violations of weight 1
+constexpr int64_t CLASH_WEIGHT = TIER_WEIGHTS[static_cast<size_t>(PenaltyTier::Hard)];
+
+inline const char* resourceName(Resource resource) {
+    switch (resource) {
+        case Resource::Teacher: return "teacher";
+        case Resource::Room: return "room";
+        default: return "group";
+    }
+}
+
+/**
+ * @brief Counts of events per (resource x time block), with running clash totals
+ *
+ * For each teacher, room and group there is one counter per time block.
+ * Time blocks of the same day whose [start, end) intervals intersect
+ * overlap, as listed by the model's TimeIndex; every block overlaps itself.
+ * A clash is a pair of events that share a resource at overlapping time
+ * blocks, so three events of one teacher in one block are three clashes.
+ * Groups share students with their ancestors and descendants, so two events
+ * clash on groups when their groups are the same or related
+ * (ProblemModel::relatedGroups).
+ *
+ * Adding or removing an event reads the counters of the blocks overlapping
+ * its block, a handful at most, and adjusts the totals, so updates cost
+ * O(overlap degree) and clashes() is a field read. Counters are stored
+ * per entity, with that entity's time blocks side by side. For groups a
+ * busy bitset per time block is kept as well: whether any group related to
+ * g is busy at T is one row AND, no matter how deep the hierarchy, and only
+ * the busy related groups are visited to count clashes.
+ *
+ * The index keeps references to the model's time index and group relation;
+ * the model must outlive it.
+ */
+class OccupancyIndex {
+public:
+    explicit OccupancyIndex(const ProblemModel& model);
+
+    void add(const Placement& event);
+    void remove(const Placement& event);
+
+    /**
+     * @return Events of an entity at exactly this time block
+     */
+    uint32_t count(Resource resource, EntityId entity, EntityId timeBlock) const {
+        return counters[static_cast<size_t>(resource)][entity * blockCount + timeBlock];
+    }
+
+    /**
+     * @return Events of an entity at any time block overlapping this one; for
+     *         groups, events of the group or any related group
+     */
+    uint32_t occupied(Resource resource, EntityId entity, EntityId timeBlock) const;
+
+    /**
+     * @return Whether the group or a related group has an event overlapping the time block
+     */
+    bool groupBusy(EntityId group, EntityId timeBlock) const;
+
+    /**
+     * @return Clashes the event would add if it were placed as given
+     */
+    uint32_t conflicts(const Placement& event) const;
+
+    int64_t clashes(Resource resource) const { return clashTotals[static_cast<size_t>(resource)]; }
+    int64_t clashes() const { return clashTotals[0] + clashTotals[1] + clashTotals[2]; }
+
+    /**
+     * @return Time blocks overlapping a time block, itself included, ascending
+     */
+    IdRange overlapping(EntityId timeBlock) const { return times.overlapping(timeBlock); }
+
+    json summary() const;
+
+private:
+    size_t blockCount;
+    const TimeIndex& times;
+    std::vector<uint32_t> counters[RESOURCE_KINDS];  // entity x time block
+    int64_t clashTotals[RESOURCE_KINDS] = {};
+    const BitMatrix& relatedGroups;
+    BitMatrix busyGroups;  // time blocks x groups, set while the group has an event there
+
+    /**
+     * Events at the time block whose group is related to the given one
+     */
+    uint32_t relatedEvents(EntityId group, EntityId timeBlock) const;
+
+    void changeCounter(Resource resource, EntityId entity, EntityId timeBlock, bool add);
+};
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "dataset/Dataset.hpp"
+#include "schedule/BitMatrix.hpp"
+#include "schedule/ScheduleData.hpp"
+
+// Dense index of an entity within its kind, e.g. teacher 0..teacherCount()-1
+using EntityId = uint32_t;
+constexpr EntityId NO_ENTITY = std::numeric_limits<EntityId>::max();
+
+constexpr int32_t MINUTES_PER_DAY = 24 * 60;
+
+class TimeIndex;
+
+/**
+ * @brief Maps the string ids of one entity kind to dense indices
+ *
+ * Indices are handed out in first-seen order, so they follow the order of
+ * the dataset section.
+ */
+class IdTable {
+public:
+    /**
+     * @brief Gets the index of an id, adding it if it is new
+     */
+    EntityId intern(const std::string& id);
+
+    /**
+     * @return Index of the id, or NO_ENTITY
+     */
+    EntityId find(const std::string& id) const;
+
+    const std::string& name(EntityId index) const { return names[index]; }
+    size_t size() const { return names.size(); }
+
+private:
+    std::vector<std::string> names;
+    std::unordered_map<std::string, EntityId> indices;
+};
+
+/**
+ * @brief View of a run of indices in one of the model's flat arrays
+ */
+struct IdRange {
+    const EntityId* first = nullptr;
+    const EntityId* last = nullptr;
+
+    const EntityId* begin() const { return first; }
+    const EntityId* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+};
+
+enum class ConstraintImportance : uint8_t {
+    Critical,
+    Important,
+    Optional
+};
+
+/**
+ * @brief Schedule problem compiled from a dataset for solvers and evaluators
+ *
+ * The dataset sections are read once into the structs of ScheduleData.hpp
+ * and flattened: every entity kind lives in one contiguous array indexed by
+ * EntityId, and list fields (teacher subjects, teacher availability, room
+ * features) are offset ranges into shared index arrays. Nothing downstream
+ * needs to look at string ids or JSON again; the id tables translate back
+ * for output.
+ *
+ * Teacher.availableTimeBlocks holds numbers while TimeBlock.id is a string.
+ * A number n names the time block whose id ends in the digits of n, so 12
+ * is "TB12". When no time block id ends in digits, n is the 1-based position
+ * in the timeBlocks section.
+ *
+ * Time blocks become [weekStart, weekEnd) intervals in minutes since the
+ * start of the week, days in the order of days(), and are indexed by a
+ * TimeIndex for overlap, gap and next-block queries. days() runs Monday to
+ * Sunday, then any other day labels in the order they first appear.
+ *
+ * Group.parentGroupId is closed once into groups x groups bit matrices:
+ * groupAncestors (parent, grandparent, ...), groupDescendants (its
+ * transpose) and relatedGroups (the group itself, its ancestors and its
+ * descendants: the groups whose lessons share students with it). Checking a
+ * relation is then one bit test or row AND however deep the hierarchy is.
+ * A parent link that would close a cycle is dropped with a warning.
+ *
+ * Entities without an id, repeated ids and references that name no entity
+ * are left out and reported in warnings(). A field of the wrong JSON type,
+ * or a time block with a malformed hhmm or that does not end after it
+ * starts, makes compile() fail.
+ *
+ * The model is immutable once built and shares nothing mutable, so any
+ * number of threads can read one model.
+ */
+class ProblemModel {
+public:
+    struct TimeBlockEntry {
+        EntityId day;      // Index into days()
+        int start;         // hhmm, as in TimeBlock
+        int end;           // hhmm
+        int startMinute;   // Minutes since midnight
+        int endMinute;
+        int duration;      // Minutes
+        int32_t weekStart; // Minutes since week start: day x MINUTES_PER_DAY + startMinute
+        int32_t weekEnd;
+    };
+
+    struct SubjectEntry {
+        float hoursPerWeek;
+        int difficultyLevel;
+    };
+
+    struct GroupEntry {
+        int size;
+        EntityId parent;   // NO_ENTITY for top-level groups
+    };
+
+    struct RoomEntry {
+        int capacity;
+        uint32_t featuresBegin;  // Range in roomFeatureIds
+        uint32_t featuresEnd;
+    };
+
+    struct TeacherEntry {
+        uint32_t subjectsBegin;      // Range in teacherSubjectIds
+        uint32_t subjectsEnd;
+        uint32_t availabilityBegin;  // Range in teacherTimeBlockIds, ascending
+        uint32_t availabilityEnd;
+        bool availabilityListed;     // false if availableTimeBlocks is empty: available at all times
+    };
+
+    struct ConstraintEntry {
+        ConstraintType type;
+        ConstraintImportance importance;
+        uint32_t sourceIndex;              // Position in the constraints section
+        std::shared_ptr<const json> source;  // Constraint item, data is compiled by later stages
+    };
+
+    /**
+     * @brief Compiles dataset sections into a model
+     * @param error Receives the reason on failure
+     * @return Model, or nullptr if an entity field has the wrong type
+     */
+    static std::shared_ptr<const ProblemModel> compile(const DatasetSections& sections, std::string& error);
+
+    const IdTable& timeBlockIds() const { return timeBlockTable; }
+    const IdTable& subjectIds() const { return subjectTable; }
+    const IdTable& groupIds() const { return groupTable; }
+    const IdTable& roomIds() const { return roomTable; }
+    const IdTable& teacherIds() const { return teacherTable; }
+    const IdTable& days() const { return dayTable; }
+    const IdTable& features() const { return featureTable; }
+
+    const std::vector<TimeBlockEntry>& timeBlocks() const { return timeBlockEntries; }
+    const std::vector<SubjectEntry>& subjects() const { return subjectEntries; }
+    const std::vector<GroupEntry>& groups() const { return groupEntries; }
+    const std::vector<RoomEntry>& rooms() const { return roomEntries; }
+    const std::vector<TeacherEntry>& teachers() const { return teacherEntries; }
+    const std::vector<ConstraintEntry>& constraints() const { return constraintEntries; }
+
+    IdRange roomFeatures(EntityId room) const;
+    IdRange teacherSubjects(EntityId teacher) const;
+    IdRange teacherAvailability(EntityId teacher) const;
+
+    const TimeIndex& timeIndex() const { return *times; }
+
+    const BitMatrix& groupAncestors() const { return ancestorBits; }
+    const BitMatrix& groupDescendants() const { return descendantBits; }
+    const BitMatrix& relatedGroups() const { return relatedBits; }
+
+    /**
+     * @brief Entities and references left out while compiling
+     * @return Array of {code, section, index, field?, value?, message}
+     */
+    const json& warnings() const { return warningList; }
+
+    /**
+     * @brief Describes the model: entity counts and warnings
+     */
+    json summary() const;
+
+private:
+    IdTable timeBlockTable;
+    IdTable subjectTable;
+    IdTable groupTable;
+    IdTable roomTable;
+    IdTable teacherTable;
+    IdTable dayTable;
+    IdTable featureTable;
+
+    std::vector<TimeBlockEntry> timeBlockEntries;
+    std::vector<SubjectEntry> subjectEntries;
+    std::vector<GroupEntry> groupEntries;
+    std::vector<RoomEntry> roomEntries;
+    std::vector<TeacherEntry> teacherEntries;
+    std::vector<ConstraintEntry> constraintEntries;
+
+    std::vector<EntityId> roomFeatureIds;
+    std::vector<EntityId> teacherSubjectIds;
+    std::vector<EntityId> teacherTimeBlockIds;
+
+    std::shared_ptr<const TimeIndex> times;
+
+    BitMatrix ancestorBits;
+    BitMatrix descendantBits;
+    BitMatrix relatedBits;
+
+    json warningList = json::array();
+    bool warningsTruncated = false;
+
+    friend class ProblemCompiler;
+};
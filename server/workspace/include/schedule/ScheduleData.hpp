@@ -4,7 +4,7 @@
 #include <vector>
 #include <set>
 #include <optional>
-#include "json.hpp"
+#include "extern/nlohmann/json.hpp"
 
 using json = nlohmann::json;
 
@@ -13,41 +13,41 @@ using json = nlohmann::json;
 struct TimeBlock {
     std::string id;
     std::string day;        // e.g. "Monday"
-    int start;              // e.g. 800 (8:00)
-    int end;                // e.g. 945 (9:45)
-    int duration;           // minutes
+    int start = 0;          // e.g. 800 (8:00)
+    int end = 0;            // e.g. 945 (9:45)
+    int duration = 0;       // minutes
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(TimeBlock, id, day, start, end, duration)
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(TimeBlock, id, day, start, end, duration)
 };
 
 // --- Subject ---
 struct Subject {
     std::string id;
     std::string name;
-    float hoursPerWeek; // np. 3.0
-    int difficultyLevel; // np. 1-5
+    float hoursPerWeek = 0.0f; // np. 3.0
+    int difficultyLevel = 0; // np. 1-5
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Subject, id, name, hoursPerWeek, difficultyLevel)
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Subject, id, name, hoursPerWeek, difficultyLevel)
 };
 
 // --- Group ---
 struct Group {
     std::string id;
     std::string name;
-    int size;
+    int size = 0;
     std::string parentGroupId; // Null if no parent group
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Group, id, name, size, parentGroupId)
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Group, id, name, size, parentGroupId)
 };
 
 // --- Room ---
 struct Room {
     std::string id;
     std::string name;
-    int capacity;
+    int capacity = 0;
     std::set<std::string> features;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Room, id, name, capacity, features)
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Room, id, name, capacity, features)
 };
 
 // --- Teacher ---
@@ -57,7 +57,7 @@ struct Teacher {
     std::vector<std::string> subjects;
     std::vector<int> availableTimeBlocks; // ids of TimeBlocks
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Teacher, id, name, subjects, availableTimeBlocks)
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Teacher, id, name, subjects, availableTimeBlocks)
 };
 
 // --- Event (Class) ---
@@ -69,27 +69,17 @@ struct Event {
     std::string roomId;
     std::string timeBlockId;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Event, id, subjectId, teacherId, groupId, roomId, timeBlockId)
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Event, id, subjectId, teacherId, groupId, roomId, timeBlockId)
 };
 
 // --- Schedule (output) ---
 struct Schedule {
     std::vector<Event> events;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Schedule, events)
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Schedule, events)
 };
 
 
-// --- Constraint ---
-struct Constraint {
-    std::string importance; // "Critical", "Important", "Optional"
-    std::string description; // Human-readable description
-    ConstraintType type;    // Type of constraint
-    json data;             // Type-specific constraint data
-
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Constraint, importance, description, type, data)
-};
-
 // --- Constraint Type ---
 enum class ConstraintType {
     // Time-based constraints
@@ -129,6 +119,42 @@ enum class ConstraintType {
     Custom                  // For application-specific constraints
 };
 
+// Unknown type names read as Custom
+NLOHMANN_JSON_SERIALIZE_ENUM(ConstraintType, {
+    {ConstraintType::Custom, "Custom"},
+    {ConstraintType::TeacherUnavailable, "TeacherUnavailable"},
+    {ConstraintType::TeacherPreferred, "TeacherPreferred"},
+    {ConstraintType::GroupUnavailable, "GroupUnavailable"},
+    {ConstraintType::RequiredRoomFeature, "RequiredRoomFeature"},
+    {ConstraintType::PreferredRoom, "PreferredRoom"},
+    {ConstraintType::ForbiddenRoom, "ForbiddenRoom"},
+    {ConstraintType::MinimumRoomCapacity, "MinimumRoomCapacity"},
+    {ConstraintType::MaxTeachingHours, "MaxTeachingHours"},
+    {ConstraintType::MinBreakBetweenClasses, "MinBreakBetweenClasses"},
+    {ConstraintType::SameTeacherForSubject, "SameTeacherForSubject"},
+    {ConstraintType::TeacherSubjectMatch, "TeacherSubjectMatch"},
+    {ConstraintType::MaxClassesPerDay, "MaxClassesPerDay"},
+    {ConstraintType::GroupSplit, "GroupSplit"},
+    {ConstraintType::GroupMerge, "GroupMerge"},
+    {ConstraintType::ConsecutiveClasses, "ConsecutiveClasses"},
+    {ConstraintType::AvoidConsecutive, "AvoidConsecutive"},
+    {ConstraintType::SameDayClasses, "SameDayClasses"},
+    {ConstraintType::SpreadAcrossWeek, "SpreadAcrossWeek"},
+    {ConstraintType::ClassBefore, "ClassBefore"},
+    {ConstraintType::ClassAfter, "ClassAfter"},
+    {ConstraintType::SameTimeSlot, "SameTimeSlot"}
+})
+
+// --- Constraint ---
+struct Constraint {
+    std::string importance; // "Critical", "Important", "Optional"
+    std::string description; // Human-readable description
+    ConstraintType type = ConstraintType::Custom; // Type of constraint
+    json data;             // Type-specific constraint data
+
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Constraint, importance, description, type, data)
+};
+
 // --- Constraint Data Structures ---
 // Each constraint type uses specific JSON structure in the 'data' field
 
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "schedule/ConstraintCompiler.hpp"
+#include "schedule/OccupancyIndex.hpp"
+
+/**
+ * @brief Violations and cost of one schedule under CompiledConstraints
+ */
+struct Evaluation {
+    std::vector<int64_t> violations;  // Per rule, parallel to CompiledConstraints::rules()
+    int64_t clashes[RESOURCE_KINDS] = {};  // Double bookings, counted in the hard tier
+    int64_t tierViolations[PENALTY_TIERS] = {};
+    int64_t tierCost[PENALTY_TIERS] = {};
+    int64_t cost = 0;                 // Sum of violations x weight over all rules and clashes
+
+    bool feasible() const { return tierViolations[static_cast<size_t>(PenaltyTier::Hard)] == 0; }
+};
+
+/**
+ * @brief Evaluates a whole schedule against compiled rules
+ *
+ * Event rules run once per event. For every other scope the events are
+ * sorted into buckets (teacher or group, then day, then start time) and
+ * each bucket is handed to the rules that scope indexes for its owner.
+ * Double bookings of teachers, rooms and groups come from an OccupancyIndex.
+ * Only integer tables are read; no JSON and no string ids.
+ */
+class ScheduleEvaluator {
+public:
+    static Evaluation evaluate(const ProblemModel& model, const CompiledConstraints& constraints,
+                               const Assignment& assignment);
+
+    /**
+     * @brief Describes an evaluation: cost, per-tier totals and the violated constraints
+     */
+    static json report(const ProblemModel& model, const CompiledConstraints& constraints,
+                       const Evaluation& evaluation);
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <memory>
+#include "schedule/BitMatrix.hpp"
+#include "schedule/ProblemModel.hpp"
+
+/**
+ * @brief Interval queries over the time blocks of a ProblemModel
+ *
+ * Every block is the interval [weekStart, weekEnd) in minutes since the
+ * start of the week (ProblemModel::TimeBlockEntry), so blocks of different
+ * days never overlap and lengths need not be uniform. Per day the blocks are
+ * kept sorted by start together with the longest block of that day: the
+ * blocks intersecting [start, end) lie between the first block starting
+ * after start - longest and the last starting before end, two binary
+ * searches apart.
+ *
+ * For every block the blocks overlapping it (itself included) and the next
+ * block of the same day are computed once. Up to MATRIX_LIMIT blocks the
+ * overlap relation is also kept as a blocks x blocks bit matrix, so
+ * overlaps() is one bit test; larger instances compare the intervals.
+ * gap() is the minutes between two blocks of the same day and needs no
+ * table.
+ */
+class TimeIndex {
+public:
+    static constexpr size_t MATRIX_LIMIT = 4096;  // 2 MiB of bits at the limit
+    static constexpr int32_t NO_GAP = std::numeric_limits<int32_t>::min();
+
+    /**
+     * @brief Builds the index of a model's time blocks
+     */
+    static std::shared_ptr<const TimeIndex> build(const ProblemModel& model);
+
+    /**
+     * @return Whether the two blocks share a minute; a block overlaps itself
+     */
+    bool overlaps(EntityId a, EntityId b) const;
+
+    /**
+     * @return Minutes from the end of a to the start of b, negative if they
+     *         overlap, or NO_GAP if they are on different days
+     */
+    int32_t gap(EntityId a, EntityId b) const;
+
+    /**
+     * @return First block of the same day starting at or after the block's end, or NO_ENTITY
+     */
+    EntityId next(EntityId timeBlock) const { return nextBlocks[timeBlock]; }
+
+    /**
+     * @return Blocks overlapping a block, itself included, ascending
+     */
+    IdRange overlapping(EntityId timeBlock) const {
+        return {overlapBlocks.data() + overlapOffsets[timeBlock], overlapBlocks.data() + overlapOffsets[timeBlock + 1]};
+    }
+
+    /**
+     * @return Blocks of a day by start, then end
+     */
+    IdRange dayBlocks(EntityId day) const {
+        return {byStart.data() + dayOffsets[day], byStart.data() + dayOffsets[day + 1]};
+    }
+
+    /**
+     * @return First block of the day starting at or after the minute (since midnight), or NO_ENTITY
+     */
+    EntityId firstStartingAt(EntityId day, int32_t minute) const;
+
+    /**
+     * @brief Appends the blocks of a day intersecting [startMinute, endMinute), by start
+     */
+    void intersecting(EntityId day, int32_t startMinute, int32_t endMinute, std::vector<EntityId>& out) const;
+
+    size_t overlappingPairs() const { return (overlapBlocks.size() - intervals.size()) / 2; }
+
+    json summary() const;
+
+private:
+    struct Interval {
+        EntityId day;
+        int32_t start;  // Week minutes
+        int32_t end;
+    };
+
+    std::vector<Interval> intervals;       // Per block
+    std::vector<EntityId> byStart;         // Blocks grouped by day, each day by start
+    std::vector<uint32_t> dayOffsets;      // Per day, plus one
+    std::vector<int32_t> dayLongest;       // Per day, minutes of its longest block
+    std::vector<EntityId> nextBlocks;
+    std::vector<uint32_t> overlapOffsets;  // Per block, plus one
+    std::vector<EntityId> overlapBlocks;
+    BitMatrix overlapBits;                 // Empty above MATRIX_LIMIT blocks
+
+    const EntityId* firstStarting(EntityId day, int32_t weekMinute) const;
+};
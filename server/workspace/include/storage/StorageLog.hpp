@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "extern/nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * @brief Append-only log of JSON records, one per line
+ *
+ * Every append is written with a single write() and synced before it returns,
+ * so after a crash the file holds every acknowledged record followed by at
+ * most one torn line, which open() cuts off. Any other unreadable line makes
+ * open() fail instead of discarding the records after it. Owners rebuild their in-memory
+ * index by replaying the log and shrink it with rewrite() once most of its
+ * records are superseded.
+ */
+class StorageLog {
+public:
+    StorageLog() = default;
+    ~StorageLog();
+
+    StorageLog(const StorageLog&) = delete;
+    StorageLog& operator=(const StorageLog&) = delete;
+
+    /**
+     * @brief Opens or creates the log and replays its records in order
+     * @param replay Called once per intact record
+     * @param error Receives the reason when the log cannot be used
+     * @return false if the file cannot be opened or a line other than a torn last one is unreadable
+     */
+    bool open(const std::string& path, const std::function<void(const json&)>& replay, std::string& error);
+
+    /**
+     * @brief Durably appends one record
+     *
+     * A failed write is cut off again; if that fails too, the log is closed
+     * and every later append fails rather than writing after the damage.
+     * @return false if the log is closed or the write failed
+     */
+    bool append(const json& record);
+
+    /**
+     * @brief Atomically replaces the log with the given records (compaction)
+     */
+    bool rewrite(const std::vector<json>& records);
+
+    bool isOpen() const;
+
+    /**
+     * @brief Gets the number of records in the file, live or superseded
+     */
+    size_t recordCount() const;
+
+private:
+    mutable std::mutex mutex;
+    std::string path;
+    int fd = -1;
+    size_t records = 0;
+
+    bool syncDirectory() const;
+    bool writeAll(int target, const std::string& bytes);
+};
@@ -41,8 +41,7 @@ AlgorithmInfo AlgorithmInfo::fromInfoFile(const std::string& infoPath) {
 bool AlgorithmInfo::isValid() const {
     return !name.empty() && 
            !displayName.empty() && 
-           !path.empty() &&
-           std::filesystem::exists(path + "/algorithm");
+           (builtIn || (!path.empty() && std::filesystem::exists(path + "/algorithm")));
 }
 
 std::vector<std::string> AlgorithmInfo::validateParameters(const json& config) const {
@@ -8,27 +8,71 @@
 #include <signal.h>
 #include <unistd.h>
 
-AlgorithmRunner::AlgorithmRunner() 
-    : running(false), stopRequested(false), progress(0.0f), exitCode(-1), timeoutSeconds(300) {
+AlgorithmRunner::AlgorithmRunner(MetricsRegistry* metrics, Tracer* tracer) 
+    : running(false), stopRequested(false), processExited(false), progress(0.0f), exitCode(-1), timeoutSeconds(DEFAULT_TIMEOUT_SECONDS),
+      metrics(metrics), tracer(tracer) {
 }
 
 AlgorithmRunner::~AlgorithmRunner() {
     stop();
+    // A finished run leaves its thread joinable; stop() only joins a running one
+    if (processThread.joinable()) {
+        processThread.join();
+    }
     cleanupTempFiles();
 }
 
 bool AlgorithmRunner::start(const std::string& algorithmPath, const json& inputData, const json& config, 
-                          ProgressCallback progressCb, CompletionCallback completionCb, int timeoutSeconds) {
+                          ProgressCallback progressCb, CompletionCallback completionCb, int timeoutSeconds,
+                          const std::string& traceId) {
+    return startWithInput(algorithmPath, [&inputData](std::ostream& out) { out << inputData.dump(2); },
+                          config, progressCb, completionCb, timeoutSeconds, traceId);
+}
+
+bool AlgorithmRunner::start(const std::string& algorithmPath, std::shared_ptr<const Dataset> dataset, const json& config,
+                          ProgressCallback progressCb, CompletionCallback completionCb, int timeoutSeconds,
+                          const std::string& traceId, const DatasetSections& extraSections) {
+    // Streamed straight from the shared sections, no JSON copy of the dataset is built
+    auto writeInput = [&dataset, &extraSections](std::ostream& out) {
+        if (extraSections.empty()) {
+            dataset->writeJson(out);
+            return;
+        }
+        DatasetSections sections = dataset->sections();
+        for (const auto& [name, section] : extraSections) {
+            sections[name] = section;
+        }
+        Dataset::writeSections(sections, out);
+    };
+    return startWithInput(algorithmPath, writeInput, config, progressCb, completionCb, timeoutSeconds, traceId,
+                          dataset);
+}
+
+bool AlgorithmRunner::startWithInput(const std::string& algorithmPath, const std::function<void(std::ostream&)>& writeInput,
+                                     const json& config, ProgressCallback progressCb, CompletionCallback completionCb,
+                                     int timeoutSeconds, const std::string& traceId,
+                                     std::shared_ptr<const Dataset> dataset) {
     if (running.load()) {
         std::cerr << "Algorithm is already running" << std::endl;
         return false;
     }
     
+    // The previous run has finished but its thread may still be delivering the result
+    if (processThread.joinable()) {
+        processThread.join();
+    }
+    
+    this->traceId = traceId;
+    TraceScope trace(tracer, this->traceId, "algorithm.prepare");
+    
     this->algorithmPath = algorithmPath;
     this->timeoutSeconds = timeoutSeconds;
     this->progressCallback = progressCb;
     this->completionCallback = completionCb;
+    // Edits publish new versions; this job keeps reading the one it started with
+    pinnedDataset = std::move(dataset);
     stopRequested.store(false);
+    processExited.store(false);
     progress.store(0.0f);
     statusMessage = "initializing";
     resultData = json();
@@ -42,7 +86,7 @@ bool AlgorithmRunner::start(const std::string& algorithmPath, const json& inputD
     try {
         // Write input data
         std::ofstream inputStream(inputFile);
-        inputStream << inputData.dump(2);
+        writeInput(inputStream);
         inputStream.close();
         
         // Write config data
@@ -58,6 +102,7 @@ bool AlgorithmRunner::start(const std::string& algorithmPath, const json& inputD
     } catch (const std::exception& e) {
         std::cerr << "Error creating temporary files: " << e.what() << std::endl;
         cleanupTempFiles();
+        pinnedDataset.reset();
         return false;
     }
     
@@ -68,6 +113,43 @@ bool AlgorithmRunner::start(const std::string& algorithmPath, const json& inputD
     return true;
 }
 
+bool AlgorithmRunner::startInProcess(const std::string& algorithmName, InProcessAlgorithm algorithm,
+                                     ProgressCallback progressCb, CompletionCallback completionCb, int timeoutSeconds,
+                                     const std::string& traceId, std::shared_ptr<const Dataset> dataset) {
+    if (running.load()) {
+        std::cerr << "Algorithm is already running" << std::endl;
+        return false;
+    }
+    
+    if (processThread.joinable()) {
+        processThread.join();
+    }
+    
+    this->traceId = traceId;
+    this->algorithmPath = algorithmName;
+    this->timeoutSeconds = timeoutSeconds;
+    this->progressCallback = progressCb;
+    this->completionCallback = completionCb;
+    pinnedDataset = std::move(dataset);
+    stopRequested.store(false);
+    processExited.store(false);
+    progress.store(0.0f);
+    statusMessage = "initializing";
+    resultData = json();
+    
+    // Nothing on disk for this run; keeps cleanupTempFiles from touching a previous run's names
+    inputFile.clear();
+    outputFile.clear();
+    configFile.clear();
+    progressFile.clear();
+    
+    running.store(true);
+    startTime = std::chrono::steady_clock::now();
+    processThread = std::thread(&AlgorithmRunner::runInProcess, this, std::move(algorithm));
+    
+    return true;
+}
+
 void AlgorithmRunner::stop() {
     if (!running.load()) {
         return;
@@ -107,12 +189,17 @@ void AlgorithmRunner::runAlgorithmProcess() {
                          configFile + " " + progressFile;
     
     std::cout << "Running algorithm: " << command << std::endl;
+    if (tracer) tracer->nameCurrentThread("algorithm.runner");
     
     // Start progress monitoring thread
     std::thread progressThread(&AlgorithmRunner::monitorProgress, this);
     
     // Execute algorithm
-    exitCode = system(command.c_str());
+    {
+        TraceScope trace(tracer, traceId, "algorithm.process");
+        exitCode = system(command.c_str());
+    }
+    processExited.store(true);
     
     // Wait for progress thread to finish
     if (progressThread.joinable()) {
@@ -127,6 +214,8 @@ void AlgorithmRunner::runAlgorithmProcess() {
         progress.store(1.0f);
         
         // Read result
+        TraceScope trace(tracer, traceId, "algorithm.parse_result");
+        PerfScope perf(metrics, "algorithm.parse_result");
         try {
             std::ifstream outputStream(outputFile);
             if (outputStream.is_open()) {
@@ -154,6 +243,7 @@ void AlgorithmRunner::runAlgorithmProcess() {
         resultData["errorMessage"] = "Algorithm exited with code " + std::to_string(exitCode);
     }
     
+    recordRunMetrics();
     running.store(false);
     
     // Call completion callback
@@ -161,11 +251,75 @@ void AlgorithmRunner::runAlgorithmProcess() {
         completionCallback(resultData);
     }
     
+    // Last holder of a deleted version frees it here
+    pinnedDataset.reset();
     cleanupTempFiles();
 }
 
+void AlgorithmRunner::runInProcess(InProcessAlgorithm algorithm) {
+    statusMessage = "running";
+    std::cout << "Running built-in algorithm: " << algorithmPath << std::endl;
+    if (tracer) tracer->nameCurrentThread("algorithm.runner");
+    
+    bool timedOut = false;
+    auto shouldStop = [this, &timedOut]() {
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - startTime);
+        if (!stopRequested.load() && elapsed.count() > timeoutSeconds) {
+            std::cout << "Algorithm timeout after " << elapsed.count() << " seconds" << std::endl;
+            timedOut = true;
+            stopRequested.store(true);
+        }
+        return stopRequested.load();
+    };
+    auto report = [this](float value, const std::string& status) {
+        progress.store(value);
+        statusMessage = status;
+        if (progressCallback) {
+            progressCallback(value, status, {{"progress", value}, {"status", status}});
+        }
+    };
+    
+    json result;
+    std::string error;
+    {
+        TraceScope trace(tracer, traceId, "algorithm.in_process");
+        try {
+            result = algorithm(shouldStop, report);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+    }
+    processExited.store(true);
+    
+    if (stopRequested.load()) {
+        statusMessage = timedOut ? "timeout" : "stopped";
+        progress.store(0.0f);
+    } else if (!error.empty()) {
+        statusMessage = "failed";
+        resultData["status"] = "error";
+        resultData["errorMessage"] = "Algorithm failed: " + error;
+    } else if (!validateResult(result)) {
+        statusMessage = "error";
+        resultData = {{"status", "error"}, {"errorMessage", "Invalid result format"}};
+    } else {
+        statusMessage = "completed";
+        progress.store(1.0f);
+        resultData = std::move(result);
+    }
+    
+    recordRunMetrics();
+    running.store(false);
+    
+    if (completionCallback) {
+        completionCallback(resultData);
+    }
+    
+    pinnedDataset.reset();
+}
+
 void AlgorithmRunner::monitorProgress() {
-    while (running.load() && !stopRequested.load()) {
+    // running stays set until the result is parsed, so the monitor also watches the process
+    while (running.load() && !stopRequested.load() && !processExited.load()) {
         updateProgress();
         
         // Check timeout
@@ -213,6 +367,22 @@ void AlgorithmRunner::updateProgress() {
     }
 }
 
+void AlgorithmRunner::recordRunMetrics() {
+    if (!metrics) {
+        return;
+    }
+    
+    std::string algorithmName = std::filesystem::path(algorithmPath).filename().string();
+    auto elapsed = std::chrono::steady_clock::now() - startTime;
+    
+    metrics->histogram("planner_algorithm_run_ms", {{"algorithm", algorithmName}},
+                       "Wall time of algorithm runs")
+        .record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()));
+    metrics->counter("planner_algorithm_runs_total", {{"algorithm", algorithmName}, {"outcome", statusMessage}},
+                     "Finished algorithm runs by outcome")
+        .increment();
+}
+
 void AlgorithmRunner::cleanupTempFiles() {
     auto removeFile = [](const std::string& file) {
         if (!file.empty() && std::filesystem::exists(file)) {
@@ -247,12 +417,12 @@ bool AlgorithmRunner::validateResult(const json& result) {
     }
     
     std::string status = result["status"];
-    if (status != "success" && status != "no_solution" && status != "error") {
+    if (status != "success" && status != "partial" && status != "no_solution" && status != "error") {
         return false;
     }
     
-    // If success, must have schedule
-    if (status == "success" && !result.contains("schedule")) {
+    // If success or partial, must have schedule
+    if ((status == "success" || status == "partial") && !result.contains("schedule")) {
         return false;
     }
     
@@ -1,4 +1,5 @@
 #include "algorithm/AlgorithmScanner.hpp"
+#include "schedule/BuiltInAlgorithms.hpp"
 #include <filesystem>
 #include <iostream>
 #include <fstream>
@@ -20,6 +21,7 @@ bool AlgorithmScanner::scanAlgorithms(const std::string& algorithmDirectory) {
     }
     
     algorithms.clear();
+    registerBuiltins();
     
     if (!std::filesystem::exists(algorithmsDirectory)) {
         std::cerr << "Algorithm directory does not exist: " << algorithmsDirectory << std::endl;
@@ -94,6 +96,29 @@ std::string AlgorithmScanner::getAlgorithmPath(const std::string& name) const {
     return "";
 }
 
+void AlgorithmScanner::registerBuiltins() {
+    AlgorithmInfo greedy;
+    greedy.name = BuiltInAlgorithms::GREEDY_NAME;
+    greedy.displayName = "Greedy DSATUR";
+    greedy.version = BuiltInAlgorithms::GREEDY_VERSION;
+    greedy.description = "Built-in constructive solver: most constrained lesson first, with teacher and room "
+                         "matching. Returns a clash-free schedule in milliseconds and lists lessons it could not place";
+    greedy.author = "System Team";
+    greedy.type = "constructive";
+    greedy.supportsProgress = true;
+    greedy.builtIn = true;
+    greedy.parameters = {
+        {"maxLessonsPerDay", {
+            {"type", "int"},
+            {"default", 0},
+            {"min", 0},
+            {"max", 24},
+            {"description", "Most lessons of one subject and group per day, 0 for no limit"}
+        }}
+    };
+    algorithms[greedy.name] = greedy;
+}
+
 void AlgorithmScanner::loadAlgorithmFromDirectory(const std::string& algorithmDir) {
     if (!isValidAlgorithmDirectory(algorithmDir)) {
         return;
@@ -104,7 +129,9 @@ void AlgorithmScanner::loadAlgorithmFromDirectory(const std::string& algorithmDi
     // Try to load info.json
     if (std::filesystem::exists(infoFile)) {
         AlgorithmInfo info = AlgorithmInfo::fromInfoFile(infoFile);
-        if (info.isValid()) {
+        if (algorithms.count(info.name) && algorithms[info.name].builtIn) {
+            std::cerr << "Algorithm in " << algorithmDir << " has the name of a built-in one, skipped" << std::endl;
+        } else if (info.isValid()) {
             algorithms[info.name] = info;
             std::cout << "Loaded algorithm: " << info.name << " (" << info.displayName << ")" << std::endl;
         } else {
@@ -121,7 +148,9 @@ void AlgorithmScanner::loadAlgorithmFromDirectory(const std::string& algorithmDi
         info.version = "1.0.0";
         info.supportsProgress = false;
         
-        if (info.isValid()) {
+        if (algorithms.count(info.name) && algorithms[info.name].builtIn) {
+            std::cerr << "Algorithm in " << algorithmDir << " has the name of a built-in one, skipped" << std::endl;
+        } else if (info.isValid()) {
             algorithms[info.name] = info;
             std::cout << "Created minimal info for algorithm: " << info.name << std::endl;
         }
@@ -0,0 +1,250 @@
+#include "algorithm/JobStore.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    // Compact the log once superseded records are at least half as many as jobs
+    constexpr size_t COMPACTION_MIN_RECORDS = 64;
+
+    uint64_t idNumber(const std::string& id) {
+        // IDs are "job-N"
+        return id.rfind("job-", 0) == 0 ? std::strtoull(id.c_str() + 4, nullptr, 10) : 0;
+    }
+}
+
+JobStore::JobStore(MetricsRegistry& metrics)
+    : storedJobs(metrics.gauge("planner_jobs_stored", {}, "Algorithm jobs held by the job store")),
+      resultLoads(metrics.counter("planner_job_result_loads_total", {}, "Job results read from disk because they were not cached")),
+      nextId(1) {
+}
+
+bool JobStore::open(const std::string& directory) {
+    std::error_code fsError;
+    std::filesystem::create_directories(directory + "/results", fsError);
+    if (fsError) {
+        std::cerr << "Cannot create data directory " << directory << ": " << fsError.message() << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string error;
+    if (!log.open(directory + "/jobs.log", [this](const json& record) { replay(record); }, error)) {
+        std::cerr << "JobStore: " << error << std::endl;
+        jobs.clear();
+        nextId = 1;
+        return false;
+    }
+    dataDirectory = directory;
+
+    // Whatever was still running died with the previous process
+    for (auto& [id, info] : jobs) {
+        if (info.value("status", "") == "running") {
+            info["status"] = "interrupted";
+        }
+    }
+
+    // A finished job has a start and a finish record; compaction merges them into one
+    size_t records = log.recordCount();
+    if (records > COMPACTION_MIN_RECORDS && records - std::min(records, jobs.size()) >= jobs.size() / 2) {
+        std::vector<json> live;
+        live.reserve(jobs.size());
+        for (const auto& [id, info] : jobs) {
+            json record = info;
+            record["op"] = "start";
+            live.push_back(std::move(record));
+        }
+        std::sort(live.begin(), live.end(), [](const json& a, const json& b) {
+            return idNumber(a["job_id"]) < idNumber(b["job_id"]);
+        });
+        log.rewrite(live);
+    }
+
+    storedJobs.set(static_cast<int64_t>(jobs.size()));
+    std::cout << "JobStore: restored " << jobs.size() << " jobs from " << directory << std::endl;
+    return true;
+}
+
+void JobStore::replay(const json& record) {
+    std::string op = record.value("op", "");
+    std::string id = record.value("job_id", "");
+    if (id.empty()) {
+        return;
+    }
+
+    if (op == "start") {
+        json info = record;
+        info.erase("op");
+        jobs[id] = std::move(info);
+        nextId = std::max(nextId, idNumber(id) + 1);
+    } else if (op == "finish") {
+        auto it = jobs.find(id);
+        if (it != jobs.end()) {
+            it->second["status"] = record.value("status", "");
+            it->second["result_status"] = record.value("result_status", "");
+            it->second["finished_at"] = record.value("finished_at", int64_t(0));
+        }
+    }
+}
+
+std::string JobStore::begin(const std::string& algorithm, const std::string& datasetId, const std::string& contentHash,
+                            const json& config) {
+    json info;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string id = "job-" + std::to_string(nextId++);
+        info = {
+            {"job_id", id},
+            {"algorithm", algorithm},
+            {"dataset_id", datasetId},
+            {"content_hash", contentHash},
+            {"config", config},
+            {"status", "running"},
+            {"started_at", static_cast<int64_t>(std::time(nullptr))}
+        };
+        jobs[id] = info;
+        storedJobs.set(static_cast<int64_t>(jobs.size()));
+    }
+
+    if (!dataDirectory.empty()) {
+        json record = info;
+        record["op"] = "start";
+        log.append(record);
+    }
+    return info["job_id"];
+}
+
+void JobStore::finish(const std::string& jobId, const std::string& status, const json& result) {
+    json record = {
+        {"op", "finish"},
+        {"job_id", jobId},
+        {"status", status},
+        {"result_status", result.is_object() ? result.value("status", "") : ""},
+        {"finished_at", static_cast<int64_t>(std::time(nullptr))}
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = jobs.find(jobId);
+        if (it == jobs.end()) {
+            return;
+        }
+        it->second["status"] = record["status"];
+        it->second["result_status"] = record["result_status"];
+        it->second["finished_at"] = record["finished_at"];
+        cacheResult(jobId, std::make_shared<const json>(result));
+    }
+
+    if (dataDirectory.empty()) {
+        return;
+    }
+
+    // Result file first: a logged finish always has its result
+    std::string path = resultPath(jobId);
+    {
+        std::ofstream out(path + ".tmp", std::ios::trunc);
+        out << result.dump();
+        if (!out) {
+            std::cerr << "Result of " << jobId << " was not persisted" << std::endl;
+            return;
+        }
+    }
+    std::error_code renameError;
+    std::filesystem::rename(path + ".tmp", path, renameError);
+    if (renameError) {
+        std::cerr << "Result of " << jobId << " was not persisted: " << renameError.message() << std::endl;
+        return;
+    }
+    log.append(record);
+}
+
+std::shared_ptr<const json> JobStore::getResult(const std::string& jobId) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = results.begin(); it != results.end(); ++it) {
+            if (it->first == jobId) {
+                results.splice(results.begin(), results, it);
+                return results.front().second;
+            }
+        }
+        auto it = jobs.find(jobId);
+        if (it == jobs.end() || dataDirectory.empty() || !it->second.contains("finished_at")) {
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<const json> loaded;
+    try {
+        std::ifstream in(resultPath(jobId));
+        if (!in.is_open()) {
+            return nullptr;
+        }
+        loaded = std::make_shared<const json>(json::parse(in));
+    } catch (const json::parse_error& e) {
+        std::cerr << "Result of " << jobId << " is unreadable: " << e.what() << std::endl;
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    resultLoads.increment();
+    for (const auto& entry : results) {
+        if (entry.first == jobId) {
+            return entry.second;
+        }
+    }
+    cacheResult(jobId, loaded);
+    return loaded;
+}
+
+void JobStore::cacheResult(const std::string& jobId, std::shared_ptr<const json> result) {
+    results.emplace_front(jobId, std::move(result));
+    if (results.size() > MAX_CACHED_RESULTS) {
+        results.pop_back();
+    }
+}
+
+json JobStore::getInfo(const std::string& jobId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = jobs.find(jobId);
+    return it != jobs.end() ? it->second : json();
+}
+
+std::string JobStore::findCompleted(const std::string& algorithm, const std::string& contentHash, const json& config) const {
+    if (contentHash.empty()) {
+        return "";
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string latest;
+    for (const auto& [id, info] : jobs) {
+        if (info.value("status", "") == "completed" && info.value("algorithm", "") == algorithm &&
+            info.value("content_hash", "") == contentHash && info.value("config", json()) == config &&
+            (latest.empty() || idNumber(id) > idNumber(latest))) {
+            latest = id;
+        }
+    }
+    return latest;
+}
+
+std::vector<json> JobStore::list() const {
+    std::vector<json> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        result.reserve(jobs.size());
+        for (const auto& [id, info] : jobs) {
+            result.push_back(info);
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const json& a, const json& b) {
+        return idNumber(a.value("job_id", "")) < idNumber(b.value("job_id", ""));
+    });
+    return result;
+}
+
+std::string JobStore::resultPath(const std::string& jobId) const {
+    return dataDirectory + "/results/" + jobId + ".json";
+}
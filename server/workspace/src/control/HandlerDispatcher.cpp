@@ -18,10 +18,20 @@ bool HandlerDispatcher::dispatch(const std::string& messageId, const std::string
         return false;
     }
     
+    std::string typeName = json(type).get<std::string>();
+    std::string spanName = "handler." + typeName;
+    TraceScope trace(&system.getTracer(), messageId, spanName.c_str());
+    
+    MetricsRegistry::Labels labels = {{"type", typeName}};
+    ScopedTimer timer(system.getMetrics().histogram("planner_handler_latency_us", labels,
+                                                    "Handler execution time per message type"));
+    
     try {
         it->second->handle(messageId, payload, system);
         return true;
     } catch (const std::exception& e) {
+        system.getMetrics().counter("planner_handler_errors_total", labels,
+                                    "Handler invocations that threw").increment();
         std::cerr << "Error handling message " << messageId << ": " << e.what() << std::endl;
         return false;
     }
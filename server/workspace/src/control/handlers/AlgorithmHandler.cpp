@@ -1,16 +1,90 @@
 #include "control/handlers/AlgorithmHandler.hpp"
 #include "core/System.hpp"
+#include "metrics/PerfCounters.hpp"
+#include "schedule/GreedySolver.hpp"
+#include "schedule/IncrementalEvaluator.hpp"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace {
+    const std::vector<std::string> AVAILABLE_COMMANDS = {"list", "run", "stop", "status", "jobs", "result", "evaluate"};
+    
+    /**
+     * @return The built-in algorithm of that name bound to a compiled dataset, or nullptr
+     */
+    AlgorithmRunner::InProcessAlgorithm builtinAlgorithm(const std::string& name,
+                                                         std::shared_ptr<const CompiledDataset> compiled,
+                                                         const json& config) {
+        if (name == GreedySolver::NAME) {
+            return [compiled, config](const std::function<bool()>& shouldStop,
+                                      const std::function<void(float, const std::string&)>& report) {
+                return GreedySolver::solve(*compiled, config, shouldStop, report);
+            };
+        }
+        return nullptr;
+    }
+    
+    /**
+     * Runs random moves through an IncrementalEvaluator, keeping the improving
+     * ones, and checks the final cost against a full evaluation
+     */
+    json probeMoves(const ProblemModel& model, const CompiledConstraints& constraints, const Assignment& assignment,
+                    int moves) {
+        IncrementalEvaluator evaluator(model, constraints, assignment);
+        int64_t initialCost = evaluator.cost();
+        std::mt19937 random(1);
+        auto pick = [&](size_t count) { return static_cast<uint32_t>(random() % count); };
+        
+        int applied = 0;
+        auto started = std::chrono::steady_clock::now();
+        for (int i = 0; i < moves; ++i) {
+            uint32_t event = pick(assignment.events.size());
+            Move move;
+            switch (i % 3) {
+                case 0: move = Move::reassign(event, pick(model.timeBlocks().size())); break;
+                case 1: move = Move::reassign(event, NO_ENTITY, pick(model.rooms().size())); break;
+                default: move = Move::swap(event, pick(assignment.events.size())); break;
+            }
+            if (evaluator.delta(move) < 0) {
+                evaluator.apply(move);
+                evaluator.commit();
+                ++applied;
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        
+        int64_t fullCost = ScheduleEvaluator::evaluate(model, constraints, evaluator.assignment()).cost;
+        return {
+            {"moves", moves},
+            {"applied", applied},
+            {"moves_per_second", seconds > 0 ? static_cast<int64_t>(moves / seconds) : 0},
+            {"initial_cost", initialCost},
+            {"final_cost", evaluator.cost()},
+            {"consistent", fullCost == evaluator.cost()}
+        };
+    }
+}
 
 void AlgorithmHandler::handle(const std::string& messageId, const std::string& payload, System& system) {
     std::cout << "AlgorithmHandler: Received message " << messageId << std::endl;
     
     try {
-        json algorithmData = json::parse(payload);
+        json algorithmData;
+        {
+            PerfScope perf(&system.getMetrics(), "handler.parse.Algorithm");
+            algorithmData = json::parse(payload);
+        }
         
         if (algorithmData.contains("command")) {
             std::string algorithmCmd = algorithmData["command"];
             
+            bool known = std::find(AVAILABLE_COMMANDS.begin(), AVAILABLE_COMMANDS.end(), algorithmCmd) != AVAILABLE_COMMANDS.end();
+            ScopedTimer timer(system.getMetrics().histogram("planner_command_latency_us",
+                {{"type", "Algorithm"}, {"command", known ? algorithmCmd : "unknown"}},
+                "Handler execution time per command"));
+            
             if (algorithmCmd == "list") {
                 handleList(messageId, system);
             } else if (algorithmCmd == "run") {
@@ -19,12 +93,18 @@ void AlgorithmHandler::handle(const std::string& messageId, const std::string& p
                 handleStop(messageId, system);
             } else if (algorithmCmd == "status") {
                 handleStatus(messageId, system);
+            } else if (algorithmCmd == "jobs") {
+                handleJobs(messageId, system);
+            } else if (algorithmCmd == "result") {
+                handleResult(messageId, algorithmData, system);
+            } else if (algorithmCmd == "evaluate") {
+                handleEvaluate(messageId, algorithmData, system);
             } else {
                 json response = {
                     {"status", "error"},
                     {"message", "Unknown algorithm command: " + algorithmCmd},
                     {"error_code", "UNKNOWN_ALGORITHM_COMMAND"},
-                    {"available_commands", {"list", "run", "stop", "status"}}
+                    {"available_commands", AVAILABLE_COMMANDS}
                 };
                 system.sendMessage(messageId, response.dump(), MessageType::Algorithm);
             }
@@ -70,7 +150,8 @@ void AlgorithmHandler::handleList(const std::string& messageId, System& system)
             {"description", algo.description},
             {"author", algo.author},
             {"type", algo.type},
-            {"supportsProgress", algo.supportsProgress}
+            {"supportsProgress", algo.supportsProgress},
+            {"builtIn", algo.builtIn}
         };
         
         if (!algo.parameters.empty()) {
@@ -97,10 +178,10 @@ void AlgorithmHandler::handleRun(const std::string& messageId, const json& reque
         return;
     }
     
-    if (!request.contains("data")) {
+    if (!request.contains("data") && !request.contains("datasetId")) {
         json response = {
             {"status", "error"},
-            {"message", "Missing 'data' field"},
+            {"message", "Missing 'data' or 'datasetId' field"},
             {"error_code", "MISSING_DATA"}
         };
         system.sendMessage(messageId, response.dump(), MessageType::Algorithm);
@@ -119,9 +200,24 @@ void AlgorithmHandler::handleRun(const std::string& messageId, const json& reque
     }
     
     std::string algorithmName = request["name"];
-    json inputData = request["data"];
     json config = request.value("config", json::object());
     
+    // Stored datasets are shared, inline data only lives as long as this request
+    std::shared_ptr<const Dataset> dataset;
+    if (request.contains("datasetId")) {
+        std::string datasetId = request["datasetId"];
+        dataset = system.getDatasetStore().get(datasetId);
+        if (!dataset) {
+            json response = {
+                {"status", "error"},
+                {"message", "Dataset not found: " + datasetId},
+                {"error_code", "DATASET_NOT_FOUND"}
+            };
+            system.sendMessage(messageId, response.dump(), MessageType::Algorithm);
+            return;
+        }
+    }
+    
     // Check if algorithm exists
     if (!system.getAlgorithmScanner().hasAlgorithm(algorithmName)) {
         json response = {
@@ -146,29 +242,109 @@ void AlgorithmHandler::handleRun(const std::string& messageId, const json& reque
         return;
     }
     
+    // A finished job with the same input can answer without solving again
+    std::string datasetId = dataset ? dataset->id : "";
+    std::string contentHash = dataset ? dataset->contentHash : "";
+    if (request.value("reuse", false)) {
+        std::string jobId = system.getJobStore().findCompleted(algorithmName, contentHash, config);
+        auto stored = jobId.empty() ? nullptr : system.getJobStore().getResult(jobId);
+        if (stored) {
+            std::cout << "Reusing result of " << jobId << std::endl;
+            json response = {
+                {"status", "completed"},
+                {"message", "Stored result reused"},
+                {"job_id", jobId},
+                {"cached", true},
+                {"result", *stored}
+            };
+            system.sendMessage(messageId, response.dump(), MessageType::Algorithm);
+            return;
+        }
+    }
+    
+    // Built-in algorithms work on the compiled form, inline data included
+    bool builtIn = system.getAlgorithmScanner().getAlgorithm(algorithmName).builtIn;
+    std::shared_ptr<const CompiledDataset> compiled;
+    std::string compileError;
+    if (dataset) {
+        compiled = system.getModelCache().get(*dataset, compileError);
+    } else if (builtIn) {
+        Dataset inlineDataset;
+        inlineDataset.setSections(Dataset::split(request["data"]));
+        inlineDataset.contentHash = Dataset::computeHash(inlineDataset.sections(), inlineDataset.sizeBytes);
+        compiled = system.getModelCache().get(inlineDataset, compileError);
+    }
+    if (builtIn && !compiled) {
+        json response = {
+            {"status", "error"},
+            {"message", "Dataset cannot be compiled: " + compileError},
+            {"error_code", "INVALID_DATASET"}
+        };
+        system.sendMessage(messageId, response.dump(), MessageType::Algorithm);
+        return;
+    }
+    
+    // With "precheck", a dataset that provably has no schedule is refused before any solver time is spent
+    if (compiled && request.value("precheck", false) && !compiled->diagnosis->feasible()) {
+        json diagnosis = compiled->diagnosis->toJson();
+        json response = {
+            {"status", "error"},
+            {"message", "Dataset cannot be scheduled: " + diagnosis["certificates"][0].value("message", "")},
+            {"error_code", "INFEASIBLE_DATASET"},
+            {"diagnosis", diagnosis}
+        };
+        system.sendMessage(messageId, response.dump(), MessageType::Algorithm);
+        return;
+    }
+    
     std::cout << "Starting algorithm: " << algorithmName << std::endl;
+    std::string jobId = system.getJobStore().begin(algorithmName, datasetId, contentHash, config);
     
     // Set up callbacks
     auto progressCallback = [this, messageId, &system](float progress, const std::string& status, const json& progressData) {
         this->onProgress(progress, status, progressData, messageId, system);
     };
     
-    auto completionCallback = [this, messageId, &system](const json& resultData) {
-        this->onCompletion(resultData, messageId, system);
+    auto completionCallback = [this, messageId, jobId, &system](const json& resultData) {
+        this->onCompletion(resultData, messageId, jobId, system);
     };
     
+    // Stored datasets come with their lesson requirements and presolved domains, so algorithms need not derive them
+    DatasetSections extraSections;
+    if (compiled && !builtIn) {
+        auto toSection = [](json items) {
+            auto section = std::make_shared<DatasetSection>();
+            for (json& item : items) {
+                section->items.push_back(std::make_shared<const json>(std::move(item)));
+            }
+            return section;
+        };
+        extraSections["lessonRequirements"] = toSection(compiled->demand->toJson(*compiled->model));
+        extraSections["lessonDomains"] = toSection(compiled->domains->toJson(*compiled->model));
+    }
+    
     // Get algorithm path and start
     std::string algorithmPath = system.getAlgorithmScanner().getAlgorithmPath(algorithmName);
-    bool started = system.getAlgorithmRunner().start(algorithmPath, inputData, config, progressCallback, completionCallback);
+    bool started = builtIn
+        ? system.getAlgorithmRunner().startInProcess(algorithmName, builtinAlgorithm(algorithmName, compiled, config),
+                                                     progressCallback, completionCallback,
+                                                     AlgorithmRunner::DEFAULT_TIMEOUT_SECONDS, messageId, dataset)
+        : dataset
+        ? system.getAlgorithmRunner().start(algorithmPath, dataset, config, progressCallback, completionCallback,
+                                            AlgorithmRunner::DEFAULT_TIMEOUT_SECONDS, messageId, extraSections)
+        : system.getAlgorithmRunner().start(algorithmPath, request["data"], config, progressCallback, completionCallback,
+                                            AlgorithmRunner::DEFAULT_TIMEOUT_SECONDS, messageId);
     
     if (started) {
         json response = {
             {"status", "started"},
             {"algorithm", algorithmName},
+            {"job_id", jobId},
             {"message", "Algorithm execution started"}
         };
         system.sendMessage(messageId, response.dump(), MessageType::Algorithm);
     } else {
+        system.getJobStore().finish(jobId, "failed", {{"status", "error"}, {"errorMessage", "Failed to start algorithm"}});
         json response = {
             {"status", "error"},
             {"message", "Failed to start algorithm"},
@@ -227,6 +403,137 @@ void AlgorithmHandler::handleStatus(const std::string& messageId, System& system
     system.sendMessage(messageId, response.dump(), MessageType::Algorithm);
 }
 
+void AlgorithmHandler::handleJobs(const std::string& messageId, System& system) {
+    std::cout << "=== ALGORITHM: JOBS ===" << std::endl;
+    
+    json response = {
+        {"status", "success"},
+        {"jobs", system.getJobStore().list()}
+    };
+    system.sendMessage(messageId, response.dump(), MessageType::Algorithm);
+}
+
+void AlgorithmHandler::handleResult(const std::string& messageId, const json& request, System& system) {
+    std::cout << "=== ALGORITHM: RESULT ===" << std::endl;
+    
+    std::string jobId = request.value("jobId", "");
+    json info = system.getJobStore().getInfo(jobId);
+    if (info.is_null()) {
+        json response = {
+            {"status", "error"},
+            {"message", "Job not found: " + jobId},
+            {"error_code", "JOB_NOT_FOUND"}
+        };
+        system.sendMessage(messageId, response.dump(), MessageType::Algorithm);
+        return;
+    }
+    
+    auto result = system.getJobStore().getResult(jobId);
+    if (!result) {
+        json response = {
+            {"status", "error"},
+            {"message", "No result for job " + jobId + " (" + info.value("status", "") + ")"},
+            {"error_code", "RESULT_NOT_AVAILABLE"},
+            {"job", info}
+        };
+        system.sendMessage(messageId, response.dump(), MessageType::Algorithm);
+        return;
+    }
+    
+    json response = {
+        {"status", "success"},
+        {"job", info},
+        {"result", *result}
+    };
+    system.sendMessage(messageId, response.dump(), MessageType::Algorithm);
+}
+
+void AlgorithmHandler::handleEvaluate(const std::string& messageId, const json& request, System& system) {
+    std::cout << "=== ALGORITHM: EVALUATE ===" << std::endl;
+    
+    auto sendError = [&](const std::string& message, const std::string& code) {
+        json response = {
+            {"status", "error"},
+            {"message", message},
+            {"error_code", code}
+        };
+        system.sendMessage(messageId, response.dump(), MessageType::Algorithm);
+    };
+    
+    // Either a finished job (its dataset and result) or a dataset and a schedule given here
+    std::string datasetId = request.value("datasetId", "");
+    std::shared_ptr<const json> jobResult;
+    if (request.contains("jobId")) {
+        std::string jobId = request.value("jobId", "");
+        json info = system.getJobStore().getInfo(jobId);
+        if (info.is_null()) {
+            sendError("Job not found: " + jobId, "JOB_NOT_FOUND");
+            return;
+        }
+        jobResult = system.getJobStore().getResult(jobId);
+        if (!jobResult) {
+            sendError("No result for job " + jobId + " (" + info.value("status", "") + ")", "RESULT_NOT_AVAILABLE");
+            return;
+        }
+        if (datasetId.empty()) {
+            datasetId = info.value("dataset_id", "");
+        }
+    }
+    
+    const json* schedule = nullptr;
+    if (request.contains("schedule")) {
+        schedule = &request["schedule"];
+    } else if (jobResult) {
+        schedule = jobResult->contains("schedule") ? &(*jobResult)["schedule"] : jobResult.get();
+    } else {
+        sendError("Missing 'jobId' or 'schedule' field", "MISSING_SCHEDULE");
+        return;
+    }
+    
+    auto dataset = system.getDatasetStore().get(datasetId);
+    if (!dataset) {
+        sendError("Dataset not found: " + datasetId, "DATASET_NOT_FOUND");
+        return;
+    }
+    
+    std::string error;
+    auto compiled = system.getModelCache().get(*dataset, error);
+    if (!compiled) {
+        sendError("Dataset cannot be compiled: " + error, "INVALID_DATASET");
+        return;
+    }
+    const auto& model = compiled->model;
+    const auto& constraints = compiled->constraints;
+    
+    json eventErrors;
+    Assignment assignment = Assignment::fromJson(*model, *schedule, eventErrors);
+    
+    Evaluation evaluation;
+    auto started = std::chrono::steady_clock::now();
+    {
+        PerfScope perf(&system.getMetrics(), "schedule.evaluate");
+        evaluation = ScheduleEvaluator::evaluate(*model, *constraints, assignment);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - started;
+    
+    json response = {
+        {"status", "success"},
+        {"dataset_id", datasetId},
+        {"events", assignment.events.size()},
+        {"event_errors", eventErrors},
+        {"constraints", constraints->summary()},
+        {"evaluation", ScheduleEvaluator::report(*model, *constraints, evaluation)},
+        {"evaluate_us", std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()}
+    };
+    
+    int moves = request.value("probe_moves", 0);
+    if (moves > 0 && !assignment.events.empty()) {
+        PerfScope perf(&system.getMetrics(), "schedule.probe_moves");
+        response["probe"] = probeMoves(*model, *constraints, assignment, moves);
+    }
+    system.sendMessage(messageId, response.dump(), MessageType::Algorithm);
+}
+
 void AlgorithmHandler::onProgress(float progress, const std::string& status, const json& progressData, 
                                  const std::string& messageId, System& system) {
     std::cout << "Algorithm progress: " << progress << ", status: " << status 
@@ -234,12 +541,15 @@ void AlgorithmHandler::onProgress(float progress, const std::string& status, con
     // Progress updates could be sent as notifications if needed
 }
 
-void AlgorithmHandler::onCompletion(const json& resultData, const std::string& messageId, System& system) {
+void AlgorithmHandler::onCompletion(const json& resultData, const std::string& messageId, const std::string& jobId,
+                                    System& system) {
     std::cout << "Algorithm completed with result: " << resultData.dump() << std::endl;
+    system.getJobStore().finish(jobId, system.getAlgorithmRunner().getStatus(), resultData);
     
     json response = {
         {"status", "completed"},
         {"message", "Algorithm execution completed"},
+        {"job_id", jobId},
         {"result", resultData}
     };
     system.sendMessage(messageId, response.dump(), MessageType::Algorithm);
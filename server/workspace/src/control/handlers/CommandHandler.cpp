@@ -1,36 +1,54 @@
 #include "control/handlers/CommandHandler.hpp"
 #include "core/System.hpp"
+#include "metrics/PerfCounters.hpp"
 #include "extern/nlohmann/json.hpp"
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <ctime>
+#include <algorithm>
 
 using json = nlohmann::json;
 
+namespace {
+    const std::vector<std::string> AVAILABLE_COMMANDS = {"stop", "status", "ping", "metrics"};
+}
+
 void CommandHandler::handle(const std::string& messageId, const std::string& payload, System& system) {
     std::cout << "CommandHandler: Received message " << messageId << std::endl;
     
     try {
         // Try to parse as JSON
-        json commandData = json::parse(payload);
+        json commandData;
+        {
+            PerfScope perf(&system.getMetrics(), "handler.parse.Command");
+            commandData = json::parse(payload);
+        }
         
         if (commandData.contains("command")) {
             std::string command = commandData["command"];
             
+            // Unknown commands share one series so clients cannot grow the registry
+            bool known = std::find(AVAILABLE_COMMANDS.begin(), AVAILABLE_COMMANDS.end(), command) != AVAILABLE_COMMANDS.end();
+            ScopedTimer timer(system.getMetrics().histogram("planner_command_latency_us",
+                {{"type", "Command"}, {"command", known ? command : "unknown"}},
+                "Handler execution time per command"));
+            
             if (command == "stop") {
                 handleStopCommand(messageId, commandData, system);
             } else if (command == "status") {
                 handleStatusCommand(messageId, commandData, system);
             } else if (command == "ping") {
                 handlePingCommand(messageId, commandData, system);
+            } else if (command == "metrics") {
+                handleMetricsCommand(messageId, commandData, system);
             } else {
                 // Unknown command
                 json response = {
                     {"status", "error"},
                     {"message", "Unknown command: " + command},
                     {"error_code", "UNKNOWN_COMMAND"},
-                    {"available_commands", {"stop", "status", "ping"}}
+                    {"available_commands", AVAILABLE_COMMANDS}
                 };
                 system.sendMessage(messageId, response.dump(), MessageType::Command);
             }
@@ -108,7 +126,7 @@ void CommandHandler::handleStatusCommand(const std::string& messageId, const jso
         {"data", {
             {"server_running", system.isRunning()},
             {"client_connected", system.isClientConnected()},
-            {"uptime", "unknown"} // to be implemented
+            {"uptime", system.getUptimeSeconds()}
         }}
     };
     
@@ -127,3 +145,26 @@ void CommandHandler::handlePingCommand(const std::string& messageId, const json&
     
     system.sendMessage(messageId, response.dump(), MessageType::Command);
 }
+
+void CommandHandler::handleMetricsCommand(const std::string& messageId, const json& commandData, System& system) {
+    std::cout << "Executing METRICS command" << std::endl;
+    
+    std::string format = commandData.value("format", "json");
+    
+    json response = {
+        {"status", "success"},
+        {"command", "metrics"},
+        {"timestamp", std::time(nullptr)}
+    };
+    
+    if (format == "prometheus") {
+        response["data"] = {
+            {"format", "prometheus"},
+            {"text", system.getMetrics().toPrometheus()}
+        };
+    } else {
+        response["data"] = system.getMetrics().toJson();
+    }
+    
+    system.sendMessage(messageId, response.dump(), MessageType::Command);
+}
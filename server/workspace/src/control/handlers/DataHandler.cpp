@@ -1,25 +1,613 @@
 #include "control/handlers/DataHandler.hpp"
 #include "core/System.hpp"
-#include "extern/nlohmann/json.hpp"
+#include "dataset/CsvImport.hpp"
+#include "dataset/DatasetPatch.hpp"
+#include "dataset/DatasetValidator.hpp"
+#include "metrics/PerfCounters.hpp"
+#include "schedule/FeasibilityMatrices.hpp"
+#include "schedule/ProblemModel.hpp"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
 #include <ctime>
+#include <filesystem>
+#include <fstream>
 
-using json = nlohmann::json;
+namespace {
+    const std::vector<std::string> AVAILABLE_COMMANDS = {"upload", "has", "patch", "import", "validate", "compile", "demand", "diagnose", "get", "list", "delete"};
+}
+
+DataHandler::DataHandler(std::string importDirectory)
+    : importDirectory(std::move(importDirectory)) {
+}
 
 void DataHandler::handle(const std::string& messageId, const std::string& payload, System& system) {
     std::cout << "DataHandler: Received message " << messageId << std::endl;
-    
-    // Send acknowledgment that data was received
-    json ackResponse = {
+
+    try {
+        json dataRequest;
+        {
+            PerfScope perf(&system.getMetrics(), "handler.parse.Data");
+            dataRequest = json::parse(payload);
+        }
+
+        // Payloads without a command are plain data pushes, acknowledged as before
+        if (!dataRequest.contains("command")) {
+            json ackResponse = {
+                {"status", "success"},
+                {"message", "Data received and processed"},
+                {"message_id", messageId},
+                {"timestamp", std::time(nullptr)}
+            };
+            system.sendMessage(messageId, ackResponse.dump(), MessageType::Data);
+            return;
+        }
+
+        std::string dataCmd = dataRequest["command"];
+
+        bool known = std::find(AVAILABLE_COMMANDS.begin(), AVAILABLE_COMMANDS.end(), dataCmd) != AVAILABLE_COMMANDS.end();
+        ScopedTimer timer(system.getMetrics().histogram("planner_command_latency_us",
+            {{"type", "Data"}, {"command", known ? dataCmd : "unknown"}},
+            "Handler execution time per command"));
+
+        if (dataCmd == "upload") {
+            handleUpload(messageId, dataRequest, system);
+        } else if (dataCmd == "has") {
+            handleHas(messageId, dataRequest, system);
+        } else if (dataCmd == "patch") {
+            handlePatch(messageId, dataRequest, system);
+        } else if (dataCmd == "import") {
+            handleImport(messageId, dataRequest, system);
+        } else if (dataCmd == "validate") {
+            handleValidate(messageId, dataRequest, system);
+        } else if (dataCmd == "compile") {
+            handleCompile(messageId, dataRequest, system);
+        } else if (dataCmd == "demand") {
+            handleDemand(messageId, dataRequest, system);
+        } else if (dataCmd == "diagnose") {
+            handleDiagnose(messageId, dataRequest, system);
+        } else if (dataCmd == "get") {
+            handleGet(messageId, dataRequest, system);
+        } else if (dataCmd == "list") {
+            handleList(messageId, system);
+        } else if (dataCmd == "delete") {
+            handleDelete(messageId, dataRequest, system);
+        } else {
+            json response = {
+                {"status", "error"},
+                {"message", "Unknown data command: " + dataCmd},
+                {"error_code", "UNKNOWN_DATA_COMMAND"},
+                {"available_commands", AVAILABLE_COMMANDS}
+            };
+            system.sendMessage(messageId, response.dump(), MessageType::Data);
+        }
+
+    } catch (const std::exception& e) {
+        std::cerr << "DataHandler: Error parsing payload: " << e.what() << std::endl;
+        json response = {
+            {"status", "error"},
+            {"message", "Invalid JSON format"},
+            {"error_code", "INVALID_JSON"}
+        };
+        system.sendMessage(messageId, response.dump(), MessageType::Data);
+    }
+}
+
+MessageType DataHandler::getHandledType() const {
+    return MessageType::Data;
+}
+
+void DataHandler::handleUpload(const std::string& messageId, json& request, System& system) {
+    std::cout << "=== DATA: UPLOAD ===" << std::endl;
+
+    if (!request.contains("data") || !request["data"].is_object()) {
+        sendError(messageId, "upload", "Missing 'data' object", "MISSING_DATA", system);
+        return;
+    }
+
+    // The request is discarded afterwards, so the parsed tree is moved rather than copied
+    DatasetSections sections = Dataset::split(std::move(request["data"]));
+    json validationErrors;
+    if (!checkIntegrity(messageId, "upload", sections, request, validationErrors, system)) {
+        return;
+    }
+
+    bool persisted = false;
+    auto [dataset, stored] = system.getDatasetStore().addSections(std::move(sections), &persisted);
+
+    if (stored) {
+        std::cout << "Stored dataset " << dataset->id << " (" << dataset->sizeBytes << " bytes)" << std::endl;
+    } else {
+        std::cout << "Upload matches stored dataset " << dataset->id << std::endl;
+    }
+
+    json data = dataset->summary();
+    data["deduplicated"] = !stored;
+    data["persisted"] = persisted;
+    if (!validationErrors.empty()) {
+        data["validation_errors"] = validationErrors;
+    }
+
+    json response = {
         {"status", "success"},
-        {"message", "Data received and processed"},
-        {"message_id", messageId},
+        {"command", "upload"},
+        {"message", stored ? "Dataset stored" : "Dataset already stored"},
+        {"data", data},
         {"timestamp", std::time(nullptr)}
     };
-    
-    system.sendMessage(messageId, ackResponse.dump(), MessageType::Data);
+    system.sendMessage(messageId, response.dump(), MessageType::Data);
 }
 
-MessageType DataHandler::getHandledType() const {
-    return MessageType::Data;
-}
\ No newline at end of file
+void DataHandler::handleHas(const std::string& messageId, const json& request, System& system) {
+    std::cout << "=== DATA: HAS ===" << std::endl;
+
+    if (!request.contains("hash") || !request["hash"].is_string()) {
+        sendError(messageId, "has", "Missing 'hash' field", "MISSING_HASH", system);
+        return;
+    }
+
+    // Answered from the hash index, the dataset itself is not loaded
+    std::string datasetId = system.getDatasetStore().findByHash(request["hash"].get<std::string>());
+
+    json data = {{"exists", !datasetId.empty()}};
+    if (!datasetId.empty()) {
+        data["dataset_id"] = datasetId;
+    }
+
+    json response = {
+        {"status", "success"},
+        {"command", "has"},
+        {"data", data},
+        {"timestamp", std::time(nullptr)}
+    };
+    system.sendMessage(messageId, response.dump(), MessageType::Data);
+}
+
+void DataHandler::handlePatch(const std::string& messageId, const json& request, System& system) {
+    std::cout << "=== DATA: PATCH ===" << std::endl;
+
+    std::string datasetId = request.value("datasetId", "");
+    auto base = system.getDatasetStore().get(datasetId);
+    if (!base) {
+        sendError(messageId, "patch", "Dataset not found: " + datasetId, "DATASET_NOT_FOUND", system);
+        return;
+    }
+
+    std::vector<std::string> errors;
+    DatasetSections sections = DatasetPatch::apply(base->sections(), request.value("ops", json()), errors);
+    if (!errors.empty()) {
+        json response = {
+            {"status", "error"},
+            {"command", "patch"},
+            {"message", "Patch rejected, dataset unchanged"},
+            {"error_code", "INVALID_PATCH"},
+            {"errors", errors},
+            {"timestamp", std::time(nullptr)}
+        };
+        system.sendMessage(messageId, response.dump(), MessageType::Data);
+        return;
+    }
+
+    json validationErrors;
+    if (!checkIntegrity(messageId, "patch", sections, request, validationErrors, system)) {
+        return;
+    }
+
+    bool persisted = false;
+    auto [dataset, stored] = system.getDatasetStore().addVersion(*base, std::move(sections), &persisted);
+
+    std::cout << "Patched " << base->id << " into " << dataset->id << std::endl;
+
+    json data = dataset->summary();
+    data["deduplicated"] = !stored;
+    data["persisted"] = persisted;
+    if (!validationErrors.empty()) {
+        data["validation_errors"] = validationErrors;
+    }
+
+    json response = {
+        {"status", "success"},
+        {"command", "patch"},
+        {"message", stored ? "Dataset version stored" : "Patched content matches a stored dataset"},
+        {"data", data},
+        {"timestamp", std::time(nullptr)}
+    };
+    system.sendMessage(messageId, response.dump(), MessageType::Data);
+}
+
+void DataHandler::handleGet(const std::string& messageId, const json& request, System& system) {
+    std::cout << "=== DATA: GET ===" << std::endl;
+
+    std::string datasetId = request.value("datasetId", "");
+    auto dataset = system.getDatasetStore().get(datasetId);
+    if (!dataset) {
+        sendError(messageId, "get", "Dataset not found: " + datasetId, "DATASET_NOT_FOUND", system);
+        return;
+    }
+
+    json data = dataset->summary();
+    data["content"] = dataset->toJson();
+
+    json response = {
+        {"status", "success"},
+        {"command", "get"},
+        {"data", data},
+        {"timestamp", std::time(nullptr)}
+    };
+    system.sendMessage(messageId, response.dump(), MessageType::Data);
+}
+
+void DataHandler::handleList(const std::string& messageId, System& system) {
+    std::cout << "=== DATA: LIST ===" << std::endl;
+
+    json datasets = system.getDatasetStore().list();
+
+    std::cout << "Found " << datasets.size() << " datasets" << std::endl;
+
+    json response = {
+        {"status", "success"},
+        {"command", "list"},
+        {"data", {{"datasets", datasets}}},
+        {"timestamp", std::time(nullptr)}
+    };
+    system.sendMessage(messageId, response.dump(), MessageType::Data);
+}
+
+void DataHandler::handleDelete(const std::string& messageId, const json& request, System& system) {
+    std::cout << "=== DATA: DELETE ===" << std::endl;
+
+    std::string datasetId = request.value("datasetId", "");
+    bool persisted = true;
+    if (!system.getDatasetStore().remove(datasetId, &persisted)) {
+        if (!persisted) {
+            sendError(messageId, "delete", "Deletion of " + datasetId + " could not be stored, dataset kept",
+                      "STORAGE_ERROR", system);
+        } else {
+            sendError(messageId, "delete", "Dataset not found: " + datasetId, "DATASET_NOT_FOUND", system);
+        }
+        return;
+    }
+
+    json response = {
+        {"status", "success"},
+        {"command", "delete"},
+        {"message", "Dataset " + datasetId + " deleted"},
+        {"timestamp", std::time(nullptr)}
+    };
+    system.sendMessage(messageId, response.dump(), MessageType::Data);
+}
+
+void DataHandler::handleImport(const std::string& messageId, json& request, System& system) {
+    std::cout << "=== DATA: IMPORT ===" << std::endl;
+
+    if (!request.contains("tables") || !request["tables"].is_object() || request["tables"].empty()) {
+        sendError(messageId, "import", "Missing 'tables' object", "MISSING_TABLES", system);
+        return;
+    }
+
+    std::string separator = request.value("list_separator", ";");
+    if (separator.size() != 1) {
+        sendError(messageId, "import", "'list_separator' must be a single character", "INVALID_IMPORT", system);
+        return;
+    }
+
+    // Imported tables replace sections of the base dataset, if one is given
+    std::shared_ptr<const Dataset> base;
+    if (request.contains("datasetId")) {
+        std::string datasetId = request.value("datasetId", "");
+        base = system.getDatasetStore().get(datasetId);
+        if (!base) {
+            sendError(messageId, "import", "Dataset not found: " + datasetId, "DATASET_NOT_FOUND", system);
+            return;
+        }
+    }
+
+    std::vector<CsvTableInput> tables;
+    for (auto& entry : request["tables"].items()) {
+        json& table = entry.value();
+        CsvTableInput input;
+        input.name = entry.key();
+
+        std::string path = table.is_object() ? table.value("path", "") : "";
+        if (table.is_object() && table.contains("csv") && table["csv"].is_string()) {
+            // The request is discarded afterwards, so the text is moved rather than copied
+            input.text = std::move(table["csv"].get_ref<std::string&>());
+        } else if (!path.empty()) {
+            std::string error;
+            if (!readImportFile(path, input.text, error)) {
+                sendError(messageId, "import", input.name + ": " + error, "IMPORT_FILE_ERROR", system);
+                return;
+            }
+        } else {
+            sendError(messageId, "import", input.name + ": needs 'csv' text or a 'path'", "INVALID_IMPORT", system);
+            return;
+        }
+
+        bool tsv = path.size() > 4 && path.compare(path.size() - 4, 4, ".tsv") == 0;
+        std::string delimiter = table.value("delimiter", tsv ? "\t" : ",");
+        if (delimiter.size() != 1 || delimiter[0] == '"' || delimiter[0] == '\n' || delimiter[0] == '\r') {
+            sendError(messageId, "import", input.name + ": invalid delimiter", "INVALID_IMPORT", system);
+            return;
+        }
+        input.delimiter = delimiter[0];
+        tables.push_back(std::move(input));
+    }
+
+    json stats;
+    std::vector<std::string> errors;
+    DatasetSections sections = CsvImport::build(base ? base->sections() : DatasetSections(), tables, separator[0],
+                                                stats, errors, &system.getMetrics());
+    if (!errors.empty()) {
+        json response = {
+            {"status", "error"},
+            {"command", "import"},
+            {"message", "Import rejected, " + std::to_string(errors.size()) + " error(s)"},
+            {"error_code", "INVALID_CSV"},
+            {"errors", errors},
+            {"timestamp", std::time(nullptr)}
+        };
+        system.sendMessage(messageId, response.dump(), MessageType::Data);
+        return;
+    }
+
+    json validationErrors;
+    if (!checkIntegrity(messageId, "import", sections, request, validationErrors, system)) {
+        return;
+    }
+
+    bool persisted = false;
+    auto [dataset, stored] = base ? system.getDatasetStore().addVersion(*base, std::move(sections), &persisted)
+                                  : system.getDatasetStore().addSections(std::move(sections), &persisted);
+    std::cout << "Imported " << tables.size() << " tables into " << dataset->id << std::endl;
+
+    json data = dataset->summary();
+    data["deduplicated"] = !stored;
+    data["persisted"] = persisted;
+    data["tables"] = stats;
+    if (!validationErrors.empty()) {
+        data["validation_errors"] = validationErrors;
+    }
+
+    json response = {
+        {"status", "success"},
+        {"command", "import"},
+        {"message", stored ? "Dataset imported" : "Dataset already stored"},
+        {"data", data},
+        {"timestamp", std::time(nullptr)}
+    };
+    system.sendMessage(messageId, response.dump(), MessageType::Data);
+}
+
+void DataHandler::handleValidate(const std::string& messageId, const json& request, System& system) {
+    std::cout << "=== DATA: VALIDATE ===" << std::endl;
+
+    std::string datasetId = request.value("datasetId", "");
+    auto dataset = system.getDatasetStore().get(datasetId);
+    if (!dataset) {
+        sendError(messageId, "validate", "Dataset not found: " + datasetId, "DATASET_NOT_FOUND", system);
+        return;
+    }
+
+    ValidationReport report;
+    {
+        PerfScope perf(&system.getMetrics(), "dataset.validate");
+        report = DatasetValidator::validate(dataset->sections());
+    }
+
+    json response = {
+        {"status", "success"},
+        {"command", "validate"},
+        {"data", {
+            {"dataset_id", datasetId},
+            {"valid", report.errors.empty()},
+            {"errors", report.errors},
+            {"truncated", report.truncated}
+        }},
+        {"timestamp", std::time(nullptr)}
+    };
+    system.sendMessage(messageId, response.dump(), MessageType::Data);
+}
+
+void DataHandler::handleCompile(const std::string& messageId, const json& request, System& system) {
+    std::cout << "=== DATA: COMPILE ===" << std::endl;
+
+    std::string datasetId = request.value("datasetId", "");
+    auto dataset = system.getDatasetStore().get(datasetId);
+    if (!dataset) {
+        sendError(messageId, "compile", "Dataset not found: " + datasetId, "DATASET_NOT_FOUND", system);
+        return;
+    }
+
+    std::string error;
+    std::shared_ptr<const ProblemModel> model;
+    auto started = std::chrono::steady_clock::now();
+    {
+        PerfScope perf(&system.getMetrics(), "schedule.compile");
+        model = ProblemModel::compile(dataset->sections(), error);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - started;
+    if (!model) {
+        sendError(messageId, "compile", "Dataset cannot be compiled: " + error, "INVALID_DATASET", system);
+        return;
+    }
+
+    json data = model->summary();
+    data["dataset_id"] = datasetId;
+    data["compile_us"] = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+
+    std::shared_ptr<const FeasibilityMatrices> feasibility;
+    {
+        PerfScope perf(&system.getMetrics(), "schedule.feasibility");
+        feasibility = FeasibilityMatrices::build(*model);
+    }
+    data["feasibility"] = feasibility->summary(*model);
+
+    json response = {
+        {"status", "success"},
+        {"command", "compile"},
+        {"data", data},
+        {"timestamp", std::time(nullptr)}
+    };
+    system.sendMessage(messageId, response.dump(), MessageType::Data);
+}
+
+void DataHandler::handleDemand(const std::string& messageId, const json& request, System& system) {
+    std::cout << "=== DATA: DEMAND ===" << std::endl;
+
+    std::string datasetId = request.value("datasetId", "");
+    auto dataset = system.getDatasetStore().get(datasetId);
+    if (!dataset) {
+        sendError(messageId, "demand", "Dataset not found: " + datasetId, "DATASET_NOT_FOUND", system);
+        return;
+    }
+
+    std::string error;
+    bool cached = false;
+    std::shared_ptr<const CompiledDataset> compiled;
+    {
+        PerfScope perf(&system.getMetrics(), "schedule.demand");
+        compiled = system.getModelCache().get(*dataset, error, &cached);
+    }
+    if (!compiled) {
+        sendError(messageId, "demand", "Dataset cannot be compiled: " + error, "INVALID_DATASET", system);
+        return;
+    }
+
+    json data = compiled->demand->summary(*compiled->model);
+    data["dataset_id"] = datasetId;
+    data["cached"] = cached;
+    data["lesson_requirements"] = compiled->demand->toJson(*compiled->model);
+    data["presolve"] = compiled->domains->summary(*compiled->demand);
+    data["conflict_graph"] = compiled->conflicts->summary();
+    if (request.value("include_domains", false)) {
+        data["lesson_domains"] = compiled->domains->toJson(*compiled->model);
+    }
+
+    json response = {
+        {"status", "success"},
+        {"command", "demand"},
+        {"data", data},
+        {"timestamp", std::time(nullptr)}
+    };
+    system.sendMessage(messageId, response.dump(), MessageType::Data);
+}
+
+void DataHandler::handleDiagnose(const std::string& messageId, const json& request, System& system) {
+    std::cout << "=== DATA: DIAGNOSE ===" << std::endl;
+
+    std::string datasetId = request.value("datasetId", "");
+    auto dataset = system.getDatasetStore().get(datasetId);
+    if (!dataset) {
+        sendError(messageId, "diagnose", "Dataset not found: " + datasetId, "DATASET_NOT_FOUND", system);
+        return;
+    }
+
+    std::string error;
+    bool cached = false;
+    std::shared_ptr<const CompiledDataset> compiled;
+    {
+        PerfScope perf(&system.getMetrics(), "schedule.diagnose");
+        compiled = system.getModelCache().get(*dataset, error, &cached);
+    }
+    if (!compiled) {
+        sendError(messageId, "diagnose", "Dataset cannot be compiled: " + error, "INVALID_DATASET", system);
+        return;
+    }
+
+    json data = compiled->diagnosis->toJson();
+    data["dataset_id"] = datasetId;
+    data["cached"] = cached;
+
+    json response = {
+        {"status", "success"},
+        {"command", "diagnose"},
+        {"data", data},
+        {"timestamp", std::time(nullptr)}
+    };
+    system.sendMessage(messageId, response.dump(), MessageType::Data);
+}
+
+bool DataHandler::checkIntegrity(const std::string& messageId, const std::string& command,
+                                 const DatasetSections& sections, const json& request, json& validationErrors,
+                                 System& system) {
+    ValidationReport report;
+    {
+        PerfScope perf(&system.getMetrics(), "dataset.validate");
+        report = DatasetValidator::validate(sections);
+    }
+    validationErrors = report.errors;
+    if (report.errors.empty() || request.value("allow_invalid", false)) {
+        return true;
+    }
+
+    system.getMetrics().counter("planner_dataset_validation_rejects_total", {{"command", command}},
+                                "Datasets rejected for broken references").increment();
+    json response = {
+        {"status", "error"},
+        {"command", command},
+        {"message", "Dataset has " + std::to_string(report.errors.size()) +
+                    (report.truncated ? "+" : "") + " integrity error(s), nothing stored"},
+        {"error_code", "INVALID_DATASET"},
+        {"errors", report.errors},
+        {"truncated", report.truncated},
+        {"timestamp", std::time(nullptr)}
+    };
+    system.sendMessage(messageId, response.dump(), MessageType::Data);
+    return false;
+}
+
+bool DataHandler::readImportFile(const std::string& relativePath, std::string& content, std::string& error) const {
+    namespace fs = std::filesystem;
+
+    if (importDirectory.empty()) {
+        error = "file imports are disabled";
+        return false;
+    }
+
+    // Resolve symlinks and "..", then require the file to stay inside the import directory
+    std::error_code fsError;
+    fs::path root = fs::weakly_canonical(importDirectory, fsError);
+    fs::path file = fs::weakly_canonical(root / relativePath, fsError);
+    auto mismatch = std::mismatch(root.begin(), root.end(), file.begin(), file.end());
+    if (fsError || mismatch.first != root.end()) {
+        error = "path is outside the import directory";
+        return false;
+    }
+
+    // Directories open as streams on Linux but have no size
+    if (!fs::is_regular_file(file, fsError)) {
+        error = relativePath + " is not a regular file";
+        return false;
+    }
+    std::ifstream in(file, std::ios::binary);
+    if (!in.is_open()) {
+        error = "cannot open " + relativePath;
+        return false;
+    }
+    in.seekg(0, std::ios::end);
+    std::streamoff size = in.tellg();
+    if (size < 0) {
+        error = "cannot determine the size of " + relativePath;
+        return false;
+    }
+    content.resize(static_cast<size_t>(size));
+    in.seekg(0, std::ios::beg);
+    in.read(content.data(), static_cast<std::streamsize>(content.size()));
+    if (!in) {
+        error = "cannot read " + relativePath;
+        return false;
+    }
+    return true;
+}
+
+void DataHandler::sendError(const std::string& messageId, const std::string& command, const std::string& message,
+                            const std::string& errorCode, System& system) {
+    json response = {
+        {"status", "error"},
+        {"command", command},
+        {"message", message},
+        {"error_code", errorCode},
+        {"timestamp", std::time(nullptr)}
+    };
+    system.sendMessage(messageId, response.dump(), MessageType::Data);
+}
@@ -1,35 +1,56 @@
 #include "control/handlers/DebugHandler.hpp"
 #include "core/System.hpp"
+#include "metrics/PerfCounters.hpp"
 #include "extern/nlohmann/json.hpp"
 #include <iostream>
+#include <algorithm>
 #include <ctime>
 #include <chrono>
 
 using json = nlohmann::json;
 
+namespace {
+    const std::vector<std::string> AVAILABLE_COMMANDS = {"print_payload", "uptime", "server_info", "trace", "profile", "profile_stop"};
+}
+
 void DebugHandler::handle(const std::string& messageId, const std::string& payload, System& system) {
     std::cout << "DebugHandler: Received debug message " << messageId << std::endl;
     
     try {
         // Try to parse as JSON
-        json debugData = json::parse(payload);
+        json debugData;
+        {
+            PerfScope perf(&system.getMetrics(), "handler.parse.Debug");
+            debugData = json::parse(payload);
+        }
         
         if (debugData.contains("command")) {
             std::string debugCmd = debugData["command"];
             
+            bool known = std::find(AVAILABLE_COMMANDS.begin(), AVAILABLE_COMMANDS.end(), debugCmd) != AVAILABLE_COMMANDS.end();
+            ScopedTimer timer(system.getMetrics().histogram("planner_command_latency_us",
+                {{"type", "Debug"}, {"command", known ? debugCmd : "unknown"}},
+                "Handler execution time per command"));
+            
             if (debugCmd == "print_payload") {
                 handlePrintPayload(messageId, debugData, system);
             } else if (debugCmd == "uptime") {
                 handleUptime(messageId, debugData, system);
             } else if (debugCmd == "server_info") {
                 handleServerInfo(messageId, debugData, system);
+            } else if (debugCmd == "trace") {
+                handleTrace(messageId, debugData, system);
+            } else if (debugCmd == "profile") {
+                handleProfile(messageId, debugData, system);
+            } else if (debugCmd == "profile_stop") {
+                handleProfileStop(messageId, debugData, system);
             } else {
                 // Unknown debug command
                 json response = {
                     {"status", "error"},
                     {"message", "Unknown debug command: " + debugCmd},
                     {"error_code", "UNKNOWN_DEBUG_COMMAND"},
-                    {"available_commands", {"print_payload", "uptime", "server_info"}}
+                    {"available_commands", AVAILABLE_COMMANDS}
                 };
                 system.sendMessage(messageId, response.dump(), MessageType::Debug);
             }
@@ -70,26 +91,35 @@ void DebugHandler::handlePrintPayload(const std::string& messageId, const json&
 }
 
 void DebugHandler::handleUptime(const std::string& messageId, const json& debugData, System& system) {
+    long long uptimeSeconds = system.getUptimeSeconds();
+    std::time_t now = std::time(nullptr);
+    
     std::cout << "=== DEBUG: SERVER UPTIME ===" << std::endl;
-    std::cout << "Server uptime: [Not implemented yet]" << std::endl;
-    std::cout << "Current time: " << std::time(nullptr) << std::endl;
+    std::cout << "Server uptime: " << uptimeSeconds << "s" << std::endl;
+    std::cout << "Current time: " << now << std::endl;
     std::cout << "============================" << std::endl;
     
     json response = {
         {"status", "success"},
         {"command", "uptime"},
         {"message", "Uptime info printed to server console"},
-        {"current_timestamp", std::time(nullptr)}, // to be implemented
-        {"uptime_seconds", "not_implemented"}
+        {"current_timestamp", now},
+        {"start_timestamp", now - uptimeSeconds},
+        {"uptime_seconds", uptimeSeconds}
     };
     
     system.sendMessage(messageId, response.dump(), MessageType::Debug);
 }
 
 void DebugHandler::handleServerInfo(const std::string& messageId, const json& debugData, System& system) {
+    // Served from the sampler's cached snapshot, /proc is never read on this thread
+    auto telemetry = system.getTelemetry().getLatest();
+    
     std::cout << "=== DEBUG: SERVER INFO ===" << std::endl;
     std::cout << "Server running: " << (system.isRunning() ? "YES" : "NO") << std::endl;
     std::cout << "Client connected: " << (system.isClientConnected() ? "YES" : "NO") << std::endl;
+    std::cout << "RSS: " << telemetry->residentBytes / 1024 << " kB (peak " << telemetry->peakResidentBytes / 1024 << " kB)" << std::endl;
+    std::cout << "Threads: " << telemetry->threadCount << ", open fds: " << telemetry->openFileDescriptors << std::endl;
     std::cout << "Current timestamp: " << std::time(nullptr) << std::endl;
     std::cout << "==========================" << std::endl;
     
@@ -99,6 +129,8 @@ void DebugHandler::handleServerInfo(const std::string& messageId, const json& de
         {"data", {
             {"server_running", system.isRunning()},
             {"client_connected", system.isClientConnected()},
+            {"uptime_seconds", system.getUptimeSeconds()},
+            {"telemetry", telemetry->toJson()},
             {"timestamp", std::time(nullptr)}
         }}
     };
@@ -106,6 +138,103 @@ void DebugHandler::handleServerInfo(const std::string& messageId, const json& de
     system.sendMessage(messageId, response.dump(), MessageType::Debug);
 }
 
+void DebugHandler::handleTrace(const std::string& messageId, const json& debugData, System& system) {
+    std::cout << "=== DEBUG: TRACE ===" << std::endl;
+    
+    auto& tracer = system.getTracer();
+    
+    if (debugData.contains("enabled") && debugData["enabled"].is_boolean()) {
+        tracer.setEnabled(debugData["enabled"].get<bool>());
+        std::cout << "Tracing " << (tracer.isEnabled() ? "enabled" : "disabled") << std::endl;
+    }
+    
+    // 0 keeps its documented meaning, everything still buffered
+    if (debugData.contains("window_ms") &&
+        !(debugData["window_ms"].is_number_integer() && debugData["window_ms"].get<int64_t>() >= 0)) {
+        json response = {
+            {"status", "error"},
+            {"command", "trace"},
+            {"message", "'window_ms' must be a non-negative integer"},
+            {"error_code", "INVALID_WINDOW"}
+        };
+        system.sendMessage(messageId, response.dump(), MessageType::Debug);
+        return;
+    }
+    uint64_t windowMs = debugData.value("window_ms", uint64_t(10000));
+    std::string filter = debugData.value("message_id", "");
+    
+    json trace = tracer.exportChromeTrace(windowMs, filter);
+    std::cout << "Exporting " << trace["traceEvents"].size() << " trace events" << std::endl;
+    std::cout << "====================" << std::endl;
+    
+    json response = {
+        {"status", "success"},
+        {"command", "trace"},
+        {"tracing_enabled", tracer.isEnabled()},
+        {"data", trace},
+        {"timestamp", std::time(nullptr)}
+    };
+    
+    system.sendMessage(messageId, response.dump(), MessageType::Debug);
+}
+
+void DebugHandler::handleProfile(const std::string& messageId, const json& debugData, System& system) {
+    std::cout << "=== DEBUG: PROFILE ===" << std::endl;
+    
+    int seconds = debugData.value("seconds", 10);
+    int frequencyHz = debugData.value("frequency_hz", SamplingProfiler::DEFAULT_FREQUENCY_HZ);
+    
+    // Folded stacks arrive later, as a second response with the same messageId
+    auto completionCallback = [messageId, &system](const ProfileResult& result) {
+        json response = {
+            {"status", "completed"},
+            {"command", "profile"},
+            {"data", result.toJson()},
+            {"timestamp", std::time(nullptr)}
+        };
+        system.sendMessage(messageId, response.dump(), MessageType::Debug);
+    };
+    
+    if (!system.getProfiler().start(seconds, frequencyHz, completionCallback)) {
+        json response = {
+            {"status", "error"},
+            {"command", "profile"},
+            {"message", "Profiler is already running"},
+            {"error_code", "PROFILER_BUSY"}
+        };
+        system.sendMessage(messageId, response.dump(), MessageType::Debug);
+        return;
+    }
+    
+    json response = {
+        {"status", "started"},
+        {"command", "profile"},
+        {"message", "Profiling started, folded stacks follow when it finishes"},
+        {"timestamp", std::time(nullptr)}
+    };
+    
+    system.sendMessage(messageId, response.dump(), MessageType::Debug);
+}
+
+void DebugHandler::handleProfileStop(const std::string& messageId, const json&, System& system) {
+    std::cout << "=== DEBUG: PROFILE STOP ===" << std::endl;
+    
+    bool wasRunning = system.getProfiler().isRunning();
+    system.getProfiler().stop();
+    
+    json response = {
+        {"status", wasRunning ? "success" : "error"},
+        {"command", "profile_stop"},
+        {"message", wasRunning ? "Profiler stopping, results are sent to the profile request" : "Profiler is not running"},
+        {"timestamp", std::time(nullptr)}
+    };
+    if (!wasRunning) {
+        response["error_code"] = "PROFILER_NOT_RUNNING";
+    }
+    
+    system.sendMessage(messageId, response.dump(), MessageType::Debug);
+}
+
 MessageType DebugHandler::getHandledType() const {
     return MessageType::Debug;
 }
\ No newline at end of file
@@ -1,8 +1,19 @@
 #include "core/System.hpp"
+#include "metrics/PerfCounters.hpp"
 #include <iostream>
 #include <chrono>
 
-System::System(int port) : messageProcessor(this, port), running(false) {
+System::System(int port)
+    : startTime(std::chrono::steady_clock::now()),
+      messageProcessor(this, port),
+      algorithmRunner(&metrics, &tracer),
+      datasetStore(metrics),
+      jobStore(metrics),
+      modelCache(metrics),
+      running(false),
+      telemetrySampler(metrics) {
+    metrics.gauge("planner_perf_counters_available", {}, "1 when hardware counters back the planner_phase_* series")
+        .set(PerfCounters::isAvailable() ? 1 : 0);
     std::cout << "System initialized on port " << port << std::endl;
 }
 
@@ -20,6 +31,7 @@ void System::start() {
     
     // Start message processor
     messageProcessor.start();
+    telemetrySampler.start();
     
     std::cout << "System started" << std::endl;
 }
@@ -34,6 +46,12 @@ void System::stop() {
     
     running.store(false);
     
+    if (metricsExporter) {
+        metricsExporter->stop();
+    }
+    telemetrySampler.stop();
+    profiler.stop();
+    
     try {
         std::cout << "Stopping MessageProcessor" << std::endl;
         messageProcessor.stop();
@@ -102,9 +120,31 @@ void System::printStats() const {
     std::cout << "Client connected: " << (isClientConnected() ? "Yes" : "No") << std::endl;
     std::cout << "Message processor running: " << (messageProcessor.isRunning() ? "Yes" : "No") << std::endl;
     std::cout << "Handlers count: " << handlers.size() << std::endl;
+    std::cout << "Uptime: " << getUptimeSeconds() << "s" << std::endl;
+    
+    json snapshot = metrics.toJson();
+    for (const char* name : {"planner_frames_received_total", "planner_frames_sent_total",
+                             "planner_bytes_received_total", "planner_bytes_sent_total",
+                             "planner_messages_completed_total"}) {
+        std::cout << name << ": " << snapshot.value(name, json(0)).dump() << std::endl;
+    }
     std::cout << "=========================" << std::endl;
 }
 
+long long System::getUptimeSeconds() const {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+bool System::startMetricsExporter(int port) {
+    if (metricsExporter && metricsExporter->isRunning()) {
+        std::cout << "Metrics exporter is already running on port " << metricsExporter->getPort() << std::endl;
+        return true;
+    }
+    
+    metricsExporter = std::make_unique<MetricsExporter>(metrics, port);
+    return metricsExporter->start();
+}
+
 void System::handleCompleteMessage(const std::string& messageId, const std::string& payload, MessageType type) {
     dispatcher.dispatch(messageId, payload, type, *this);
 }
@@ -115,4 +155,41 @@ AlgorithmScanner& System::getAlgorithmScanner() {
 
 AlgorithmRunner& System::getAlgorithmRunner() {
     return algorithmRunner;
+}
+
+DatasetStore& System::getDatasetStore() {
+    return datasetStore;
+}
+
+JobStore& System::getJobStore() {
+    return jobStore;
+}
+
+ModelCache& System::getModelCache() {
+    return modelCache;
+}
+
+bool System::openStorage(const std::string& directory) {
+    // Both stores only replay their logs here; data is read when first used
+    auto start = std::chrono::steady_clock::now();
+    bool opened = datasetStore.open(directory) && jobStore.open(directory);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "Storage " << (opened ? "opened" : "unavailable") << " in " << elapsed.count() << " ms" << std::endl;
+    return opened;
+}
+
+MetricsRegistry& System::getMetrics() {
+    return metrics;
+}
+
+Tracer& System::getTracer() {
+    return tracer;
+}
+
+TelemetrySampler& System::getTelemetry() {
+    return telemetrySampler;
+}
+
+SamplingProfiler& System::getProfiler() {
+    return profiler;
 }
\ No newline at end of file
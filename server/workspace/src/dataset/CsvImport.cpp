@@ -0,0 +1,347 @@
+#include "dataset/CsvImport.hpp"
+#include "dataset/CsvReader.hpp"
+#include "dataset/DatasetSchema.hpp"
+#include "metrics/PerfCounters.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+    // Stop collecting after this many errors per table, the rest are usually the same mistake
+    constexpr size_t MAX_ERRORS_PER_TABLE = 50;
+
+    struct TableResult {
+        std::shared_ptr<DatasetSection> section;
+        std::unordered_map<std::string, std::vector<int64_t>> availability;  // Availability table only
+        std::vector<std::string> errors;
+        size_t rows = 0;
+        double milliseconds = 0.0;
+    };
+
+    bool parseInteger(std::string_view text, int64_t& value) {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    bool parseNumber(std::string_view text, json& value) {
+        int64_t integer = 0;
+        if (parseInteger(text, integer)) {
+            value = integer;
+            return true;
+        }
+        double number = 0.0;
+        auto result = std::from_chars(text.data(), text.data() + text.size(), number);
+        if (result.ec != std::errc() || result.ptr != text.data() + text.size() || !std::isfinite(number)) {
+            return false;
+        }
+        value = number;
+        Dataset::normalize(value);
+        return true;
+    }
+
+    template <typename Callback>
+    void forEachListPart(std::string_view cell, char separator, Callback callback) {
+        size_t start = 0;
+        while (start <= cell.size()) {
+            size_t end = cell.find(separator, start);
+            if (end == std::string_view::npos) {
+                end = cell.size();
+            }
+            if (end > start) {
+                callback(cell.substr(start, end - start));
+            }
+            start = end + 1;
+        }
+    }
+
+    class TableParser {
+    public:
+        TableParser(const CsvTableInput& input, char listSeparator, TableResult& result)
+            : input(input), listSeparator(listSeparator), result(result),
+              schema(DatasetSchema::find(input.name)) {
+        }
+
+        void run() {
+            auto start = std::chrono::steady_clock::now();
+            CsvReader reader(input.text, input.delimiter);
+
+            std::vector<std::string_view> fields;
+            if (!reader.next(fields)) {
+                addError(reader.error().empty() ? "table is empty" : reader.error());
+                return;
+            }
+            for (auto name : fields) {
+                header.emplace_back(name);
+                specs.push_back(schema ? schema->findField(header.back()) : nullptr);
+            }
+
+            bool availabilityTable = input.name == CsvImport::AVAILABILITY_TABLE;
+            if (availabilityTable) {
+                teacherColumn = columnOf("teacherId");
+                blockColumn = columnOf("timeBlock");
+                if (teacherColumn == header.size() || blockColumn == header.size()) {
+                    addError("needs the columns teacherId and timeBlock");
+                    return;
+                }
+            } else {
+                result.section = std::make_shared<DatasetSection>();
+            }
+
+            while (reader.next(fields) && result.errors.size() < MAX_ERRORS_PER_TABLE) {
+                // Blank lines carry no record
+                if (fields.size() == 1 && fields[0].empty()) {
+                    continue;
+                }
+                if (fields.size() != header.size()) {
+                    addError(reader.line(), "expected " + std::to_string(header.size()) + " fields, found " +
+                             std::to_string(fields.size()));
+                    continue;
+                }
+
+                if (availabilityTable) {
+                    addAvailability(fields, reader.line());
+                } else {
+                    addEntity(fields, reader.line());
+                }
+                ++result.rows;
+            }
+            if (!reader.error().empty()) {
+                addError(reader.error());
+            }
+
+            result.milliseconds = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+        }
+
+    private:
+        const CsvTableInput& input;
+        char listSeparator;
+        TableResult& result;
+        const EntitySchema* schema;
+        std::vector<std::string> header;
+        std::vector<const FieldSpec*> specs;
+        size_t teacherColumn = 0;
+        size_t blockColumn = 0;
+
+        size_t columnOf(const std::string& name) const {
+            return static_cast<size_t>(std::find(header.begin(), header.end(), name) - header.begin());
+        }
+
+        void addError(const std::string& message) {
+            result.errors.push_back(input.name + ": " + message);
+        }
+
+        void addError(size_t line, const std::string& message) {
+            result.errors.push_back(input.name + " line " + std::to_string(line) + ": " + message);
+        }
+
+        void addAvailability(const std::vector<std::string_view>& fields, size_t line) {
+            int64_t block = 0;
+            if (!parseInteger(fields[blockColumn], block) || block < 0) {
+                addError(line, "timeBlock expects a non-negative integer, got '" + std::string(fields[blockColumn]) + "'");
+                return;
+            }
+            result.availability[std::string(fields[teacherColumn])].push_back(block);
+        }
+
+        void addEntity(const std::vector<std::string_view>& fields, size_t line) {
+            json item = json::object();
+            for (size_t c = 0; c < fields.size(); ++c) {
+                json value;
+                if (convert(fields[c], specs[c], value, line, header[c])) {
+                    item[header[c]] = std::move(value);
+                }
+            }
+            result.section->items.push_back(std::make_shared<const json>(std::move(item)));
+        }
+
+        /**
+         * Converts one cell; false if the field is left out (empty or invalid)
+         */
+        bool convert(std::string_view cell, const FieldSpec* spec, json& value, size_t line, const std::string& name) {
+            FieldType type = spec ? spec->type : FieldType::Json;
+
+            switch (type) {
+                case FieldType::String:
+                    value = std::string(cell);
+                    return true;
+
+                case FieldType::StringList:
+                    value = json::array();
+                    forEachListPart(cell, listSeparator, [&](std::string_view part) {
+                        value.push_back(std::string(part));
+                    });
+                    return true;
+
+                case FieldType::IntegerSet: {
+                    std::vector<int64_t> ids;
+                    bool valid = true;
+                    forEachListPart(cell, listSeparator, [&](std::string_view part) {
+                        int64_t id = 0;
+                        if (!parseInteger(part, id) || id < 0) {
+                            valid = false;
+                        }
+                        ids.push_back(id);
+                    });
+                    if (!valid) {
+                        addError(line, name + " expects non-negative integers, got '" + std::string(cell) + "'");
+                        return false;
+                    }
+                    std::sort(ids.begin(), ids.end());
+                    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+                    value = ids;
+                    return true;
+                }
+
+                default:
+                    break;
+            }
+
+            if (cell.empty()) {
+                return false;
+            }
+
+            if (type == FieldType::Integer) {
+                int64_t integer = 0;
+                if (!parseInteger(cell, integer)) {
+                    addError(line, name + " expects an integer, got '" + std::string(cell) + "'");
+                    return false;
+                }
+                value = integer;
+                return true;
+            }
+            if (type == FieldType::Number) {
+                if (!parseNumber(cell, value)) {
+                    addError(line, name + " expects a number, got '" + std::string(cell) + "'");
+                    return false;
+                }
+                return true;
+            }
+
+            // Constraint data is JSON; unknown fields are numbers when they look like one
+            if (spec) {
+                try {
+                    value = json::parse(cell);
+                    Dataset::normalize(value);
+                } catch (const json::parse_error&) {
+                    addError(line, name + " expects JSON, got '" + std::string(cell) + "'");
+                    return false;
+                }
+                return true;
+            }
+            if (!parseNumber(cell, value)) {
+                value = std::string(cell);
+            }
+            return true;
+        }
+    };
+
+    void applyAvailability(DatasetSections& sections, TableResult& availability, std::vector<std::string>& errors) {
+        auto teachersIt = sections.find("teachers");
+        if (teachersIt == sections.end() || !teachersIt->second->isArray) {
+            if (!availability.availability.empty()) {
+                errors.push_back(std::string(CsvImport::AVAILABILITY_TABLE) + ": dataset has no teachers");
+            }
+            return;
+        }
+
+        // Copy-on-write like a patch: only edited teachers get new items
+        auto teachers = std::make_shared<DatasetSection>(*teachersIt->second);
+        for (auto& item : teachers->items) {
+            auto id = item->find("id");
+            if (id == item->end() || !id->is_string()) {
+                continue;
+            }
+            auto blocks = availability.availability.find(id->get<std::string>());
+            if (blocks == availability.availability.end()) {
+                continue;
+            }
+
+            std::vector<int64_t>& ids = blocks->second;
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+            json updated = *item;
+            updated["availableTimeBlocks"] = ids;
+            item = std::make_shared<const json>(std::move(updated));
+            availability.availability.erase(blocks);
+        }
+
+        for (const auto& [teacherId, blocks] : availability.availability) {
+            if (errors.size() >= MAX_ERRORS_PER_TABLE) {
+                break;
+            }
+            errors.push_back(std::string(CsvImport::AVAILABILITY_TABLE) + ": unknown teacher '" + teacherId + "'");
+        }
+        teachersIt->second = std::move(teachers);
+    }
+}
+
+DatasetSections CsvImport::build(const DatasetSections& base, const std::vector<CsvTableInput>& tables,
+                                 char listSeparator, json& stats, std::vector<std::string>& errors,
+                                 MetricsRegistry* metrics) {
+    std::vector<TableResult> results(tables.size());
+
+    {
+        PerfScope perf(metrics, "import.csv");
+        // Clients choose the number of tables, so workers take tables in turn from a bounded pool
+        std::atomic<size_t> nextTable{0};
+        auto work = [&]() {
+            for (size_t i = nextTable++; i < tables.size(); i = nextTable++) {
+                TableParser(tables[i], listSeparator, results[i]).run();
+            }
+        };
+        size_t threads = std::min(tables.size(), std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAX_THREADS));
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        try {
+            for (size_t t = 1; t < threads; ++t) {
+                workers.emplace_back(work);
+            }
+        } catch (const std::system_error& e) {
+            // Fewer workers only make the import slower; the calling thread takes the rest
+            std::cerr << "CsvImport: started " << workers.size() + 1 << " of " << threads << " workers: " << e.what()
+                      << std::endl;
+        }
+        work();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    stats = json::object();
+    TableResult* availability = nullptr;
+    DatasetSections sections = base;
+    for (size_t i = 0; i < tables.size(); ++i) {
+        errors.insert(errors.end(), results[i].errors.begin(), results[i].errors.end());
+        stats[tables[i].name] = {{"rows", results[i].rows}, {"parse_ms", results[i].milliseconds}};
+
+        if (results[i].section) {
+            sections[tables[i].name] = std::move(results[i].section);
+        } else if (tables[i].name == AVAILABILITY_TABLE) {
+            availability = &results[i];
+        }
+
+        if (metrics) {
+            // Table names come from clients; only known ones get their own series
+            bool known = DatasetSchema::find(tables[i].name) || tables[i].name == AVAILABILITY_TABLE;
+            metrics->counter("planner_import_rows_total", {{"table", known ? tables[i].name : "other"}},
+                             "CSV rows imported")
+                .increment(results[i].rows);
+        }
+    }
+
+    if (availability && errors.empty()) {
+        applyAvailability(sections, *availability, errors);
+    }
+    if (!errors.empty()) {
+        return {};
+    }
+    return sections;
+}
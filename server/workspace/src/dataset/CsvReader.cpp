@@ -0,0 +1,152 @@
+#include "dataset/CsvReader.hpp"
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+CsvReader::CsvReader(std::string_view text, char delimiter)
+    : text(text), delimiter(delimiter), position(0), currentLine(1), recordLine(1), unescapedUsed(0) {
+    // Skip a UTF-8 byte order mark, spreadsheet exports often start with one
+    if (this->text.substr(0, 3) == "\xEF\xBB\xBF") {
+        position = 3;
+    }
+}
+
+size_t CsvReader::findSpecial(size_t from) const {
+    const char* data = text.data();
+    size_t size = text.size();
+    size_t i = from;
+
+#if defined(__AVX2__)
+    const __m256i delimiters = _mm256_set1_epi8(delimiter);
+    const __m256i quotes = _mm256_set1_epi8('"');
+    const __m256i newlines = _mm256_set1_epi8('\n');
+    const __m256i returns = _mm256_set1_epi8('\r');
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i hits = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, delimiters), _mm256_cmpeq_epi8(chunk, quotes)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, newlines), _mm256_cmpeq_epi8(chunk, returns)));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128i delimiters = _mm_set1_epi8(delimiter);
+    const __m128i quotes = _mm_set1_epi8('"');
+    const __m128i newlines = _mm_set1_epi8('\n');
+    const __m128i returns = _mm_set1_epi8('\r');
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, delimiters), _mm_cmpeq_epi8(chunk, quotes)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, newlines), _mm_cmpeq_epi8(chunk, returns)));
+        int mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+        }
+    }
+#endif
+
+    for (; i < size; ++i) {
+        char c = data[i];
+        if (c == delimiter || c == '"' || c == '\n' || c == '\r') {
+            return i;
+        }
+    }
+    return size;
+}
+
+bool CsvReader::next(std::vector<std::string_view>& fields) {
+    fields.clear();
+    unescapedUsed = 0;
+
+    if (position >= text.size() || !errorMessage.empty()) {
+        return false;
+    }
+    recordLine = currentLine;
+
+    while (true) {
+        std::string_view field;
+
+        if (text[position] == '"') {
+            if (!readQuoted(field)) {
+                return false;
+            }
+        } else {
+            // A quote inside an unquoted field is taken literally
+            size_t start = position;
+            size_t end = findSpecial(position);
+            while (end < text.size() && text[end] == '"') {
+                end = findSpecial(end + 1);
+            }
+            field = text.substr(start, end - start);
+            position = end;
+        }
+        fields.push_back(field);
+
+        if (position >= text.size()) {
+            return true;
+        }
+        char c = text[position];
+        if (c == delimiter) {
+            ++position;
+            if (position >= text.size()) {
+                fields.emplace_back();  // Trailing delimiter: one more empty field
+                return true;
+            }
+            continue;
+        }
+        if (c == '\r') {
+            ++position;
+            if (position < text.size() && text[position] == '\n') {
+                ++position;
+            }
+            ++currentLine;
+            return true;
+        }
+        if (c == '\n') {
+            ++position;
+            ++currentLine;
+            return true;
+        }
+
+        errorMessage = "line " + std::to_string(currentLine) + ": unexpected character after closing quote";
+        return false;
+    }
+}
+
+bool CsvReader::readQuoted(std::string_view& field) {
+    if (unescapedUsed == unescaped.size()) {
+        unescaped.emplace_back();
+    }
+    std::string& value = unescaped[unescapedUsed++];
+    value.clear();
+
+    size_t startLine = currentLine;
+    ++position;  // Opening quote
+    while (position < text.size()) {
+        size_t quote = text.find('"', position);
+        if (quote == std::string_view::npos) {
+            break;
+        }
+        for (size_t i = position; i < quote; ++i) {
+            currentLine += text[i] == '\n' ? 1 : 0;
+        }
+        value.append(text.data() + position, quote - position);
+
+        if (quote + 1 < text.size() && text[quote + 1] == '"') {
+            value.push_back('"');
+            position = quote + 2;
+            continue;
+        }
+        position = quote + 1;
+        field = value;
+        return true;
+    }
+
+    errorMessage = "line " + std::to_string(startLine) + ": unterminated quoted field";
+    return false;
+}
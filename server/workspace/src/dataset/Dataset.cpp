@@ -0,0 +1,188 @@
+#include "dataset/Dataset.hpp"
+#include "dataset/DatasetSnapshot.hpp"
+#include "dataset/Sha256.hpp"
+#include <cmath>
+#include <streambuf>
+
+namespace {
+    const std::vector<std::string> ENTITY_SECTIONS = {"timeBlocks", "subjects", "groups", "rooms", "teachers", "constraints"};
+
+    // Feeds everything written to an ostream into a digest
+    class HashingBuffer : public std::streambuf {
+    public:
+        explicit HashingBuffer(Sha256& sha) : sha(sha), written(0) {}
+
+        size_t getWritten() const { return written; }
+
+    protected:
+        int_type overflow(int_type c) override {
+            if (c != traits_type::eof()) {
+                char byte = static_cast<char>(c);
+                sha.update(&byte, 1);
+                ++written;
+            }
+            return c;
+        }
+
+        std::streamsize xsputn(const char* data, std::streamsize count) override {
+            sha.update(data, static_cast<size_t>(count));
+            written += static_cast<size_t>(count);
+            return count;
+        }
+
+    private:
+        Sha256& sha;
+        size_t written;
+    };
+}
+
+json Dataset::summary() const {
+    json counts = json::object();
+    for (const auto& name : ENTITY_SECTIONS) {
+        const DatasetSection* section = findSection(name);
+        counts[name] = (section && section->isArray) ? section->items.size() : 0;
+    }
+
+    json result = {
+        {"dataset_id", id},
+        {"content_hash", contentHash},
+        {"version", version},
+        {"size_bytes", sizeBytes},
+        {"created_at", createdAt},
+        {"counts", counts}
+    };
+    if (!parentId.empty()) {
+        result["parent_id"] = parentId;
+    }
+    return result;
+}
+
+void Dataset::setSections(DatasetSections content) {
+    this->content = std::move(content);
+    snapshot.reset();
+}
+
+void Dataset::setSnapshot(std::shared_ptr<const SnapshotSections> content) {
+    snapshot = std::move(content);
+    this->content.clear();
+}
+
+const DatasetSections& Dataset::sections() const {
+    return snapshot ? snapshot->all() : content;
+}
+
+json Dataset::toJson() const {
+    json content = json::object();
+    for (const auto& [name, section] : sections()) {
+        if (!section->isArray) {
+            content[name] = *section->items.front();
+            continue;
+        }
+
+        json items = json::array();
+        for (const auto& item : section->items) {
+            items.push_back(*item);
+        }
+        content[name] = std::move(items);
+    }
+    return content;
+}
+
+void Dataset::writeJson(std::ostream& out) const {
+    writeSections(sections(), out);
+}
+
+const DatasetSection* Dataset::findSection(const std::string& name) const {
+    if (snapshot) {
+        // The snapshot keeps the decoded section for as long as this dataset lives
+        return snapshot->find(name).get();
+    }
+    auto it = content.find(name);
+    return it != content.end() ? it->second.get() : nullptr;
+}
+
+DatasetSections Dataset::split(json content) {
+    normalize(content);
+
+    DatasetSections result;
+    for (auto& entry : content.items()) {
+        json& value = entry.value();
+        auto section = std::make_shared<DatasetSection>();
+        section->isArray = value.is_array();
+
+        if (section->isArray) {
+            section->items.reserve(value.size());
+            for (auto& item : value) {
+                section->items.push_back(std::make_shared<const json>(std::move(item)));
+            }
+        } else {
+            section->items.push_back(std::make_shared<const json>(std::move(value)));
+        }
+
+        result.emplace(entry.key(), std::move(section));
+    }
+    return result;
+}
+
+void Dataset::normalize(json& value) {
+    switch (value.type()) {
+        case json::value_t::object:
+        case json::value_t::array:
+            for (auto& child : value) {
+                normalize(child);
+            }
+            break;
+        case json::value_t::number_float: {
+            double number = value.get<double>();
+            // 2^63 bound keeps the conversion defined
+            if (std::isfinite(number) && std::trunc(number) == number && std::fabs(number) < 9.2e18) {
+                value = static_cast<int64_t>(number);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+std::string Dataset::computeHash(const DatasetSections& sections, size_t& sizeBytes) {
+    Sha256 sha;
+    HashingBuffer buffer(sha);
+    std::ostream out(&buffer);
+
+    writeSections(sections, out);
+    out.flush();
+
+    sizeBytes = buffer.getWritten();
+    return sha.hexDigest();
+}
+
+void Dataset::writeSections(const DatasetSections& sections, std::ostream& out) {
+    // Byte-for-byte what json::dump() produces for the merged object
+    out << '{';
+    bool firstSection = true;
+    for (const auto& [name, section] : sections) {
+        if (!firstSection) {
+            out << ',';
+        }
+        firstSection = false;
+        out << json(name).dump() << ':';
+
+        if (!section->isArray) {
+            out << section->items.front()->dump();
+            continue;
+        }
+
+        out << '[';
+        bool firstItem = true;
+        for (const auto& item : section->items) {
+            if (!firstItem) {
+                out << ',';
+            }
+            firstItem = false;
+            out << item->dump();
+        }
+        out << ']';
+    }
+    out << '}';
+}
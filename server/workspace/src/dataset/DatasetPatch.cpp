@@ -0,0 +1,154 @@
+#include "dataset/DatasetPatch.hpp"
+#include <optional>
+#include <unordered_map>
+
+namespace {
+    // Copy-on-write state of one section while a patch is applied
+    struct SectionEdit {
+        std::shared_ptr<DatasetSection> section;
+        std::unordered_map<std::string, size_t> positions;  // Entity id -> index, built on first lookup
+        bool indexed = false;
+
+        void buildIndex() {
+            positions.clear();
+            for (size_t i = 0; i < section->items.size(); ++i) {
+                const json& item = *section->items[i];
+                auto id = item.find("id");
+                if (id != item.end() && id->is_string()) {
+                    positions.emplace(id->get<std::string>(), i);
+                }
+            }
+            indexed = true;
+        }
+
+        std::optional<size_t> findId(const std::string& id) {
+            if (!indexed) {
+                buildIndex();
+            }
+            auto it = positions.find(id);
+            return it != positions.end() ? std::optional<size_t>(it->second) : std::nullopt;
+        }
+    };
+
+    std::string describe(size_t index) {
+        return "ops[" + std::to_string(index) + "]: ";
+    }
+}
+
+DatasetSections DatasetPatch::apply(const DatasetSections& base, const json& operations, std::vector<std::string>& errors) {
+    if (!operations.is_array()) {
+        errors.push_back("'ops' must be an array");
+        return {};
+    }
+
+    std::unordered_map<std::string, SectionEdit> edits;
+
+    for (size_t i = 0; i < operations.size(); ++i) {
+        const json& operation = operations[i];
+        if (!operation.is_object()) {
+            errors.push_back(describe(i) + "operation must be an object");
+            continue;
+        }
+
+        std::string op = operation.value("op", "");
+        std::string sectionName = operation.value("section", "");
+        if (op != "add" && op != "update" && op != "remove") {
+            errors.push_back(describe(i) + "unknown op '" + op + "', expected add, update or remove");
+            continue;
+        }
+        if (sectionName.empty()) {
+            errors.push_back(describe(i) + "missing 'section'");
+            continue;
+        }
+
+        // First touch of a section copies its pointer array, never the entities
+        auto editIt = edits.find(sectionName);
+        if (editIt == edits.end()) {
+            auto baseIt = base.find(sectionName);
+            if (baseIt != base.end() && !baseIt->second->isArray) {
+                errors.push_back(describe(i) + "section '" + sectionName + "' is not an array");
+                continue;
+            }
+            SectionEdit edit;
+            edit.section = baseIt != base.end() ? std::make_shared<DatasetSection>(*baseIt->second)
+                                                : std::make_shared<DatasetSection>();
+            editIt = edits.emplace(sectionName, std::move(edit)).first;
+        }
+        SectionEdit& edit = editIt->second;
+        auto& items = edit.section->items;
+
+        if (op == "add") {
+            if (!operation.contains("value") || !operation["value"].is_object()) {
+                errors.push_back(describe(i) + "'add' needs an object 'value'");
+                continue;
+            }
+            json value = operation["value"];
+            Dataset::normalize(value);
+
+            auto id = value.find("id");
+            if (id != value.end() && id->is_string()) {
+                if (edit.findId(id->get<std::string>())) {
+                    errors.push_back(describe(i) + sectionName + " already has an entity with id '" + id->get<std::string>() + "'");
+                    continue;
+                }
+                edit.positions.emplace(id->get<std::string>(), items.size());
+            }
+            items.push_back(std::make_shared<const json>(std::move(value)));
+            continue;
+        }
+
+        // update and remove address an existing entity
+        std::optional<size_t> position;
+        if (operation.contains("id") && operation["id"].is_string()) {
+            position = edit.findId(operation["id"].get<std::string>());
+            if (!position) {
+                errors.push_back(describe(i) + sectionName + " has no entity with id '" + operation["id"].get<std::string>() + "'");
+                continue;
+            }
+        } else if (operation.contains("index") && operation["index"].is_number_unsigned()) {
+            size_t index = operation["index"].get<size_t>();
+            if (index >= items.size()) {
+                errors.push_back(describe(i) + "index " + std::to_string(index) + " is out of range for " + sectionName);
+                continue;
+            }
+            position = index;
+        } else {
+            errors.push_back(describe(i) + "'" + op + "' needs 'id' or 'index'");
+            continue;
+        }
+
+        if (op == "update") {
+            if (!operation.contains("value") || !operation["value"].is_object()) {
+                errors.push_back(describe(i) + "'update' needs an object 'value'");
+                continue;
+            }
+            json updated = *items[*position];
+            updated.merge_patch(operation["value"]);
+            Dataset::normalize(updated);
+
+            json newId = updated.value("id", json());
+            if (newId != items[*position]->value("id", json())) {
+                if (newId.is_string() && edit.findId(newId.get<std::string>())) {
+                    errors.push_back(describe(i) + sectionName + " already has an entity with id '" + newId.get<std::string>() + "'");
+                    continue;
+                }
+                // Renaming changes the index; rebuild it lazily
+                edit.indexed = false;
+            }
+            items[*position] = std::make_shared<const json>(std::move(updated));
+        } else {
+            items.erase(items.begin() + static_cast<std::ptrdiff_t>(*position));
+            edit.indexed = false;
+        }
+    }
+
+    if (!errors.empty()) {
+        return {};
+    }
+
+    DatasetSections result = base;
+    for (auto& [name, edit] : edits) {
+        result[name] = std::move(edit.section);
+    }
+    return result;
+}
@@ -0,0 +1,37 @@
+#include "dataset/DatasetSchema.hpp"
+
+const FieldSpec* EntitySchema::findField(const std::string& name) const {
+    for (const auto& field : fields) {
+        if (name == field.name) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+const std::vector<EntitySchema>& DatasetSchema::entities() {
+    static const std::vector<EntitySchema> schemas = {
+        {"timeBlocks", {{"id", FieldType::String}, {"day", FieldType::String}, {"start", FieldType::Integer},
+                        {"end", FieldType::Integer}, {"duration", FieldType::Integer}}},
+        {"subjects", {{"id", FieldType::String}, {"name", FieldType::String}, {"hoursPerWeek", FieldType::Number},
+                      {"difficultyLevel", FieldType::Integer}}},
+        {"groups", {{"id", FieldType::String}, {"name", FieldType::String}, {"size", FieldType::Integer},
+                    {"parentGroupId", FieldType::String}}},
+        {"rooms", {{"id", FieldType::String}, {"name", FieldType::String}, {"capacity", FieldType::Integer},
+                   {"features", FieldType::StringList}}},
+        {"teachers", {{"id", FieldType::String}, {"name", FieldType::String}, {"subjects", FieldType::StringList},
+                      {"availableTimeBlocks", FieldType::IntegerSet}}},
+        {"constraints", {{"importance", FieldType::String}, {"description", FieldType::String},
+                         {"type", FieldType::String}, {"data", FieldType::Json}}}
+    };
+    return schemas;
+}
+
+const EntitySchema* DatasetSchema::find(const std::string& section) {
+    for (const auto& schema : entities()) {
+        if (section == schema.section) {
+            return &schema;
+        }
+    }
+    return nullptr;
+}
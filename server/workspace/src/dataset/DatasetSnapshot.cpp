@@ -0,0 +1,857 @@
+#include "dataset/DatasetSnapshot.hpp"
+#include "dataset/DatasetSchema.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    constexpr char MAGIC[8] = {'P', 'L', 'N', 'S', 'N', 'A', 'P', '\0'};
+    constexpr const char* RESIDUAL_COLUMN = "$residual";
+
+    // Largest time block id kept as a bitmap; anything above stays in the residual blob
+    constexpr int64_t MAX_BITMAP_VALUE = 1 << 20;
+    // Doubles represent every integer up to 2^53 exactly
+    constexpr int64_t MAX_EXACT_INTEGER = int64_t(1) << 53;
+
+    SnapshotColumnType columnType(FieldType type) {
+        switch (type) {
+            case FieldType::String: return SnapshotColumnType::String;
+            case FieldType::Integer: return SnapshotColumnType::Integer;
+            case FieldType::Number: return SnapshotColumnType::Number;
+            case FieldType::StringList: return SnapshotColumnType::StringList;
+            case FieldType::IntegerSet: return SnapshotColumnType::Bitmap;
+            case FieldType::Json: return SnapshotColumnType::Blob;
+        }
+        return SnapshotColumnType::Blob;
+    }
+
+    bool hasIndex(SnapshotColumnType type) {
+        return type == SnapshotColumnType::StringList || type == SnapshotColumnType::Bitmap ||
+               type == SnapshotColumnType::Blob;
+    }
+
+    size_t elementSize(SnapshotColumnType type) {
+        switch (type) {
+            case SnapshotColumnType::String: return sizeof(uint32_t);
+            case SnapshotColumnType::Integer: return sizeof(int64_t);
+            case SnapshotColumnType::Number: return sizeof(double);
+            case SnapshotColumnType::StringList: return sizeof(uint32_t);
+            case SnapshotColumnType::Bitmap: return sizeof(uint64_t);
+            case SnapshotColumnType::Blob: return 1;
+        }
+        return 0;
+    }
+
+    // Same rule as Dataset::normalize, so decoded numbers hash like uploaded ones
+    json decodeNumber(double value) {
+        if (std::isfinite(value) && std::trunc(value) == value && std::fabs(value) < 9.2e18) {
+            return static_cast<int64_t>(value);
+        }
+        return value;
+    }
+
+    class ByteWriter {
+    public:
+        std::string bytes;
+
+        uint64_t reserve(size_t size) {
+            align();
+            uint64_t offset = bytes.size();
+            bytes.resize(offset + size, '\0');
+            return offset;
+        }
+
+        uint64_t append(const void* data, size_t size) {
+            uint64_t offset = reserve(size);
+            if (size > 0) {
+                std::memcpy(&bytes[offset], data, size);
+            }
+            return offset;
+        }
+
+        template <typename T>
+        uint64_t appendArray(const std::vector<T>& values) {
+            return append(values.data(), values.size() * sizeof(T));
+        }
+
+        template <typename T>
+        void put(uint64_t offset, const T& value) {
+            std::memcpy(&bytes[offset], &value, sizeof(T));
+        }
+
+    private:
+        void align() {
+            bytes.resize((bytes.size() + 7) & ~size_t(7), '\0');
+        }
+    };
+
+    class StringInterner {
+    public:
+        uint32_t intern(const std::string& value) {
+            auto it = ids.find(value);
+            if (it != ids.end()) {
+                return it->second;
+            }
+            uint32_t id = static_cast<uint32_t>(strings.size());
+            strings.push_back(value);
+            ids.emplace(value, id);
+            return id;
+        }
+
+        const std::vector<std::string>& all() const { return strings; }
+
+    private:
+        std::unordered_map<std::string, uint32_t> ids;
+        std::vector<std::string> strings;
+    };
+
+    class ColumnBuilder {
+    public:
+        ColumnBuilder(const char* name, SnapshotColumnType type, size_t rows)
+            : name(name), type(type), presence((rows + 63) / 64, 0), index{0} {
+        }
+
+        const char* name;
+        SnapshotColumnType type;
+
+        /**
+         * Appends the row's value; false if it does not fit the column type, in
+         * which case the row gets an empty slot and the caller keeps the value
+         */
+        bool add(size_t row, const json* value, StringInterner& strings) {
+            bool stored = value != nullptr && encode(*value, strings);
+            if (stored) {
+                presence[row / 64] |= uint64_t(1) << (row % 64);
+            } else {
+                appendEmpty();
+            }
+            if (hasIndex(type)) {
+                index.push_back(dataCount());
+            }
+            return stored;
+        }
+
+        void write(ByteWriter& writer, SnapshotColumnHeader& header, uint32_t nameId) const {
+            header.nameId = nameId;
+            header.type = static_cast<uint32_t>(type);
+            header.presenceOffset = writer.appendArray(presence);
+            header.indexOffset = hasIndex(type) ? writer.appendArray(index) : 0;
+            header.dataCount = dataCount();
+
+            switch (type) {
+                case SnapshotColumnType::String:
+                case SnapshotColumnType::StringList: header.dataOffset = writer.appendArray(ids); break;
+                case SnapshotColumnType::Integer: header.dataOffset = writer.appendArray(integers); break;
+                case SnapshotColumnType::Number: header.dataOffset = writer.appendArray(numbers); break;
+                case SnapshotColumnType::Bitmap: header.dataOffset = writer.appendArray(words); break;
+                case SnapshotColumnType::Blob: header.dataOffset = writer.append(blobBytes.data(), blobBytes.size()); break;
+            }
+        }
+
+    private:
+        std::vector<uint64_t> presence;
+        std::vector<uint64_t> index;
+        std::vector<uint32_t> ids;
+        std::vector<int64_t> integers;
+        std::vector<double> numbers;
+        std::vector<uint64_t> words;
+        std::string blobBytes;
+
+        uint64_t dataCount() const {
+            switch (type) {
+                case SnapshotColumnType::String:
+                case SnapshotColumnType::StringList: return ids.size();
+                case SnapshotColumnType::Integer: return integers.size();
+                case SnapshotColumnType::Number: return numbers.size();
+                case SnapshotColumnType::Bitmap: return words.size();
+                case SnapshotColumnType::Blob: return blobBytes.size();
+            }
+            return 0;
+        }
+
+        void appendEmpty() {
+            // Variable-width columns simply repeat the previous index entry
+            switch (type) {
+                case SnapshotColumnType::String: ids.push_back(0); break;
+                case SnapshotColumnType::Integer: integers.push_back(0); break;
+                case SnapshotColumnType::Number: numbers.push_back(0.0); break;
+                default: break;
+            }
+        }
+
+        bool encode(const json& value, StringInterner& strings) {
+            switch (type) {
+                case SnapshotColumnType::String:
+                    if (!value.is_string()) {
+                        return false;
+                    }
+                    ids.push_back(strings.intern(value.get<std::string>()));
+                    return true;
+
+                case SnapshotColumnType::Integer:
+                    if (value.is_number_unsigned() && value.get<uint64_t>() > static_cast<uint64_t>(INT64_MAX)) {
+                        return false;
+                    }
+                    if (!value.is_number_integer()) {
+                        return false;
+                    }
+                    integers.push_back(value.get<int64_t>());
+                    return true;
+
+                case SnapshotColumnType::Number:
+                    if (value.is_number_float()) {
+                        numbers.push_back(value.get<double>());
+                        return true;
+                    }
+                    if (value.is_number_integer() && !value.is_number_unsigned() &&
+                        std::llabs(value.get<int64_t>()) <= MAX_EXACT_INTEGER) {
+                        numbers.push_back(static_cast<double>(value.get<int64_t>()));
+                        return true;
+                    }
+                    if (value.is_number_unsigned() && value.get<uint64_t>() <= static_cast<uint64_t>(MAX_EXACT_INTEGER)) {
+                        numbers.push_back(static_cast<double>(value.get<uint64_t>()));
+                        return true;
+                    }
+                    return false;
+
+                case SnapshotColumnType::StringList: {
+                    if (!value.is_array()) {
+                        return false;
+                    }
+                    for (const auto& element : value) {
+                        if (!element.is_string()) {
+                            return false;
+                        }
+                    }
+                    for (const auto& element : value) {
+                        ids.push_back(strings.intern(element.get<std::string>()));
+                    }
+                    return true;
+                }
+
+                case SnapshotColumnType::Bitmap: {
+                    // Only strictly increasing small ids round-trip through a bitmap
+                    if (!value.is_array()) {
+                        return false;
+                    }
+                    int64_t previous = -1;
+                    for (const auto& element : value) {
+                        if (!element.is_number_integer()) {
+                            return false;
+                        }
+                        int64_t number = element.get<int64_t>();
+                        if (number <= previous || number >= MAX_BITMAP_VALUE) {
+                            return false;
+                        }
+                        previous = number;
+                    }
+
+                    size_t first = words.size();
+                    if (previous >= 0) {
+                        words.resize(first + static_cast<size_t>(previous / 64) + 1, 0);
+                    }
+                    for (const auto& element : value) {
+                        int64_t number = element.get<int64_t>();
+                        words[first + static_cast<size_t>(number / 64)] |= uint64_t(1) << (number % 64);
+                    }
+                    return true;
+                }
+
+                case SnapshotColumnType::Blob: {
+                    std::vector<uint8_t> packed = json::to_msgpack(value);
+                    blobBytes.append(reinterpret_cast<const char*>(packed.data()), packed.size());
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    struct TableBuilder {
+        std::string name;
+        uint64_t rows;
+        std::vector<ColumnBuilder> columns;
+    };
+
+    bool fitsTable(const EntitySchema* schema, const DatasetSection& section) {
+        if (schema == nullptr || !section.isArray) {
+            return false;
+        }
+        for (const auto& item : section.items) {
+            if (!item->is_object()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    TableBuilder buildTable(const std::string& name, const EntitySchema& schema, const DatasetSection& section,
+                            StringInterner& strings) {
+        size_t rows = section.items.size();
+        TableBuilder table{name, rows, {}};
+
+        for (const auto& field : schema.fields) {
+            table.columns.emplace_back(field.name, columnType(field.type), rows);
+        }
+        table.columns.emplace_back(RESIDUAL_COLUMN, SnapshotColumnType::Blob, rows);
+        ColumnBuilder& residualColumn = table.columns.back();
+
+        for (size_t row = 0; row < rows; ++row) {
+            const json& item = *section.items[row];
+            json residual = json::object();
+
+            for (size_t c = 0; c < schema.fields.size(); ++c) {
+                auto it = item.find(schema.fields[c].name);
+                const json* value = it != item.end() ? &*it : nullptr;
+                if (!table.columns[c].add(row, value, strings) && value != nullptr) {
+                    residual[schema.fields[c].name] = *value;
+                }
+            }
+
+            for (auto it = item.begin(); it != item.end(); ++it) {
+                if (std::none_of(schema.fields.begin(), schema.fields.end(),
+                        [&](const FieldSpec& field) { return it.key() == field.name; })) {
+                    residual[it.key()] = it.value();
+                }
+            }
+
+            residualColumn.add(row, residual.empty() ? nullptr : &residual, strings);
+        }
+
+        return table;
+    }
+
+    template <typename T>
+    bool inRange(uint64_t offset, uint64_t count, size_t fileLength) {
+        if (offset % alignof(T) != 0 || offset > fileLength) {
+            return false;
+        }
+        return count <= (fileLength - offset) / sizeof(T);
+    }
+}
+
+// --- SnapshotColumn ---
+
+SnapshotColumn::SnapshotColumn(const SnapshotView& view, const SnapshotColumnHeader& header, uint64_t rowCount)
+    : view(view), header(header), rowCount(rowCount) {
+}
+
+template <typename T>
+const T* SnapshotColumn::at(uint64_t offset) const {
+    return reinterpret_cast<const T*>(view.data() + offset);
+}
+
+uint64_t SnapshotColumn::indexAt(size_t row) const {
+    return at<uint64_t>(header.indexOffset)[row];
+}
+
+std::string_view SnapshotColumn::name() const {
+    return view.string(header.nameId);
+}
+
+bool SnapshotColumn::has(size_t row) const {
+    return (at<uint64_t>(header.presenceOffset)[row / 64] >> (row % 64)) & 1;
+}
+
+std::string_view SnapshotColumn::string(size_t row) const {
+    return view.string(at<uint32_t>(header.dataOffset)[row]);
+}
+
+int64_t SnapshotColumn::integer(size_t row) const {
+    return at<int64_t>(header.dataOffset)[row];
+}
+
+double SnapshotColumn::number(size_t row) const {
+    return at<double>(header.dataOffset)[row];
+}
+
+size_t SnapshotColumn::listSize(size_t row) const {
+    return static_cast<size_t>(indexAt(row + 1) - indexAt(row));
+}
+
+std::string_view SnapshotColumn::listString(size_t row, size_t position) const {
+    return view.string(at<uint32_t>(header.dataOffset)[indexAt(row) + position]);
+}
+
+const uint64_t* SnapshotColumn::bitmapWords(size_t row, size_t& wordCount) const {
+    wordCount = listSize(row);
+    return at<uint64_t>(header.dataOffset) + indexAt(row);
+}
+
+std::string_view SnapshotColumn::blob(size_t row) const {
+    const char* bytes = at<char>(header.dataOffset);
+    return std::string_view(bytes + indexAt(row), listSize(row));
+}
+
+// --- SnapshotTable ---
+
+SnapshotTable::SnapshotTable(const SnapshotView& view, const SnapshotTableHeader& header)
+    : view(view), header(header) {
+}
+
+std::string_view SnapshotTable::name() const {
+    return view.string(header.nameId);
+}
+
+SnapshotColumn SnapshotTable::column(size_t index) const {
+    const auto* columns = reinterpret_cast<const SnapshotColumnHeader*>(view.data() + header.columnsOffset);
+    return SnapshotColumn(view, columns[index], header.rowCount);
+}
+
+// --- SnapshotView ---
+
+SnapshotView::~SnapshotView() {
+    close();
+}
+
+bool SnapshotView::open(const std::string& path, std::string& error) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = "Cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(SnapshotFileHeader))) {
+        error = "Snapshot is truncated";
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        error = "mmap failed: " + std::string(strerror(errno));
+        return false;
+    }
+
+    base = static_cast<const uint8_t*>(mapping);
+    length = static_cast<size_t>(info.st_size);
+
+    if (!validate(error)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SnapshotView::close() {
+    if (base != nullptr) {
+        munmap(const_cast<uint8_t*>(base), length);
+    }
+    base = nullptr;
+    length = 0;
+    stringCount = 0;
+}
+
+const SnapshotFileHeader& SnapshotView::header() const {
+    return *reinterpret_cast<const SnapshotFileHeader*>(base);
+}
+
+std::string SnapshotView::contentHash() const {
+    return std::string(header().contentHash, sizeof(header().contentHash));
+}
+
+size_t SnapshotView::tableCount() const {
+    return header().tableCount;
+}
+
+SnapshotTable SnapshotView::table(size_t index) const {
+    const auto* tables = reinterpret_cast<const SnapshotTableHeader*>(base + sizeof(SnapshotFileHeader));
+    return SnapshotTable(*this, tables[index]);
+}
+
+std::string_view SnapshotView::string(uint32_t id) const {
+    const auto* offsets = reinterpret_cast<const uint64_t*>(base + header().stringTableOffset + sizeof(uint64_t));
+    const char* bytes = reinterpret_cast<const char*>(offsets + stringCount + 1);
+    return std::string_view(bytes + offsets[id], offsets[id + 1] - offsets[id]);
+}
+
+std::string_view SnapshotView::extraBlob() const {
+    return std::string_view(reinterpret_cast<const char*>(base) + header().extraOffset, header().extraSize);
+}
+
+bool SnapshotView::validate(std::string& error) {
+    const SnapshotFileHeader& file = header();
+
+    if (std::memcmp(file.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "Not a snapshot file";
+        return false;
+    }
+    if (file.version != DatasetSnapshot::FORMAT_VERSION) {
+        error = "Unsupported snapshot version " + std::to_string(file.version);
+        return false;
+    }
+    if (file.fileSize != length) {
+        error = "Snapshot size does not match its header";
+        return false;
+    }
+    if (!inRange<SnapshotTableHeader>(sizeof(SnapshotFileHeader), file.tableCount, length) ||
+        !inRange<char>(file.extraOffset, file.extraSize, length)) {
+        error = "Snapshot directory is out of bounds";
+        return false;
+    }
+
+    // String table
+    if (!inRange<uint64_t>(file.stringTableOffset, 1, length)) {
+        error = "String table is out of bounds";
+        return false;
+    }
+    uint64_t count = *reinterpret_cast<const uint64_t*>(base + file.stringTableOffset);
+    uint64_t offsetsStart = file.stringTableOffset + sizeof(uint64_t);
+    if (count >= UINT32_MAX || !inRange<uint64_t>(offsetsStart, count + 1, length)) {
+        error = "String table is out of bounds";
+        return false;
+    }
+    const auto* offsets = reinterpret_cast<const uint64_t*>(base + offsetsStart);
+    uint64_t bytesStart = offsetsStart + (count + 1) * sizeof(uint64_t);
+    if (offsets[0] != 0 || !inRange<char>(bytesStart, offsets[count], length)) {
+        error = "String table is out of bounds";
+        return false;
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        if (offsets[i + 1] < offsets[i]) {
+            error = "String table offsets are not monotonic";
+            return false;
+        }
+    }
+    stringCount = count;
+
+    // Tables and columns
+    for (size_t t = 0; t < file.tableCount; ++t) {
+        const auto& table = reinterpret_cast<const SnapshotTableHeader*>(base + sizeof(SnapshotFileHeader))[t];
+        if (table.nameId >= stringCount || !inRange<SnapshotColumnHeader>(table.columnsOffset, table.columnCount, length)) {
+            error = "Table " + std::to_string(t) + " is out of bounds";
+            return false;
+        }
+
+        const auto* columns = reinterpret_cast<const SnapshotColumnHeader*>(base + table.columnsOffset);
+        for (size_t c = 0; c < table.columnCount; ++c) {
+            const SnapshotColumnHeader& column = columns[c];
+            auto type = static_cast<SnapshotColumnType>(column.type);
+            std::string where = "Table " + std::to_string(t) + " column " + std::to_string(c);
+
+            if (column.nameId >= stringCount || column.type < 1 || column.type > 6) {
+                error = where + " has an invalid header";
+                return false;
+            }
+            if (table.rowCount > length * 8 ||
+                !inRange<uint64_t>(column.presenceOffset, (table.rowCount + 63) / 64, length)) {
+                error = where + " presence bitmap is out of bounds";
+                return false;
+            }
+
+            size_t size = elementSize(type);
+            bool dataFits = false;
+            switch (size) {
+                case 1: dataFits = inRange<char>(column.dataOffset, column.dataCount, length); break;
+                case 4: dataFits = inRange<uint32_t>(column.dataOffset, column.dataCount, length); break;
+                case 8: dataFits = inRange<uint64_t>(column.dataOffset, column.dataCount, length); break;
+            }
+            if (!dataFits || (!hasIndex(type) && column.dataCount != table.rowCount)) {
+                error = where + " data is out of bounds";
+                return false;
+            }
+
+            if (hasIndex(type)) {
+                if (!inRange<uint64_t>(column.indexOffset, table.rowCount + 1, length)) {
+                    error = where + " index is out of bounds";
+                    return false;
+                }
+                const auto* index = reinterpret_cast<const uint64_t*>(base + column.indexOffset);
+                if (index[0] != 0 || index[table.rowCount] != column.dataCount) {
+                    error = where + " index does not cover its data";
+                    return false;
+                }
+                for (uint64_t row = 0; row < table.rowCount; ++row) {
+                    if (index[row + 1] < index[row]) {
+                        error = where + " index is not monotonic";
+                        return false;
+                    }
+                }
+            }
+
+            if (type == SnapshotColumnType::String || type == SnapshotColumnType::StringList) {
+                const auto* ids = reinterpret_cast<const uint32_t*>(base + column.dataOffset);
+                for (uint64_t i = 0; i < column.dataCount; ++i) {
+                    if (ids[i] >= stringCount) {
+                        error = where + " references an unknown string";
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// --- DatasetSnapshot ---
+
+std::string DatasetSnapshot::encode(const DatasetSections& sections, const std::string& contentHash) {
+    StringInterner strings;
+    std::vector<TableBuilder> tables;
+    json extra = json::object();
+
+    for (const auto& [name, section] : sections) {
+        const EntitySchema* schema = DatasetSchema::find(name);
+        if (fitsTable(schema, *section)) {
+            tables.push_back(buildTable(name, *schema, *section, strings));
+        } else if (section->isArray) {
+            json items = json::array();
+            for (const auto& item : section->items) {
+                items.push_back(*item);
+            }
+            extra[name] = std::move(items);
+        } else {
+            extra[name] = *section->items.front();
+        }
+    }
+
+    ByteWriter writer;
+    uint64_t headerOffset = writer.reserve(sizeof(SnapshotFileHeader));
+    uint64_t tablesOffset = writer.reserve(sizeof(SnapshotTableHeader) * tables.size());
+
+    std::vector<uint32_t> tableNameIds;
+    std::vector<std::vector<uint32_t>> columnNameIds;
+    for (const auto& table : tables) {
+        tableNameIds.push_back(strings.intern(table.name));
+        columnNameIds.emplace_back();
+        for (const auto& column : table.columns) {
+            columnNameIds.back().push_back(strings.intern(column.name));
+        }
+    }
+
+    for (size_t t = 0; t < tables.size(); ++t) {
+        const TableBuilder& table = tables[t];
+        uint64_t columnsOffset = writer.reserve(sizeof(SnapshotColumnHeader) * table.columns.size());
+
+        for (size_t c = 0; c < table.columns.size(); ++c) {
+            SnapshotColumnHeader column{};
+            table.columns[c].write(writer, column, columnNameIds[t][c]);
+            writer.put(columnsOffset + c * sizeof(SnapshotColumnHeader), column);
+        }
+
+        SnapshotTableHeader tableHeader{};
+        tableHeader.nameId = tableNameIds[t];
+        tableHeader.columnCount = static_cast<uint32_t>(table.columns.size());
+        tableHeader.rowCount = table.rows;
+        tableHeader.columnsOffset = columnsOffset;
+        writer.put(tablesOffset + t * sizeof(SnapshotTableHeader), tableHeader);
+    }
+
+    // String table last: every name and value has been interned by now
+    const auto& all = strings.all();
+    std::vector<uint64_t> stringOffsets;
+    stringOffsets.reserve(all.size() + 2);
+    stringOffsets.push_back(all.size());
+    uint64_t position = 0;
+    stringOffsets.push_back(0);
+    for (const auto& value : all) {
+        position += value.size();
+        stringOffsets.push_back(position);
+    }
+    uint64_t stringTableOffset = writer.appendArray(stringOffsets);
+    std::string stringBytes;
+    stringBytes.reserve(position);
+    for (const auto& value : all) {
+        stringBytes += value;
+    }
+    writer.bytes += stringBytes;
+
+    std::vector<uint8_t> extraBytes;
+    if (!extra.empty()) {
+        extraBytes = json::to_msgpack(extra);
+    }
+    uint64_t extraOffset = writer.append(extraBytes.data(), extraBytes.size());
+    writer.reserve(0);  // Pad the file to the block alignment
+
+    SnapshotFileHeader file{};
+    std::memcpy(file.magic, MAGIC, sizeof(MAGIC));
+    file.version = FORMAT_VERSION;
+    file.tableCount = static_cast<uint32_t>(tables.size());
+    file.fileSize = writer.bytes.size();
+    file.stringTableOffset = stringTableOffset;
+    file.extraOffset = extraOffset;
+    file.extraSize = extraBytes.size();
+    std::memcpy(file.contentHash, contentHash.data(), std::min(contentHash.size(), sizeof(file.contentHash)));
+    writer.put(headerOffset, file);
+
+    return std::move(writer.bytes);
+}
+
+bool DatasetSnapshot::write(const DatasetSections& sections, const std::string& contentHash,
+                            const std::string& path, std::string& error) {
+    std::string bytes = encode(sections, contentHash);
+    // Equal uploads share the path; each writer renames its own temporary file over it
+    static std::atomic<uint64_t> writeNumber{0};
+    std::string temporaryPath = path + ".tmp" + std::to_string(writeNumber++);
+
+    {
+        std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            error = "Cannot create " + temporaryPath;
+            return false;
+        }
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!out) {
+            error = "Error writing " + temporaryPath;
+            return false;
+        }
+    }
+
+    std::error_code renameError;
+    std::filesystem::rename(temporaryPath, path, renameError);
+    if (renameError) {
+        error = "Cannot rename snapshot: " + renameError.message();
+        std::filesystem::remove(temporaryPath, renameError);
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const DatasetSection> DatasetSnapshot::toSection(const SnapshotTable& table) {
+    auto section = std::make_shared<DatasetSection>();
+    section->items.reserve(table.rowCount());
+
+    std::vector<SnapshotColumn> columns;
+    std::vector<std::string> names;
+    for (size_t c = 0; c < table.columnCount(); ++c) {
+        columns.push_back(table.column(c));
+        names.emplace_back(columns.back().name());
+    }
+
+    for (size_t row = 0; row < table.rowCount(); ++row) {
+        json item = json::object();
+
+        for (size_t c = 0; c < columns.size(); ++c) {
+            const SnapshotColumn& column = columns[c];
+            if (!column.has(row)) {
+                continue;
+            }
+
+            switch (column.type()) {
+                case SnapshotColumnType::String:
+                    item[names[c]] = std::string(column.string(row));
+                    break;
+                case SnapshotColumnType::Integer:
+                    item[names[c]] = column.integer(row);
+                    break;
+                case SnapshotColumnType::Number:
+                    item[names[c]] = decodeNumber(column.number(row));
+                    break;
+                case SnapshotColumnType::StringList: {
+                    json list = json::array();
+                    for (size_t i = 0; i < column.listSize(row); ++i) {
+                        list.push_back(std::string(column.listString(row, i)));
+                    }
+                    item[names[c]] = std::move(list);
+                    break;
+                }
+                case SnapshotColumnType::Bitmap: {
+                    json list = json::array();
+                    size_t wordCount = 0;
+                    const uint64_t* words = column.bitmapWords(row, wordCount);
+                    for (size_t w = 0; w < wordCount; ++w) {
+                        for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+                            list.push_back(static_cast<int64_t>(w * 64 + __builtin_ctzll(bits)));
+                        }
+                    }
+                    item[names[c]] = std::move(list);
+                    break;
+                }
+                case SnapshotColumnType::Blob: {
+                    std::string_view bytes = column.blob(row);
+                    json value = json::from_msgpack(bytes.begin(), bytes.end());
+                    if (names[c] == RESIDUAL_COLUMN) {
+                        item.update(value);
+                    } else {
+                        item[names[c]] = std::move(value);
+                    }
+                    break;
+                }
+            }
+        }
+
+        section->items.push_back(std::make_shared<const json>(std::move(item)));
+    }
+
+    return section;
+}
+
+DatasetSections DatasetSnapshot::extraSections(const SnapshotView& view) {
+    std::string_view extra = view.extraBlob();
+    if (extra.empty()) {
+        return {};
+    }
+    return Dataset::split(json::from_msgpack(extra.begin(), extra.end()));
+}
+
+DatasetSections DatasetSnapshot::toSections(const SnapshotView& view) {
+    DatasetSections sections = extraSections(view);
+    for (size_t t = 0; t < view.tableCount(); ++t) {
+        SnapshotTable table = view.table(t);
+        sections.emplace(std::string(table.name()), toSection(table));
+    }
+    return sections;
+}
+
+// --- SnapshotSections ---
+
+SnapshotSections::SnapshotSections(std::unique_ptr<const SnapshotView> view)
+    : view(std::move(view)), extraDecoded(false), complete(false) {
+    for (size_t t = 0; t < this->view->tableCount(); ++t) {
+        tables.emplace(std::string(this->view->table(t).name()), t);
+    }
+}
+
+std::shared_ptr<const DatasetSection> SnapshotSections::find(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = decoded.find(name);
+    if (it != decoded.end()) {
+        return it->second;
+    }
+
+    auto table = tables.find(name);
+    if (table != tables.end()) {
+        auto section = DatasetSnapshot::toSection(view->table(table->second));
+        decoded.emplace(name, section);
+        return section;
+    }
+
+    decodeExtra();
+    it = decoded.find(name);
+    return it != decoded.end() ? it->second : nullptr;
+}
+
+const DatasetSections& SnapshotSections::all() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!complete) {
+        for (const auto& [name, index] : tables) {
+            if (decoded.find(name) == decoded.end()) {
+                decoded.emplace(name, DatasetSnapshot::toSection(view->table(index)));
+            }
+        }
+        decodeExtra();
+        complete = true;
+    }
+    return decoded;
+}
+
+void SnapshotSections::decodeExtra() const {
+    if (!extraDecoded) {
+        decoded.merge(DatasetSnapshot::extraSections(*view));
+        extraDecoded = true;
+    }
+}
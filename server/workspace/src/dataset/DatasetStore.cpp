@@ -0,0 +1,398 @@
+#include "dataset/DatasetStore.hpp"
+#include "dataset/DatasetSnapshot.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+    // Compact the log once superseded records outnumber live ones by this factor
+    constexpr size_t COMPACTION_RATIO = 2;
+    constexpr size_t COMPACTION_MIN_RECORDS = 64;
+
+    uint64_t idNumber(const std::string& id) {
+        // IDs are "ds-N"
+        return id.rfind("ds-", 0) == 0 ? std::strtoull(id.c_str() + 3, nullptr, 10) : 0;
+    }
+}
+
+DatasetStore::DatasetStore(MetricsRegistry& metrics)
+    : storedDatasets(metrics.gauge("planner_datasets_stored", {}, "Datasets held by the dataset store")),
+      storedBytes(metrics.gauge("planner_dataset_bytes", {}, "Canonical JSON size of all stored datasets")),
+      loadedDatasets(metrics.gauge("planner_datasets_loaded", {}, "Stored datasets currently loaded in memory")),
+      retiredVersions(metrics.gauge("planner_dataset_retired_versions", {},
+          "Deleted dataset versions still pinned by running jobs, as of the last store write")),
+      deduplicatedUploads(metrics.counter("planner_dataset_dedup_hits_total", {},
+          "Uploads answered with an already stored dataset")),
+      lazyLoads(metrics.counter("planner_dataset_lazy_loads_total", {},
+          "Datasets mapped from their snapshot on first use")),
+      publishedEpochs(metrics.counter("planner_dataset_index_publishes_total", {},
+          "Dataset index versions published by writers")),
+      snapshotWrites(metrics.histogram("planner_dataset_snapshot_write_us", {},
+          "Time to encode and write one dataset snapshot")),
+      snapshotLoads(metrics.histogram("planner_dataset_snapshot_load_us", {},
+          "Time to map and validate one dataset snapshot")),
+      current(std::make_shared<const Index>()),
+      nextId(1) {
+}
+
+std::shared_ptr<const DatasetStore::Index> DatasetStore::snapshot() const {
+    return std::atomic_load(&current);
+}
+
+void DatasetStore::publish(std::shared_ptr<Index> next) {
+    // Caller holds writeMutex
+    next->epoch = snapshot()->epoch + 1;
+    std::shared_ptr<const Index> published = std::move(next);
+    std::atomic_store(&current, published);
+    publishedEpochs.increment();
+
+    // Counted after the swap, so the replaced index no longer holds deleted versions
+    publishGauges(*published);
+}
+
+bool DatasetStore::open(const std::string& directory) {
+    std::error_code fsError;
+    std::filesystem::create_directories(directory, fsError);
+    if (fsError) {
+        std::cerr << "Cannot create data directory " << directory << ": " << fsError.message() << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    auto next = std::make_shared<Index>(*snapshot());
+
+    std::string error;
+    if (!log.open(directory + "/datasets.log", [&](const json& record) { replay(*next, record); }, error)) {
+        std::cerr << "DatasetStore: " << error << std::endl;
+        return false;
+    }
+    dataDirectory = directory;
+
+    if (log.recordCount() > COMPACTION_MIN_RECORDS && log.recordCount() > COMPACTION_RATIO * next->byId.size()) {
+        std::vector<json> live;
+        for (const auto& [id, entry] : next->byId) {
+            json record = entry->summary;
+            record["op"] = "put";
+            live.push_back(std::move(record));
+        }
+        std::sort(live.begin(), live.end(), [](const json& a, const json& b) {
+            return idNumber(a["dataset_id"]) < idNumber(b["dataset_id"]);
+        });
+        log.rewrite(live);
+    }
+
+    std::cout << "DatasetStore: restored " << next->byId.size() << " datasets from " << directory << std::endl;
+    publish(std::move(next));
+    return true;
+}
+
+void DatasetStore::replay(Index& index, const json& record) {
+    std::string op = record.value("op", "");
+    std::string id = record.value("dataset_id", "");
+    if (id.empty()) {
+        return;
+    }
+
+    if (op == "put") {
+        auto entry = std::make_shared<Entry>();
+        entry->summary = record;
+        entry->summary.erase("op");
+        entry->persisted = true;
+        index.idsByHash[entry->summary.value("content_hash", "")] = id;
+        index.byId[id] = std::move(entry);
+        nextId = std::max(nextId, idNumber(id) + 1);
+    } else if (op == "delete") {
+        auto it = index.byId.find(id);
+        if (it != index.byId.end()) {
+            index.idsByHash.erase(it->second->summary.value("content_hash", ""));
+            index.byId.erase(it);
+        }
+    }
+}
+
+std::pair<std::shared_ptr<const Dataset>, bool> DatasetStore::add(json content, bool* persisted) {
+    return insert(Dataset::split(std::move(content)), "", 1, persisted);
+}
+
+std::pair<std::shared_ptr<const Dataset>, bool> DatasetStore::addSections(DatasetSections sections, bool* persisted) {
+    return insert(std::move(sections), "", 1, persisted);
+}
+
+std::pair<std::shared_ptr<const Dataset>, bool> DatasetStore::addVersion(const Dataset& parent, DatasetSections sections,
+                                                                         bool* persisted) {
+    return insert(std::move(sections), parent.id, parent.version + 1, persisted);
+}
+
+std::pair<std::shared_ptr<const Dataset>, bool> DatasetStore::insert(DatasetSections sections, const std::string& parentId,
+                                                                     uint64_t version, bool* persisted) {
+    // Hashing is the expensive part and needs no lock
+    size_t sizeBytes = 0;
+    std::string hash = Dataset::computeHash(sections, sizeBytes);
+
+    // Duplicates are answered from the published index without touching the writer lock
+    std::string existingId = findByHash(hash);
+    if (!existingId.empty()) {
+        if (auto dataset = get(existingId)) {
+            deduplicatedUploads.increment();
+            if (persisted) {
+                *persisted = isPersisted(existingId);
+            }
+            return {dataset, false};
+        }
+    }
+
+    auto dataset = std::make_shared<Dataset>();
+    dataset->parentId = parentId;
+    dataset->version = version;
+    dataset->contentHash = hash;
+    dataset->setSections(std::move(sections));
+    dataset->sizeBytes = sizeBytes;
+    dataset->createdAt = static_cast<int64_t>(std::time(nullptr));
+
+    std::string unreadableId;
+    bool replacedLogged = true;
+    json summary;
+    std::shared_ptr<Entry> entry;
+    {
+        std::unique_lock<std::mutex> lock(writeMutex);
+        auto next = std::make_shared<Index>(*snapshot());
+
+        auto existing = next->idsByHash.find(hash);
+        if (existing != next->idsByHash.end()) {
+            std::string id = existing->second;
+            if (id != existingId) {
+                // Stored by a concurrent writer after our first look
+                lock.unlock();
+                if (auto stored = get(id)) {
+                    deduplicatedUploads.increment();
+                    if (persisted) {
+                        *persisted = isPersisted(id);
+                    }
+                    return {stored, false};
+                }
+                lock.lock();
+                next = std::make_shared<Index>(*snapshot());
+            }
+            // The stored copy is unreadable; store this one in its place
+            next->byId.erase(id);
+            unreadableId = id;
+        }
+
+        dataset->id = "ds-" + std::to_string(nextId++);
+        summary = dataset->summary();
+
+        entry = std::make_shared<Entry>();
+        entry->summary = summary;
+        entry->dataset = dataset;
+        next->byId[dataset->id] = entry;
+        next->idsByHash[hash] = dataset->id;
+        publish(std::move(next));
+
+        // Without this record the unreadable copy would come back next to this one after a restart
+        if (!unreadableId.empty() && !dataDirectory.empty() &&
+            !log.append({{"op", "delete"}, {"dataset_id", unreadableId}})) {
+            replacedLogged = false;
+        }
+    }
+
+    if (persisted) {
+        *persisted = false;
+    }
+    if (dataDirectory.empty()) {
+        return {dataset, true};
+    }
+
+    // Encoding runs unlocked; the log hears of the dataset only once its file exists
+    bool written = writeSnapshot(*dataset);
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    auto index = snapshot();
+    if (index->byId.count(dataset->id) == 0) {
+        // Deleted before it was logged: no put may follow its delete record
+        removeUnreferencedSnapshot(*index, hash);
+    } else if (written) {
+        json record = summary;
+        record["op"] = "put";
+        if (log.append(record)) {
+            entry->persisted = true;
+            if (persisted) {
+                *persisted = replacedLogged;
+            }
+        } else {
+            std::cerr << "Dataset " << dataset->id << " was not persisted: datasets.log cannot be written" << std::endl;
+        }
+    }
+    return {dataset, true};
+}
+
+bool DatasetStore::isPersisted(const std::string& id) const {
+    auto index = snapshot();
+    auto it = index->byId.find(id);
+    return it != index->byId.end() && it->second->persisted;
+}
+
+bool DatasetStore::writeSnapshot(const Dataset& dataset) {
+    ScopedTimer timer(snapshotWrites);
+    std::string error;
+    if (!DatasetSnapshot::write(dataset.sections(), dataset.contentHash, snapshotPath(dataset.contentHash), error)) {
+        std::cerr << "Dataset " << dataset.id << " was not persisted: " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void DatasetStore::removeUnreferencedSnapshot(const Index& index, const std::string& contentHash) {
+    // Caller holds writeMutex. Snapshots are shared by content, and a re-upload of the same data may
+    // already be published and writing this very path
+    if (index.idsByHash.count(contentHash) != 0) {
+        return;
+    }
+    std::error_code error;
+    std::filesystem::remove(snapshotPath(contentHash), error);
+}
+
+std::shared_ptr<const Dataset> DatasetStore::get(const std::string& id) {
+    auto index = snapshot();
+    auto it = index->byId.find(id);
+    if (it == index->byId.end()) {
+        return nullptr;
+    }
+
+    const std::shared_ptr<Entry>& entry = it->second;
+    if (auto dataset = std::atomic_load(&entry->dataset)) {
+        return dataset;
+    }
+
+    // Decoding runs unlocked; if two readers race, the first to install its copy wins
+    std::shared_ptr<const Dataset> loaded = load(entry->summary);
+    if (!loaded) {
+        return nullptr;
+    }
+
+    std::shared_ptr<const Dataset> expected;
+    if (std::atomic_compare_exchange_strong(&entry->dataset, &expected, loaded)) {
+        lazyLoads.increment();
+        loadedDatasets.add(1);
+        return loaded;
+    }
+    return expected;
+}
+
+std::shared_ptr<const Dataset> DatasetStore::load(const json& summary) {
+    ScopedTimer timer(snapshotLoads);
+
+    auto dataset = std::make_shared<Dataset>();
+    dataset->id = summary.value("dataset_id", "");
+    dataset->parentId = summary.value("parent_id", "");
+    dataset->version = summary.value("version", uint64_t(1));
+    dataset->contentHash = summary.value("content_hash", "");
+    dataset->sizeBytes = summary.value("size_bytes", size_t(0));
+    dataset->createdAt = summary.value("created_at", int64_t(0));
+
+    if (dataDirectory.empty()) {
+        return nullptr;
+    }
+
+    auto view = std::make_unique<SnapshotView>();
+    std::string error;
+    if (!view->open(snapshotPath(dataset->contentHash), error)) {
+        std::cerr << "Dataset " << dataset->id << " cannot be loaded: " << error << std::endl;
+        return nullptr;
+    }
+    if (view->contentHash() != dataset->contentHash) {
+        std::cerr << "Dataset " << dataset->id << " cannot be loaded: snapshot holds other content" << std::endl;
+        return nullptr;
+    }
+
+    // Sections are decoded from the mapping when first read, not here
+    dataset->setSnapshot(std::make_shared<const SnapshotSections>(std::move(view)));
+    return dataset;
+}
+
+std::string DatasetStore::findByHash(const std::string& contentHash) const {
+    auto index = snapshot();
+    auto it = index->idsByHash.find(contentHash);
+    return it != index->idsByHash.end() ? it->second : "";
+}
+
+bool DatasetStore::remove(const std::string& id, bool* persisted) {
+    if (persisted) {
+        *persisted = true;
+    }
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    auto next = std::make_shared<Index>(*snapshot());
+    auto it = next->byId.find(id);
+    if (it == next->byId.end()) {
+        return false;
+    }
+
+    // Logged first and under the lock: a delete never precedes the put of the same dataset, and a
+    // delete that is not in the log is not done, or the dataset would come back after a restart
+    if (!dataDirectory.empty() && !log.append({{"op", "delete"}, {"dataset_id", id}})) {
+        if (persisted) {
+            *persisted = false;
+        }
+        return false;
+    }
+
+    // Jobs may still hold this version; it is freed when the last one finishes
+    if (auto dataset = std::atomic_load(&it->second->dataset)) {
+        retired.push_back(dataset);
+    }
+    std::string hash = it->second->summary.value("content_hash", "");
+    next->idsByHash.erase(hash);
+    next->byId.erase(it);
+    publish(std::move(next));
+
+    if (!dataDirectory.empty()) {
+        removeUnreferencedSnapshot(*snapshot(), hash);
+    }
+    return true;
+}
+
+std::vector<json> DatasetStore::list() const {
+    auto index = snapshot();
+    std::vector<json> result;
+    result.reserve(index->byId.size());
+    for (const auto& [id, entry] : index->byId) {
+        result.push_back(entry->summary);
+    }
+
+    std::sort(result.begin(), result.end(), [](const json& a, const json& b) {
+        int64_t createdA = a.value("created_at", int64_t(0));
+        int64_t createdB = b.value("created_at", int64_t(0));
+        return createdA != createdB ? createdA < createdB
+                                    : idNumber(a.value("dataset_id", "")) < idNumber(b.value("dataset_id", ""));
+    });
+    return result;
+}
+
+uint64_t DatasetStore::epoch() const {
+    return snapshot()->epoch;
+}
+
+void DatasetStore::publishGauges(const Index& index) {
+    // Caller holds writeMutex
+    int64_t bytes = 0;
+    int64_t loaded = 0;
+    for (const auto& [id, entry] : index.byId) {
+        bytes += entry->summary.value("size_bytes", int64_t(0));
+        loaded += std::atomic_load(&entry->dataset) ? 1 : 0;
+    }
+
+    retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                 [](const std::weak_ptr<const Dataset>& version) { return version.expired(); }),
+                  retired.end());
+
+    storedDatasets.set(static_cast<int64_t>(index.byId.size()));
+    storedBytes.set(bytes);
+    loadedDatasets.set(loaded);
+    retiredVersions.set(static_cast<int64_t>(retired.size()));
+}
+
+std::string DatasetStore::snapshotPath(const std::string& contentHash) const {
+    return dataDirectory + "/" + contentHash + ".snap";
+}
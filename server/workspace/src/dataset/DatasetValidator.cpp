@@ -0,0 +1,236 @@
+#include "dataset/DatasetValidator.hpp"
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+    constexpr const char* WILDCARD = "*";
+
+    // Entity ids of one section -> position, views into the dataset's items
+    using IdIndex = std::unordered_map<std::string_view, size_t>;
+
+    struct ReferenceKey {
+        const char* key;
+        const char* section;
+    };
+
+    // Constraint data fields that name entities, see the examples in schedule/ScheduleData.hpp
+    const std::vector<ReferenceKey> CONSTRAINT_REFERENCES = {
+        {"teacherId", "teachers"}, {"teacherIds", "teachers"},
+        {"subjectId", "subjects"}, {"subjectIds", "subjects"}, {"subjects", "subjects"},
+        {"beforeSubject", "subjects"}, {"afterSubject", "subjects"},
+        {"groupId", "groups"}, {"groupIds", "groups"},
+        {"roomId", "rooms"}, {"roomIds", "rooms"},
+        {"timeBlocks", "timeBlocks"}
+    };
+
+    const char* const ENTITY_SECTIONS[] = {"timeBlocks", "subjects", "groups", "rooms", "teachers"};
+
+    class Validator {
+    public:
+        Validator(const DatasetSections& sections, size_t maxErrors)
+            : sections(sections), maxErrors(maxErrors) {
+        }
+
+        ValidationReport run() {
+            for (const char* name : ENTITY_SECTIONS) {
+                indexSection(name);
+            }
+            checkTeachers();
+            checkGroups();
+            checkConstraints();
+            return std::move(report);
+        }
+
+    private:
+        const DatasetSections& sections;
+        size_t maxErrors;
+        ValidationReport report;
+        std::unordered_map<std::string, IdIndex> indexes;
+
+        const DatasetSection* section(const std::string& name) const {
+            auto it = sections.find(name);
+            return it != sections.end() && it->second->isArray ? it->second.get() : nullptr;
+        }
+
+        static std::string_view idOf(const json& item) {
+            if (!item.is_object()) {
+                return {};
+            }
+            auto id = item.find("id");
+            return id != item.end() && id->is_string() ? std::string_view(id->get_ref<const std::string&>())
+                                                       : std::string_view();
+        }
+
+        void addError(const char* code, const std::string& sectionName, size_t index, const json& item,
+                      const std::string& field, const json& value, const std::string& message) {
+            if (report.errors.size() >= maxErrors) {
+                report.truncated = true;
+                return;
+            }
+            json error = {
+                {"code", code},
+                {"section", sectionName},
+                {"index", index},
+                {"field", field},
+                {"message", message}
+            };
+            std::string_view id = idOf(item);
+            if (!id.empty()) {
+                error["id"] = std::string(id);
+            }
+            if (!value.is_null()) {
+                error["value"] = value;
+            }
+            report.errors.push_back(std::move(error));
+        }
+
+        void indexSection(const char* name) {
+            IdIndex& index = indexes[name];
+            const DatasetSection* items = section(name);
+            if (!items) {
+                return;
+            }
+
+            index.reserve(items->items.size());
+            for (size_t i = 0; i < items->items.size(); ++i) {
+                std::string_view id = idOf(*items->items[i]);
+                if (id.empty()) {
+                    continue;
+                }
+                auto [it, inserted] = index.emplace(id, i);
+                if (!inserted) {
+                    addError("DUPLICATE_ID", name, i, *items->items[i], "id", std::string(id),
+                             std::string(name) + "[" + std::to_string(i) + "] repeats id '" + std::string(id) +
+                             "' of " + name + "[" + std::to_string(it->second) + "]");
+                }
+            }
+        }
+
+        bool exists(const std::string& sectionName, std::string_view id) const {
+            const IdIndex& index = indexes.at(sectionName);
+            return index.find(id) != index.end();
+        }
+
+        /**
+         * Checks a string or array of strings naming entities of target
+         */
+        void checkReference(const std::string& sectionName, size_t index, const json& item, const std::string& field,
+                            const json& value, const std::string& target, bool allowWildcard) {
+            auto check = [&](const json& reference) {
+                if (!reference.is_string()) {
+                    return;
+                }
+                const std::string& id = reference.get_ref<const std::string&>();
+                if ((allowWildcard && id == WILDCARD) || exists(target, id)) {
+                    return;
+                }
+                addError("UNKNOWN_REFERENCE", sectionName, index, item, field, reference,
+                         field + " refers to unknown " + target + " id '" + id + "'");
+            };
+
+            if (value.is_array()) {
+                for (const auto& reference : value) {
+                    check(reference);
+                }
+            } else {
+                check(value);
+            }
+        }
+
+        void checkTeachers() {
+            const DatasetSection* teachers = section("teachers");
+            if (!teachers) {
+                return;
+            }
+            for (size_t i = 0; i < teachers->items.size(); ++i) {
+                const json& teacher = *teachers->items[i];
+                auto subjects = teacher.is_object() ? teacher.find("subjects") : teacher.end();
+                if (subjects != teacher.end()) {
+                    checkReference("teachers", i, teacher, "subjects", *subjects, "subjects", false);
+                }
+            }
+        }
+
+        void checkGroups() {
+            const DatasetSection* groups = section("groups");
+            if (!groups) {
+                return;
+            }
+
+            // Parent position per group, or npos for roots and unknown parents
+            constexpr size_t NONE = static_cast<size_t>(-1);
+            const IdIndex& index = indexes.at("groups");
+            std::vector<size_t> parents(groups->items.size(), NONE);
+
+            for (size_t i = 0; i < groups->items.size(); ++i) {
+                const json& group = *groups->items[i];
+                auto parent = group.is_object() ? group.find("parentGroupId") : group.end();
+                if (parent == group.end() || !parent->is_string() || parent->get_ref<const std::string&>().empty()) {
+                    continue;  // "" and null both mean no parent
+                }
+                auto it = index.find(parent->get_ref<const std::string&>());
+                if (it == index.end()) {
+                    checkReference("groups", i, group, "parentGroupId", *parent, "groups", false);
+                } else {
+                    parents[i] = it->second;
+                }
+            }
+
+            // Each group is walked at most once: 0 unvisited, 1 on the current path, 2 done
+            std::vector<uint8_t> state(groups->items.size(), 0);
+            std::vector<size_t> path;
+            for (size_t start = 0; start < groups->items.size(); ++start) {
+                size_t current = start;
+                while (current != NONE && state[current] == 0) {
+                    state[current] = 1;
+                    path.push_back(current);
+                    current = parents[current];
+                }
+                if (current != NONE && state[current] == 1) {
+                    // current is where the path closes on itself
+                    std::string cycle;
+                    size_t member = current;
+                    do {
+                        cycle += std::string(idOf(*groups->items[member])) + " -> ";
+                        member = parents[member];
+                    } while (member != current);
+                    cycle += std::string(idOf(*groups->items[current]));
+
+                    const json& group = *groups->items[current];
+                    addError("PARENT_CYCLE", "groups", current, group, "parentGroupId", group["parentGroupId"],
+                             "parentGroupId forms a cycle: " + cycle);
+                }
+                for (size_t member : path) {
+                    state[member] = 2;
+                }
+                path.clear();
+            }
+        }
+
+        void checkConstraints() {
+            const DatasetSection* constraints = section("constraints");
+            if (!constraints) {
+                return;
+            }
+            for (size_t i = 0; i < constraints->items.size(); ++i) {
+                const json& constraint = *constraints->items[i];
+                auto data = constraint.is_object() ? constraint.find("data") : constraint.end();
+                if (data == constraint.end() || !data->is_object()) {
+                    continue;
+                }
+                for (const auto& reference : CONSTRAINT_REFERENCES) {
+                    auto value = data->find(reference.key);
+                    if (value != data->end()) {
+                        checkReference("constraints", i, constraint, std::string("data.") + reference.key, *value,
+                                       reference.section, true);
+                    }
+                }
+            }
+        }
+    };
+}
+
+ValidationReport DatasetValidator::validate(const DatasetSections& sections, size_t maxErrors) {
+    return Validator(sections, maxErrors).run();
+}
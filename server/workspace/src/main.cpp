@@ -2,6 +2,7 @@
 #include <memory>
 #include <thread>
 #include <chrono>
+#include <cstdlib>
 #include "core/System.hpp"
 #include "control/handlers/DataHandler.hpp"
 #include "control/handlers/DebugHandler.hpp"
@@ -11,15 +12,27 @@
 int main() {
     System system(8080);  // Podajemy port
     
+    // CSV files for the Data import command are read from here, e.g. PLANNER_IMPORT_DIR=/srv/planner/import
+    const char* importDir = std::getenv("PLANNER_IMPORT_DIR");
+    
     // Register message handlers
     std::cout << "Registering message handlers..." << std::endl;
-    system.registerHandler(std::make_unique<DataHandler>());
+    system.registerHandler(std::make_unique<DataHandler>(importDir ? importDir : "../data/import"));
     system.registerHandler(std::make_unique<DebugHandler>());
     system.registerHandler(std::make_unique<CommandHandler>());
     system.registerHandler(std::make_unique<AlgorithmHandler>());
     
+    // Datasets and job results survive restarts, e.g. PLANNER_DATA_DIR=/var/lib/planner
+    const char* dataDir = std::getenv("PLANNER_DATA_DIR");
+    system.openStorage(dataDir ? dataDir : "../data/store");
+    
     system.start();
     
+    // Optional Prometheus endpoint, e.g. PLANNER_METRICS_PORT=9464
+    if (const char* metricsPort = std::getenv("PLANNER_METRICS_PORT")) {
+        system.startMetricsExporter(std::atoi(metricsPort));
+    }
+    
     std::cout << "Server started. Waiting for client connection..." << std::endl;
     
     // Wait for client connection in a loop
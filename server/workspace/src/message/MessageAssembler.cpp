@@ -5,7 +5,12 @@
 std::optional<std::string> MessageAssembler::addFragment(const MessageFrame& frame)
 {   
     // Add fragment to the incomplete messages map, if entry does not exist, create it
-    incompleteMessages[frame.header.messageId].push_back(frame);
+    auto& fragments = incompleteMessages[frame.header.messageId];
+    if (fragments.empty()) {
+        firstFragmentTimes[frame.header.messageId] = std::chrono::steady_clock::now();
+    }
+    fragments.push_back(frame);
+    pendingBytes += frame.payload.size();
     if (isMessageComplete(frame.header.messageId))
     {
         return frame.header.messageId;
@@ -99,10 +104,30 @@ std::optional<MessageType> MessageAssembler::getMessageType(const std::string& m
     return it->second[0].header.type;
 }
 
+std::optional<std::chrono::steady_clock::duration> MessageAssembler::getAssemblyDuration(const std::string& messageId) const {
+    auto it = firstFragmentTimes.find(messageId);
+    if (it == firstFragmentTimes.end()) {
+        return std::nullopt;
+    }
+    
+    return std::chrono::steady_clock::now() - it->second;
+}
+
 void MessageAssembler::cleanup(const std::string& messageId) {
-    incompleteMessages.erase(messageId);
+    auto it = incompleteMessages.find(messageId);
+    if (it != incompleteMessages.end()) {
+        for (const auto& fragment : it->second) {
+            pendingBytes -= fragment.payload.size();
+        }
+        incompleteMessages.erase(it);
+    }
+    firstFragmentTimes.erase(messageId);
 }
 
 size_t MessageAssembler::getIncompleteMessageCount() const {
     return incompleteMessages.size();
+}
+
+size_t MessageAssembler::getPendingBytes() const {
+    return pendingBytes;
 }
\ No newline at end of file
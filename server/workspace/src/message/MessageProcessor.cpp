@@ -5,7 +5,22 @@
 #include <chrono>
 
 MessageProcessor::MessageProcessor(System* sys, int port) 
-    : running(false), system(sys), serverSocket(std::make_unique<ServerSocket>(port)) {
+    : running(false), system(sys),
+      serverSocket(std::make_unique<ServerSocket>(port, &sys->getMetrics(), &sys->getTracer())),
+      tracer(sys->getTracer()),
+      queueWaitHistogram(sys->getMetrics().histogram("planner_dispatch_queue_wait_us", {},
+          "Time a frame waits in the receive queue before processing")),
+      reassemblyHistogram(sys->getMetrics().histogram("planner_reassembly_us", {},
+          "Time from the first fragment of a message until it is complete")),
+      messagesCompleted(sys->getMetrics().counter("planner_messages_completed_total", {},
+          "Fully reassembled messages handed to the dispatcher")),
+      receiveQueueDepth(sys->getMetrics().gauge("planner_receive_queue_depth", {},
+          "Frames waiting for the processing thread")),
+      reassemblyBytes(sys->getMetrics().gauge("planner_reassembly_bytes", {},
+          "Payload bytes buffered in fragments of incomplete messages")),
+      incompleteMessages(sys->getMetrics().gauge("planner_incomplete_messages", {},
+          "Messages with fragments still missing")),
+      assemblyPhase(&sys->getMetrics(), "assembler.assemble") {
     std::cout << "MessageProcessor initialized with ServerSocket on port " << port << std::endl;
 
     setOnConnectedCallback([this]() {
@@ -87,6 +102,8 @@ bool MessageProcessor::isRunning() const {
 }
 
 void MessageProcessor::sendMessage(const std::string& messageId, const std::string& payload, MessageType type) {
+    TraceScope trace(&tracer, messageId, "processor.fragment");
+    
     // Fragment the message if needed
     std::vector<MessageFrame> fragments = fragmenter.fragment(payload, type);
     
@@ -142,6 +159,7 @@ void MessageProcessor::setOnDisconnectedCallback(std::function<void()> callback)
 void MessageProcessor::processLoop()
 {
     std::cout << "MessageProcessor: processLoop started" << std::endl;
+    tracer.nameCurrentThread("processor");
     
     while (running)
     {
@@ -150,7 +168,7 @@ void MessageProcessor::processLoop()
             break;
         }
         
-        std::vector<MessageFrame> localQueue;
+        std::vector<QueuedFrame> localQueue;
         
         // Handle case when serverSocket is not set
         if (!serverSocket) {
@@ -189,9 +207,10 @@ void MessageProcessor::processLoop()
             
             while (!serverSocket->getReceiveQueue().empty() && running)
             {
-                localQueue.push_back(serverSocket->getReceiveQueue().front());
+                localQueue.push_back(std::move(serverSocket->getReceiveQueue().front()));
                 serverSocket->getReceiveQueue().pop();
             }
+            receiveQueueDepth.add(-static_cast<int64_t>(localQueue.size()));
             
         } catch (const std::exception& e) {
             std::cerr << "Exception in processLoop: " << e.what() << std::endl;
@@ -206,8 +225,15 @@ void MessageProcessor::processLoop()
         // Process messages outside of any locks
         if (!localQueue.empty())
         {
-            for (const auto& frame : localQueue)
+            auto dequeuedAt = std::chrono::steady_clock::now();
+            
+            for (const auto& queued : localQueue)
             {
+                const MessageFrame& frame = queued.frame;
+                queueWaitHistogram.record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(dequeuedAt - queued.queuedAt).count()));
+                tracer.record(frame.header.messageId, "processor.queue_wait", queued.queuedAt, dequeuedAt);
+                
                 // Re-assemble and dispatch the message.
                 auto messageIdOpt = assembler.addFragment(frame);
                 if (messageIdOpt)
@@ -215,10 +241,23 @@ void MessageProcessor::processLoop()
                     // Message is complete, process it
                     std::string messageId = messageIdOpt.value();
                     
-                    auto payloadOpt = assembler.getAssembledMessage(messageId);
+                    std::optional<std::string> payloadOpt;
+                    {
+                        PerfScope perf(assemblyPhase);
+                        payloadOpt = assembler.getAssembledMessage(messageId);
+                    }
                     auto typeOpt = assembler.getMessageType(messageId);
                     
+                    if (auto assemblyTime = assembler.getAssemblyDuration(messageId)) {
+                        reassemblyHistogram.record(static_cast<uint64_t>(
+                            std::chrono::duration_cast<std::chrono::microseconds>(*assemblyTime).count()));
+                        auto assembledAt = std::chrono::steady_clock::now();
+                        tracer.record(messageId, "assembler.reassemble", assembledAt - *assemblyTime, assembledAt);
+                    }
+                    
                     if (payloadOpt && typeOpt) {
+                        messagesCompleted.increment();
+                        
                         // Dispatch the complete message
                         handleCompleteMessage(messageId, payloadOpt.value(), typeOpt.value());
                         
@@ -229,6 +268,9 @@ void MessageProcessor::processLoop()
                     }
                 }
             }
+            
+            reassemblyBytes.set(static_cast<int64_t>(assembler.getPendingBytes()));
+            incompleteMessages.set(static_cast<int64_t>(assembler.getIncompleteMessageCount()));
         }
     }
 }
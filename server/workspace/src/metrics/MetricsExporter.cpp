@@ -0,0 +1,127 @@
+#include "metrics/MetricsExporter.hpp"
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+MetricsExporter::MetricsExporter(MetricsRegistry& registry, int port)
+    : registry(registry), port(port), listenSocket(-1), running(false) {
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::start() {
+    if (running.load()) {
+        return true;
+    }
+
+    listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket < 0) {
+        std::cerr << "MetricsExporter: Failed to create socket" << std::endl;
+        return false;
+    }
+
+    int opt = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    // Metrics are for local scrapers only, never expose them on all interfaces
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (bind(listenSocket, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+        listen(listenSocket, 4) < 0) {
+        std::cerr << "MetricsExporter: Failed to listen on port " << port << ": " << strerror(errno) << std::endl;
+        close(listenSocket);
+        listenSocket = -1;
+        return false;
+    }
+
+    running.store(true);
+    serveThread = std::thread(&MetricsExporter::serveLoop, this);
+
+    std::cout << "MetricsExporter: Serving Prometheus metrics on 127.0.0.1:" << port << std::endl;
+    return true;
+}
+
+void MetricsExporter::stop() {
+    if (!running.load()) {
+        return;
+    }
+
+    running.store(false);
+
+    if (serveThread.joinable()) {
+        serveThread.join();
+    }
+
+    if (listenSocket >= 0) {
+        close(listenSocket);
+        listenSocket = -1;
+    }
+}
+
+bool MetricsExporter::isRunning() const {
+    return running.load();
+}
+
+void MetricsExporter::serveLoop() {
+    while (running) {
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        FD_SET(listenSocket, &readfds);
+
+        // Short timeout so stop() is noticed quickly
+        struct timeval tv;
+        tv.tv_sec = 0;
+        tv.tv_usec = 200000;
+
+        if (select(listenSocket + 1, &readfds, NULL, NULL, &tv) <= 0) {
+            continue;
+        }
+
+        int clientSocket = ::accept(listenSocket, nullptr, nullptr);
+        if (clientSocket < 0) {
+            continue;
+        }
+
+        handleClient(clientSocket);
+        close(clientSocket);
+    }
+}
+
+void MetricsExporter::handleClient(int clientSocket) {
+    struct timeval recv_tv;
+    recv_tv.tv_sec = 1;
+    recv_tv.tv_usec = 0;
+    setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, &recv_tv, sizeof(recv_tv));
+
+    // The request itself is irrelevant, every path returns the metrics page
+    char buffer[1024];
+    recv(clientSocket, buffer, sizeof(buffer), 0);
+
+    std::string body = registry.toPrometheus();
+    std::string response =
+        "HTTP/1.0 200 OK\r\n"
+        "Content-Type: text/plain; version=0.0.4\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Connection: close\r\n"
+        "\r\n" + body;
+
+    size_t totalSent = 0;
+    while (totalSent < response.size()) {
+        ssize_t bytesSent = send(clientSocket, response.data() + totalSent, response.size() - totalSent, MSG_NOSIGNAL);
+        if (bytesSent <= 0) {
+            break;
+        }
+        totalSent += bytesSent;
+    }
+}
@@ -0,0 +1,312 @@
+#include "metrics/MetricsRegistry.hpp"
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    constexpr double EXPORTED_QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+    std::string seriesName(const Metric& metric, const std::string& suffix = "") {
+        std::string result = metric.getName() + suffix;
+        if (!metric.getLabels().empty()) {
+            result += "{" + metric.getLabels() + "}";
+        }
+        return result;
+    }
+
+    const char* kindName(MetricKind kind) {
+        switch (kind) {
+            case MetricKind::Counter: return "counter";
+            case MetricKind::Gauge: return "gauge";
+            case MetricKind::Histogram: return "summary";
+        }
+        return "untyped";
+    }
+}
+
+// --- Metric ---
+
+Metric::Metric(MetricKind kind, std::string name, std::string labels, std::string help)
+    : kind(kind), name(std::move(name)), labels(std::move(labels)), help(std::move(help)) {
+}
+
+Counter::Counter(std::string name, std::string labels, std::string help)
+    : Metric(MetricKind::Counter, std::move(name), std::move(labels), std::move(help)) {
+}
+
+Gauge::Gauge(std::string name, std::string labels, std::string help)
+    : Metric(MetricKind::Gauge, std::move(name), std::move(labels), std::move(help)) {
+}
+
+// --- Histogram ---
+
+Histogram::Histogram(std::string name, std::string labels, std::string help)
+    : Metric(MetricKind::Histogram, std::move(name), std::move(labels), std::move(help)) {
+}
+
+int Histogram::bucketIndex(uint64_t value) {
+    if (value < static_cast<uint64_t>(SUB_BUCKET_COUNT)) {
+        return static_cast<int>(value);
+    }
+
+    const uint64_t maxValue = (uint64_t{1} << MAX_MAGNITUDE) - 1;
+    value = std::min(value, maxValue);
+
+    // Position of the highest set bit selects the power of two, the next
+    // SUB_BUCKET_BITS bits select the linear sub-bucket inside it
+    int magnitude = 63 - __builtin_clzll(value);
+    int shift = magnitude - SUB_BUCKET_BITS;
+    int subBucket = static_cast<int>((value >> shift) - SUB_BUCKET_COUNT);
+
+    return SUB_BUCKET_COUNT + shift * SUB_BUCKET_COUNT + subBucket;
+}
+
+uint64_t Histogram::bucketUpperBound(int index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return static_cast<uint64_t>(index);
+    }
+
+    int shift = (index - SUB_BUCKET_COUNT) / SUB_BUCKET_COUNT;
+    uint64_t subBucket = static_cast<uint64_t>((index - SUB_BUCKET_COUNT) % SUB_BUCKET_COUNT);
+
+    return ((SUB_BUCKET_COUNT + subBucket + 1) << shift) - 1;
+}
+
+void Histogram::record(uint64_t value) {
+    buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    valueSum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t currentMax = maxValue.load(std::memory_order_relaxed);
+    while (value > currentMax &&
+           !maxValue.compare_exchange_weak(currentMax, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::percentile(double quantile) const {
+    uint64_t observed = count();
+    if (observed == 0) {
+        return 0;
+    }
+
+    quantile = std::clamp(quantile, 0.0, 1.0);
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(quantile * observed + 0.5));
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            // Never report more than the largest value actually recorded
+            return std::min(bucketUpperBound(i), max());
+        }
+    }
+
+    return max();
+}
+
+// --- ScopedTimer ---
+
+ScopedTimer::ScopedTimer(Histogram& histogram)
+    : histogram(histogram), start(std::chrono::steady_clock::now()) {
+}
+
+ScopedTimer::~ScopedTimer() {
+    histogram.record(elapsedMicros());
+}
+
+uint64_t ScopedTimer::elapsedMicros() const {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+// --- MetricsRegistry ---
+
+MetricsRegistry::MetricsRegistry()
+    : overflowCounter("planner_metrics_overflow", "", ""),
+      overflowGauge("planner_metrics_overflow", "", ""),
+      overflowHistogram("planner_metrics_overflow", "", "") {
+}
+
+MetricsRegistry::~MetricsRegistry() {
+    for (auto& slot : slots) {
+        delete slot.load(std::memory_order_acquire);
+    }
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const Labels& labels, const std::string& help) {
+    Metric* metric = findOrInsert(MetricKind::Counter, name, labels, help);
+    return metric ? static_cast<Counter&>(*metric) : overflowCounter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const Labels& labels, const std::string& help) {
+    Metric* metric = findOrInsert(MetricKind::Gauge, name, labels, help);
+    return metric ? static_cast<Gauge&>(*metric) : overflowGauge;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const Labels& labels, const std::string& help) {
+    Metric* metric = findOrInsert(MetricKind::Histogram, name, labels, help);
+    return metric ? static_cast<Histogram&>(*metric) : overflowHistogram;
+}
+
+Metric* MetricsRegistry::findOrInsert(MetricKind kind, const std::string& name, const Labels& labels, const std::string& help) {
+    std::string renderedLabels = renderLabels(labels);
+    size_t start = std::hash<std::string>{}(name + "{" + renderedLabels + "}") % MAX_METRICS;
+
+    std::unique_ptr<Metric> candidate;
+
+    // Linear probing; a slot once published is never changed again
+    for (size_t probe = 0; probe < MAX_METRICS; ++probe) {
+        auto& slot = slots[(start + probe) % MAX_METRICS];
+        Metric* existing = slot.load(std::memory_order_acquire);
+
+        if (existing == nullptr) {
+            if (!candidate) {
+                switch (kind) {
+                    case MetricKind::Counter:
+                        candidate = std::make_unique<Counter>(name, renderedLabels, help);
+                        break;
+                    case MetricKind::Gauge:
+                        candidate = std::make_unique<Gauge>(name, renderedLabels, help);
+                        break;
+                    case MetricKind::Histogram:
+                        candidate = std::make_unique<Histogram>(name, renderedLabels, help);
+                        break;
+                }
+            }
+
+            if (slot.compare_exchange_strong(existing, candidate.get(), std::memory_order_acq_rel)) {
+                registered.fetch_add(1, std::memory_order_relaxed);
+                return candidate.release();
+            }
+            // Another thread won the slot, existing now holds its metric
+        }
+
+        if (existing->getName() == name && existing->getLabels() == renderedLabels) {
+            if (existing->getKind() != kind) {
+                throw std::invalid_argument("Metric '" + name + "' already registered with a different kind");
+            }
+            return existing;
+        }
+    }
+
+    return nullptr;
+}
+
+size_t MetricsRegistry::size() const {
+    return registered.load(std::memory_order_relaxed);
+}
+
+std::vector<const Metric*> MetricsRegistry::sortedMetrics() const {
+    std::vector<const Metric*> metrics;
+    metrics.reserve(size());
+
+    for (const auto& slot : slots) {
+        const Metric* metric = slot.load(std::memory_order_acquire);
+        if (metric != nullptr) {
+            metrics.push_back(metric);
+        }
+    }
+
+    std::sort(metrics.begin(), metrics.end(), [](const Metric* a, const Metric* b) {
+        if (a->getName() != b->getName()) return a->getName() < b->getName();
+        return a->getLabels() < b->getLabels();
+    });
+
+    return metrics;
+}
+
+json MetricsRegistry::toJson() const {
+    json result = json::object();
+
+    for (const Metric* metric : sortedMetrics()) {
+        std::string key = seriesName(*metric);
+
+        switch (metric->getKind()) {
+            case MetricKind::Counter:
+                result[key] = static_cast<const Counter*>(metric)->value();
+                break;
+            case MetricKind::Gauge:
+                result[key] = static_cast<const Gauge*>(metric)->value();
+                break;
+            case MetricKind::Histogram: {
+                const auto* histogram = static_cast<const Histogram*>(metric);
+                result[key] = {
+                    {"count", histogram->count()},
+                    {"sum", histogram->sum()},
+                    {"max", histogram->max()},
+                    {"p50", histogram->percentile(0.5)},
+                    {"p90", histogram->percentile(0.9)},
+                    {"p99", histogram->percentile(0.99)},
+                    {"p999", histogram->percentile(0.999)}
+                };
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+std::string MetricsRegistry::toPrometheus() const {
+    std::ostringstream out;
+    std::string lastName;
+
+    for (const Metric* metric : sortedMetrics()) {
+        if (metric->getName() != lastName) {
+            lastName = metric->getName();
+            if (!metric->getHelp().empty()) {
+                out << "# HELP " << lastName << " " << metric->getHelp() << "\n";
+            }
+            out << "# TYPE " << lastName << " " << kindName(metric->getKind()) << "\n";
+        }
+
+        switch (metric->getKind()) {
+            case MetricKind::Counter:
+                out << seriesName(*metric) << " " << static_cast<const Counter*>(metric)->value() << "\n";
+                break;
+            case MetricKind::Gauge:
+                out << seriesName(*metric) << " " << static_cast<const Gauge*>(metric)->value() << "\n";
+                break;
+            case MetricKind::Histogram: {
+                const auto* histogram = static_cast<const Histogram*>(metric);
+                std::string separator = metric->getLabels().empty() ? "" : ",";
+
+                for (double quantile : EXPORTED_QUANTILES) {
+                    out << metric->getName() << "{" << metric->getLabels() << separator
+                        << "quantile=\"" << quantile << "\"} " << histogram->percentile(quantile) << "\n";
+                }
+                out << seriesName(*metric, "_sum") << " " << histogram->sum() << "\n";
+                out << seriesName(*metric, "_count") << " " << histogram->count() << "\n";
+                break;
+            }
+        }
+    }
+
+    return out.str();
+}
+
+std::string MetricsRegistry::renderLabels(const Labels& labels) {
+    std::string rendered;
+
+    for (const auto& [key, value] : labels) {
+        if (!rendered.empty()) {
+            rendered += ",";
+        }
+
+        rendered += key + "=\"";
+        for (char c : value) {
+            if (c == '\\' || c == '"') {
+                rendered += '\\';
+                rendered += c;
+            } else if (c == '\n') {
+                rendered += "\\n";
+            } else {
+                rendered += c;
+            }
+        }
+        rendered += "\"";
+    }
+
+    return rendered;
+}
@@ -0,0 +1,231 @@
+#include "metrics/PerfCounters.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+    struct EventSpec {
+        uint32_t type;
+        uint64_t config;
+    };
+
+    // Indexed by PerfEvent
+    const std::array<EventSpec, PerfReading::EVENT_COUNT> EVENT_SPECS = {{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}
+    }};
+
+    const std::array<const char*, PerfReading::EVENT_COUNT> EVENT_NAMES = {
+        "cycles", "instructions", "llc_misses", "branch_misses"
+    };
+
+    // -1 unknown, 0 refused by the kernel, 1 usable
+    std::atomic<int> processAvailability{-1};
+
+    long openEvent(const EventSpec& spec, int groupFd) {
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = spec.type;
+        attr.config = spec.config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                           PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // pid 0 / cpu -1: the calling thread on whichever CPU it runs
+        return syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+    }
+
+    bool isPermanentFailure(int error) {
+        return error == EACCES || error == EPERM || error == ENOENT || error == ENOSYS || error == EOPNOTSUPP;
+    }
+
+    struct ThreadCounters {
+        bool opened = false;
+        int leaderFd = -1;
+        std::array<int, PerfReading::EVENT_COUNT> fds;
+        std::array<uint64_t, PerfReading::EVENT_COUNT> ids{};
+
+        ThreadCounters() { fds.fill(-1); }
+
+        ~ThreadCounters() {
+            for (int fd : fds) {
+                if (fd >= 0) {
+                    close(fd);
+                }
+            }
+        }
+
+        void open() {
+            opened = true;
+            if (processAvailability.load() == 0) {
+                return;
+            }
+
+            for (size_t i = 0; i < EVENT_SPECS.size(); ++i) {
+                long fd = openEvent(EVENT_SPECS[i], leaderFd);
+                if (fd < 0) {
+                    int error = errno;
+                    if (leaderFd < 0 && i == 0 && isPermanentFailure(error)) {
+                        int expected = -1;
+                        if (processAvailability.compare_exchange_strong(expected, 0)) {
+                            std::cerr << "PerfCounters: perf_event_open unavailable (" << strerror(error)
+                                      << "), reporting wall time only" << std::endl;
+                        }
+                        return;
+                    }
+                    // Single events may be missing on some PMUs, keep the rest
+                    continue;
+                }
+
+                fds[i] = static_cast<int>(fd);
+                ioctl(fds[i], PERF_EVENT_IOC_ID, &ids[i]);
+                if (leaderFd < 0) {
+                    leaderFd = fds[i];
+                }
+            }
+
+            if (leaderFd >= 0) {
+                processAvailability.store(1);
+            }
+        }
+
+        PerfReading read() {
+            PerfReading reading;
+            if (!opened) {
+                open();
+            }
+            if (leaderFd < 0) {
+                return reading;
+            }
+
+            // nr, time_enabled, time_running, then {value, id} per event
+            uint64_t buffer[3 + 2 * PerfReading::EVENT_COUNT];
+            ssize_t bytes = ::read(leaderFd, buffer, sizeof(buffer));
+            if (bytes < static_cast<ssize_t>(3 * sizeof(uint64_t))) {
+                return reading;
+            }
+
+            uint64_t count = std::min<uint64_t>(buffer[0], PerfReading::EVENT_COUNT);
+            reading.timeEnabled = buffer[1];
+            reading.timeRunning = buffer[2];
+
+            for (uint64_t entry = 0; entry < count; ++entry) {
+                uint64_t value = buffer[3 + 2 * entry];
+                uint64_t id = buffer[4 + 2 * entry];
+                for (size_t i = 0; i < ids.size(); ++i) {
+                    if (fds[i] >= 0 && ids[i] == id) {
+                        reading.values[i] = value;
+                        reading.present[i] = true;
+                        break;
+                    }
+                }
+            }
+
+            reading.valid = true;
+            return reading;
+        }
+    };
+
+    ThreadCounters& threadCounters() {
+        thread_local ThreadCounters counters;
+        return counters;
+    }
+}
+
+PerfReading PerfCounters::read() {
+    return threadCounters().read();
+}
+
+bool PerfCounters::isAvailable() {
+    ThreadCounters& counters = threadCounters();
+    if (!counters.opened) {
+        counters.open();
+    }
+    return counters.leaderFd >= 0;
+}
+
+uint64_t PerfCounters::delta(const PerfReading& start, const PerfReading& end, PerfEvent event) {
+    size_t index = static_cast<size_t>(event);
+    if (!start.valid || !end.valid || !start.present[index] || !end.present[index]) {
+        return 0;
+    }
+    if (end.values[index] < start.values[index]) {
+        return 0;
+    }
+
+    uint64_t raw = end.values[index] - start.values[index];
+    uint64_t enabled = end.timeEnabled - start.timeEnabled;
+    uint64_t running = end.timeRunning - start.timeRunning;
+
+    // The group shared the PMU with other users for part of the window
+    if (running > 0 && running < enabled) {
+        return static_cast<uint64_t>(static_cast<double>(raw) * enabled / running);
+    }
+    return raw;
+}
+
+const char* PerfCounters::eventName(PerfEvent event) {
+    return EVENT_NAMES[static_cast<size_t>(event)];
+}
+
+// --- PerfPhase ---
+
+PerfPhase::PerfPhase(MetricsRegistry* metrics, const std::string& phase) : duration(nullptr) {
+    events.fill(nullptr);
+    if (!metrics) {
+        return;
+    }
+
+    MetricsRegistry::Labels labels = {{"phase", phase}};
+    duration = &metrics->histogram("planner_phase_duration_us", labels, "Wall time per instrumented phase");
+
+    for (size_t i = 0; i < events.size(); ++i) {
+        std::string name = std::string("planner_phase_") + EVENT_NAMES[i] + "_total";
+        events[i] = &metrics->counter(name, labels, "Hardware events counted in user space per phase");
+    }
+}
+
+void PerfPhase::record(const PerfReading& start, const PerfReading& end, uint64_t elapsedMicros) const {
+    if (!duration) {
+        return;
+    }
+
+    duration->record(elapsedMicros);
+
+    if (!start.valid || !end.valid) {
+        return;
+    }
+    for (size_t i = 0; i < events.size(); ++i) {
+        uint64_t count = PerfCounters::delta(start, end, static_cast<PerfEvent>(i));
+        if (count > 0) {
+            events[i]->increment(count);
+        }
+    }
+}
+
+// --- PerfScope ---
+
+PerfScope::PerfScope(const PerfPhase& phase)
+    : phase(phase), startTime(std::chrono::steady_clock::now()), startReading(PerfCounters::read()) {
+}
+
+PerfScope::PerfScope(MetricsRegistry* metrics, const std::string& phase)
+    : PerfScope(PerfPhase(metrics, phase)) {
+}
+
+PerfScope::~PerfScope() {
+    PerfReading endReading = PerfCounters::read();
+    auto elapsed = std::chrono::steady_clock::now() - startTime;
+    phase.record(startReading, endReading, static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+}
@@ -0,0 +1,291 @@
+#include "metrics/SamplingProfiler.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <sys/time.h>
+#include <ucontext.h>
+#include <unordered_map>
+
+namespace {
+    // Signal dispositions are process wide, so is the active session
+    std::atomic<SamplingProfiler*> activeProfiler{nullptr};
+    struct sigaction previousAction;
+
+    // Walks stop at a frame record this far above the signal handler's own frame
+    constexpr uintptr_t MAX_STACK_BYTES = 8 << 20;
+
+    // Program counter and frame pointer of the interrupted code, or 0 where the layout is unknown
+    void interruptedFrame(void* context, uintptr_t& pc, uintptr_t& fp) {
+        const ucontext_t* uc = static_cast<const ucontext_t*>(context);
+#if defined(__x86_64__)
+        pc = static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_RIP]);
+        fp = static_cast<uintptr_t>(uc->uc_mcontext.gregs[REG_RBP]);
+#elif defined(__aarch64__)
+        pc = static_cast<uintptr_t>(uc->uc_mcontext.pc);
+        fp = static_cast<uintptr_t>(uc->uc_mcontext.regs[29]);
+#else
+        (void)uc;
+        pc = 0;
+        fp = 0;
+#endif
+    }
+
+    std::string symbolize(void* address) {
+        Dl_info info;
+        if (dladdr(address, &info) && info.dli_sname) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            std::string name = (status == 0 && demangled) ? demangled : info.dli_sname;
+            std::free(demangled);
+            return name;
+        }
+
+        std::ostringstream fallback;
+        if (dladdr(address, &info) && info.dli_fname) {
+            const char* module = std::strrchr(info.dli_fname, '/');
+            fallback << (module ? module + 1 : info.dli_fname) << "+";
+            fallback << std::hex << "0x" << (reinterpret_cast<uintptr_t>(address) - reinterpret_cast<uintptr_t>(info.dli_fbase));
+        } else {
+            fallback << address;
+        }
+        return fallback.str();
+    }
+
+    // Folded format uses ';' as frame separator and ' ' before the count
+    std::string sanitizeFrame(std::string name) {
+        std::replace(name.begin(), name.end(), ';', ':');
+        std::replace(name.begin(), name.end(), '\n', ' ');
+        return name;
+    }
+}
+
+json ProfileResult::toJson() const {
+    return {
+        {"format", "folded"},
+        {"samples", samples},
+        {"dropped_samples", droppedSamples},
+        {"frequency_hz", frequencyHz},
+        {"duration_seconds", durationSeconds},
+        {"folded", folded}
+    };
+}
+
+SamplingProfiler::SamplingProfiler()
+    : sampleCount(0), droppedSamples(0), handlersInFlight(0), running(false), stopRequested(false),
+      frequencyHz(DEFAULT_FREQUENCY_HZ) {
+}
+
+SamplingProfiler::~SamplingProfiler() {
+    stop();
+    if (controllerThread.joinable()) {
+        controllerThread.join();
+    }
+}
+
+bool SamplingProfiler::start(int seconds, int frequencyHz, CompletionCallback completionCb) {
+    if (running.load()) {
+        return false;
+    }
+
+    SamplingProfiler* expected = nullptr;
+    if (!activeProfiler.compare_exchange_strong(expected, this)) {
+        std::cerr << "SamplingProfiler: Another session is already active in this process" << std::endl;
+        return false;
+    }
+
+    if (controllerThread.joinable()) {
+        controllerThread.join();
+    }
+
+    seconds = std::clamp(seconds, 1, MAX_DURATION_SECONDS);
+    this->frequencyHz = std::clamp(frequencyHz, 1, MAX_FREQUENCY_HZ);
+    this->completionCallback = completionCb;
+
+    // Everything the signal handler touches is allocated up front
+    samples = std::make_unique<Sample[]>(MAX_SAMPLES);
+    sampleCount.store(0);
+    droppedSamples.store(0);
+    stopRequested = false;
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_sigaction = &SamplingProfiler::handleSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+
+    if (sigaction(SIGPROF, &action, &previousAction) != 0) {
+        std::cerr << "SamplingProfiler: Failed to install SIGPROF handler: " << strerror(errno) << std::endl;
+        activeProfiler.store(nullptr);
+        samples.reset();
+        return false;
+    }
+
+    // tv_usec must stay below one second, so 1 Hz is {1, 0}
+    long periodMicros = 1000000L / this->frequencyHz;
+    struct itimerval timer;
+    timer.it_interval.tv_sec = periodMicros / 1000000L;
+    timer.it_interval.tv_usec = periodMicros % 1000000L;
+    timer.it_value = timer.it_interval;
+
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+        std::cerr << "SamplingProfiler: Failed to arm ITIMER_PROF: " << strerror(errno) << std::endl;
+        sigaction(SIGPROF, &previousAction, nullptr);
+        activeProfiler.store(nullptr);
+        samples.reset();
+        return false;
+    }
+
+    running.store(true);
+    startTime = std::chrono::steady_clock::now();
+    controllerThread = std::thread(&SamplingProfiler::runSession, this, seconds);
+
+    std::cout << "SamplingProfiler: Started for " << seconds << "s at " << this->frequencyHz << " Hz" << std::endl;
+    return true;
+}
+
+void SamplingProfiler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        stopRequested = true;
+    }
+    stopCondition.notify_all();
+}
+
+bool SamplingProfiler::isRunning() const {
+    return running.load();
+}
+
+void SamplingProfiler::runSession(int seconds) {
+    {
+        std::unique_lock<std::mutex> lock(stopMutex);
+        stopCondition.wait_for(lock, std::chrono::seconds(seconds), [this] { return stopRequested; });
+    }
+
+    // Disarm first, then wait for handlers already running on other threads
+    struct itimerval disarmed;
+    std::memset(&disarmed, 0, sizeof(disarmed));
+    setitimer(ITIMER_PROF, &disarmed, nullptr);
+
+    activeProfiler.store(nullptr);
+    while (handlersInFlight.load() > 0) {
+        std::this_thread::yield();
+    }
+    sigaction(SIGPROF, &previousAction, nullptr);
+
+    ProfileResult result = buildResult();
+    samples.reset();
+    running.store(false);
+
+    std::cout << "SamplingProfiler: Collected " << result.samples << " samples ("
+              << result.droppedSamples << " dropped)" << std::endl;
+
+    if (completionCallback) {
+        try {
+            completionCallback(result);
+        } catch (const std::exception& e) {
+            std::cerr << "SamplingProfiler: Exception in completion callback: " << e.what() << std::endl;
+        }
+    }
+}
+
+void SamplingProfiler::handleSignal(int, siginfo_t*, void* context) {
+    int savedErrno = errno;
+
+    SamplingProfiler* profiler = activeProfiler.load();
+    if (profiler != nullptr) {
+        profiler->handlersInFlight.fetch_add(1);
+        // Re-check: the session may have ended between the load and the increment
+        if (activeProfiler.load() == profiler) {
+            profiler->recordSample(context);
+        }
+        profiler->handlersInFlight.fetch_sub(1);
+    }
+
+    errno = savedErrno;
+}
+
+void SamplingProfiler::recordSample(void* context) {
+    size_t index = sampleCount.fetch_add(1, std::memory_order_relaxed);
+    if (index >= MAX_SAMPLES) {
+        droppedSamples.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Sample& sample = samples[index];
+    sample.depth = 0;
+
+    uintptr_t pc = 0;
+    uintptr_t fp = 0;
+    interruptedFrame(context, pc, fp);
+    if (pc == 0) {
+        return;
+    }
+    sample.frames[sample.depth++] = reinterpret_cast<void*>(pc);
+
+    // backtrace() is not async-signal-safe, so follow the frame pointer chain by hand. The handler runs on
+    // the interrupted stack, so every record of that stack lies above this frame; each record is
+    // {previous record, return address} and must lie above the one before it
+    uintptr_t low = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+    uintptr_t previous = low;
+    while (sample.depth < MAX_STACK_DEPTH) {
+        if (fp <= previous || fp - low > MAX_STACK_BYTES || fp % sizeof(uintptr_t) != 0) {
+            break;
+        }
+        const uintptr_t* record = reinterpret_cast<const uintptr_t*>(fp);
+        uintptr_t returnAddress = record[1];
+        if (returnAddress == 0) {
+            break;
+        }
+        sample.frames[sample.depth++] = reinterpret_cast<void*>(returnAddress);
+        previous = fp;
+        fp = record[0];
+    }
+}
+
+ProfileResult SamplingProfiler::buildResult() const {
+    ProfileResult result;
+    result.frequencyHz = frequencyHz;
+    result.durationSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    result.droppedSamples = droppedSamples.load();
+
+    size_t recorded = std::min(sampleCount.load(), MAX_SAMPLES);
+    result.samples = recorded;
+
+    std::unordered_map<void*, std::string> symbols;
+    std::map<std::string, uint64_t> stacks;
+
+    for (size_t i = 0; i < recorded; ++i) {
+        const Sample& sample = samples[i];
+        std::string stack;
+
+        // Samples list the leaf first, folded stacks start at the root
+        for (int frame = sample.depth - 1; frame >= 0; --frame) {
+            void* address = sample.frames[frame];
+            auto it = symbols.find(address);
+            if (it == symbols.end()) {
+                it = symbols.emplace(address, sanitizeFrame(symbolize(address))).first;
+            }
+
+            if (!stack.empty()) {
+                stack += ';';
+            }
+            stack += it->second;
+        }
+
+        if (!stack.empty()) {
+            ++stacks[stack];
+        }
+    }
+
+    std::ostringstream folded;
+    for (const auto& [stack, count] : stacks) {
+        folded << stack << " " << count << "\n";
+    }
+    result.folded = folded.str();
+
+    return result;
+}
@@ -0,0 +1,204 @@
+#include "metrics/TelemetrySampler.hpp"
+#include <ctime>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+
+namespace {
+    // Reads "Key:   123 kB" style fields from /proc/self/status
+    void readProcStatus(ProcessTelemetry& sample) {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+
+        while (std::getline(status, line)) {
+            std::istringstream fields(line);
+            std::string key;
+            int64_t value = 0;
+            fields >> key >> value;
+
+            if (key == "VmRSS:") {
+                sample.residentBytes = value * 1024;
+            } else if (key == "VmHWM:") {
+                sample.peakResidentBytes = value * 1024;
+            } else if (key == "VmSize:") {
+                sample.virtualBytes = value * 1024;
+            } else if (key == "Threads:") {
+                sample.threadCount = value;
+            }
+        }
+    }
+
+    int64_t countOpenFileDescriptors() {
+        DIR* directory = opendir("/proc/self/fd");
+        if (directory == nullptr) {
+            return -1;
+        }
+
+        int64_t count = 0;
+        while (struct dirent* entry = readdir(directory)) {
+            if (entry->d_name[0] != '.') {
+                ++count;
+            }
+        }
+        closedir(directory);
+
+        // The descriptor opendir itself holds is not interesting
+        return count - 1;
+    }
+
+    double toSeconds(const struct timeval& time) {
+        return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_usec) / 1e6;
+    }
+}
+
+json ProcessTelemetry::toJson() const {
+    return {
+        {"sampled_at", sampledAt},
+        {"memory", {
+            {"rss_bytes", residentBytes},
+            {"peak_rss_bytes", peakResidentBytes},
+            {"virtual_bytes", virtualBytes}
+        }},
+        {"cpu", {
+            {"user_seconds", userCpuSeconds},
+            {"system_seconds", systemCpuSeconds},
+            {"percent", cpuPercent}
+        }},
+        {"context_switches", {
+            {"voluntary", voluntaryContextSwitches},
+            {"involuntary", involuntaryContextSwitches}
+        }},
+        {"threads", threadCount},
+        {"open_fds", openFileDescriptors},
+        {"queues", {
+            {"receive_depth", receiveQueueDepth},
+            {"send_depth", sendQueueDepth}
+        }},
+        {"reassembly", {
+            {"pending_bytes", reassemblyBytes},
+            {"incomplete_messages", incompleteMessages}
+        }}
+    };
+}
+
+TelemetrySampler::TelemetrySampler(MetricsRegistry& metrics, std::chrono::milliseconds interval)
+    : metrics(metrics), interval(interval), running(false),
+      latest(std::make_shared<const ProcessTelemetry>()),
+      lastCpuSeconds(0.0), lastSampleTime(std::chrono::steady_clock::now()) {
+}
+
+TelemetrySampler::~TelemetrySampler() {
+    stop();
+}
+
+void TelemetrySampler::start() {
+    if (running.load()) {
+        return;
+    }
+
+    // Publish a first sample synchronously so readers never see an empty one
+    ProcessTelemetry sample = takeSample();
+    publishGauges(sample);
+    std::atomic_store(&latest, std::shared_ptr<const ProcessTelemetry>(std::make_shared<ProcessTelemetry>(sample)));
+
+    running.store(true);
+    samplerThread = std::thread(&TelemetrySampler::sampleLoop, this);
+}
+
+void TelemetrySampler::stop() {
+    if (!running.load()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        running.store(false);
+    }
+    wakeCondition.notify_all();
+
+    if (samplerThread.joinable()) {
+        samplerThread.join();
+    }
+}
+
+std::shared_ptr<const ProcessTelemetry> TelemetrySampler::getLatest() const {
+    return std::atomic_load(&latest);
+}
+
+void TelemetrySampler::sampleLoop() {
+    while (running.load()) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.wait_for(lock, interval, [this] { return !running.load(); });
+        }
+
+        if (!running.load()) {
+            break;
+        }
+
+        try {
+            ProcessTelemetry sample = takeSample();
+            publishGauges(sample);
+            std::atomic_store(&latest, std::shared_ptr<const ProcessTelemetry>(std::make_shared<ProcessTelemetry>(sample)));
+        } catch (const std::exception& e) {
+            std::cerr << "TelemetrySampler: Error taking sample: " << e.what() << std::endl;
+        }
+    }
+}
+
+ProcessTelemetry TelemetrySampler::takeSample() {
+    ProcessTelemetry sample;
+    sample.sampledAt = static_cast<int64_t>(std::time(nullptr));
+
+    readProcStatus(sample);
+    sample.openFileDescriptors = countOpenFileDescriptors();
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        sample.userCpuSeconds = toSeconds(usage.ru_utime);
+        sample.systemCpuSeconds = toSeconds(usage.ru_stime);
+        sample.voluntaryContextSwitches = usage.ru_nvcsw;
+        sample.involuntaryContextSwitches = usage.ru_nivcsw;
+
+        // getrusage reports the peak in kilobytes, prefer it when /proc is missing
+        if (sample.peakResidentBytes == 0) {
+            sample.peakResidentBytes = static_cast<int64_t>(usage.ru_maxrss) * 1024;
+        }
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    double cpuSeconds = sample.userCpuSeconds + sample.systemCpuSeconds;
+    double wallSeconds = std::chrono::duration<double>(now - lastSampleTime).count();
+    if (wallSeconds > 0.0 && lastCpuSeconds > 0.0) {
+        sample.cpuPercent = 100.0 * (cpuSeconds - lastCpuSeconds) / wallSeconds;
+    }
+    lastCpuSeconds = cpuSeconds;
+    lastSampleTime = now;
+
+    // Pipeline gauges are maintained by the network and processing threads
+    sample.receiveQueueDepth = metrics.gauge("planner_receive_queue_depth").value();
+    sample.sendQueueDepth = metrics.gauge("planner_send_queue_depth").value();
+    sample.reassemblyBytes = metrics.gauge("planner_reassembly_bytes").value();
+    sample.incompleteMessages = metrics.gauge("planner_incomplete_messages").value();
+
+    return sample;
+}
+
+void TelemetrySampler::publishGauges(const ProcessTelemetry& sample) {
+    metrics.gauge("process_resident_memory_bytes", {}, "Resident set size").set(sample.residentBytes);
+    metrics.gauge("process_peak_resident_memory_bytes", {}, "Peak resident set size").set(sample.peakResidentBytes);
+    metrics.gauge("process_virtual_memory_bytes", {}, "Virtual memory size").set(sample.virtualBytes);
+    metrics.gauge("process_cpu_user_milliseconds", {}, "User CPU time consumed")
+        .set(static_cast<int64_t>(sample.userCpuSeconds * 1000));
+    metrics.gauge("process_cpu_system_milliseconds", {}, "System CPU time consumed")
+        .set(static_cast<int64_t>(sample.systemCpuSeconds * 1000));
+    metrics.gauge("process_context_switches", {{"kind", "voluntary"}}, "Context switches")
+        .set(sample.voluntaryContextSwitches);
+    metrics.gauge("process_context_switches", {{"kind", "involuntary"}}, "Context switches")
+        .set(sample.involuntaryContextSwitches);
+    metrics.gauge("process_threads", {}, "Number of OS threads").set(sample.threadCount);
+    metrics.gauge("process_open_fds", {}, "Number of open file descriptors").set(sample.openFileDescriptors);
+}
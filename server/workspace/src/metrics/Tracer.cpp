@@ -0,0 +1,195 @@
+#include "metrics/Tracer.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    std::atomic<uint64_t> nextInstanceId{1};
+
+    void copyTruncated(char* destination, size_t capacity, const char* source, size_t length) {
+        size_t count = std::min(length, capacity - 1);
+        std::memcpy(destination, source, count);
+        destination[count] = '\0';
+    }
+}
+
+Tracer::LocalHandle::~LocalHandle() {
+    if (buffer) {
+        buffer->inUse.store(false, std::memory_order_release);
+    }
+}
+
+Tracer::Tracer()
+    : instanceId(nextInstanceId.fetch_add(1)), epoch(Clock::now()), enabled(true), nextThreadId(1) {
+}
+
+Tracer::ThreadBuffer& Tracer::localBuffer() {
+    thread_local LocalHandle handle;
+
+    if (handle.ownerId == instanceId && handle.buffer) {
+        return *handle.buffer;
+    }
+
+    // Slow path, once per thread: adopt a released buffer or create a new one
+    if (handle.buffer) {
+        handle.buffer->inUse.store(false, std::memory_order_release);
+    }
+
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    std::shared_ptr<ThreadBuffer> buffer;
+
+    for (const auto& candidate : buffers) {
+        bool expected = false;
+        if (candidate->inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            buffer = candidate;
+            break;
+        }
+    }
+
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        buffers.push_back(buffer);
+    }
+
+    buffer->threadId = nextThreadId++;
+    handle.ownerId = instanceId;
+    handle.buffer = buffer;
+
+    return *buffer;
+}
+
+int64_t Tracer::toRelativeNs(Clock::time_point time) const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time - epoch).count();
+}
+
+void Tracer::record(const std::string& messageId, const char* name, Clock::time_point start, Clock::time_point end) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    ThreadBuffer& buffer = localBuffer();
+    uint64_t index = buffer.writeIndex.load(std::memory_order_relaxed);
+    Slot& slot = buffer.slots[index % SPANS_PER_THREAD];
+
+    // Seqlock write: odd sequence marks the slot as unstable for readers
+    uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    copyTruncated(slot.span.messageId, TraceSpan::MAX_ID_LENGTH, messageId.data(), messageId.size());
+    copyTruncated(slot.span.name, TraceSpan::MAX_NAME_LENGTH, name, std::strlen(name));
+    slot.span.startNs = toRelativeNs(start);
+    slot.span.endNs = toRelativeNs(end);
+    slot.span.threadId = buffer.threadId;
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    buffer.writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::nameCurrentThread(const std::string& name) {
+    ThreadBuffer& buffer = localBuffer();
+
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    threadNames[buffer.threadId] = name;
+}
+
+std::vector<TraceSpan> Tracer::collect(uint64_t windowMs, const std::string& messageId) const {
+    std::vector<std::shared_ptr<ThreadBuffer>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        snapshot = buffers;
+    }
+
+    int64_t now = toRelativeNs(Clock::now());
+    // Nothing older than the tracer exists, so longer windows are clamped to everything before they can overflow
+    bool everything = windowMs == 0 || windowMs >= static_cast<uint64_t>(now / 1000000);
+    int64_t cutoff = everything ? INT64_MIN : now - static_cast<int64_t>(windowMs) * 1000000;
+
+    std::vector<TraceSpan> spans;
+
+    for (const auto& buffer : snapshot) {
+        uint64_t written = buffer->writeIndex.load(std::memory_order_acquire);
+        uint64_t first = written > SPANS_PER_THREAD ? written - SPANS_PER_THREAD : 0;
+
+        for (uint64_t index = first; index < written; ++index) {
+            const Slot& slot = buffer->slots[index % SPANS_PER_THREAD];
+
+            uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before % 2 != 0) {
+                continue;
+            }
+
+            TraceSpan span;
+            std::memcpy(&span, &slot.span, sizeof(TraceSpan));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.sequence.load(std::memory_order_relaxed) != before) {
+                continue;  // Overwritten while copying
+            }
+
+            if (span.endNs < cutoff) {
+                continue;
+            }
+            if (!messageId.empty() && messageId != span.messageId) {
+                continue;
+            }
+
+            spans.push_back(span);
+        }
+    }
+
+    std::sort(spans.begin(), spans.end(), [](const TraceSpan& a, const TraceSpan& b) {
+        return a.startNs < b.startNs;
+    });
+
+    return spans;
+}
+
+json Tracer::exportChromeTrace(uint64_t windowMs, const std::string& messageId) const {
+    std::vector<TraceSpan> spans = collect(windowMs, messageId);
+
+    json events = json::array();
+
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (const auto& [threadId, name] : threadNames) {
+            events.push_back({
+                {"name", "thread_name"},
+                {"ph", "M"},
+                {"pid", 1},
+                {"tid", threadId},
+                {"args", {{"name", name}}}
+            });
+        }
+    }
+
+    for (const auto& span : spans) {
+        // Chrome trace timestamps are microseconds
+        events.push_back({
+            {"name", span.name},
+            {"cat", "pipeline"},
+            {"ph", "X"},
+            {"ts", span.startNs / 1000.0},
+            {"dur", std::max<int64_t>(0, span.endNs - span.startNs) / 1000.0},
+            {"pid", 1},
+            {"tid", span.threadId},
+            {"args", {{"messageId", span.messageId}}}
+        });
+    }
+
+    return {
+        {"traceEvents", events},
+        {"displayTimeUnit", "ms"}
+    };
+}
+
+// --- TraceScope ---
+
+TraceScope::TraceScope(Tracer* tracer, const std::string& messageId, const char* name)
+    : tracer(tracer), messageId(messageId), name(name), start(Tracer::Clock::now()) {
+}
+
+TraceScope::~TraceScope() {
+    if (tracer) {
+        tracer->record(messageId, name, start, Tracer::Clock::now());
+    }
+}
@@ -1,6 +1,19 @@
 #include "network/ServerSocket.hpp"
 
-ServerSocket::ServerSocket(int port){
+ServerSocket::ServerSocket(int port, MetricsRegistry* metrics, Tracer* tracer)
+    : framesReceivedTotal(nullptr), bytesReceivedTotal(nullptr), framesSentTotal(nullptr), bytesSentTotal(nullptr),
+      parseErrorsTotal(nullptr), sendQueueDepth(nullptr), receiveQueueDepth(nullptr), tracer(tracer) {
+    // Resolve metrics once so the network threads only touch atomics
+    if (metrics) {
+        framesReceivedTotal = &metrics->counter("planner_frames_received_total", {}, "Frames received from the client");
+        bytesReceivedTotal = &metrics->counter("planner_bytes_received_total", {}, "Bytes received from the client");
+        framesSentTotal = &metrics->counter("planner_frames_sent_total", {}, "Frames sent to the client");
+        bytesSentTotal = &metrics->counter("planner_bytes_sent_total", {}, "Bytes sent to the client");
+        parseErrorsTotal = &metrics->counter("planner_frame_parse_errors_total", {}, "Received frames that could not be parsed");
+        sendQueueDepth = &metrics->gauge("planner_send_queue_depth", {}, "Frames waiting in the send queue");
+        receiveQueueDepth = &metrics->gauge("planner_receive_queue_depth", {}, "Frames waiting for the processing thread");
+    }
+
     // Initialize server socket
     serverSocket = socket(AF_INET, SOCK_STREAM, 0);
     if (serverSocket < 0) {
@@ -91,7 +104,8 @@ bool ServerSocket::sendMessage(const MessageFrame& message){
 
     // Take lock on sendMutex and push message to sendQueue and notify sendThread
     std::lock_guard<std::mutex> lock(sendMutex);
-    sendQueue.push(message);
+    sendQueue.push({message, std::chrono::steady_clock::now()});
+    if (sendQueueDepth) sendQueueDepth->add(1);
     sendCondition.notify_one();
     return true;
 }
@@ -183,7 +197,7 @@ std::condition_variable& ServerSocket::getReceiveCondition() {
     return receiveCondition;
 }
 
-std::queue<MessageFrame>& ServerSocket::getReceiveQueue() {
+std::queue<QueuedFrame>& ServerSocket::getReceiveQueue() {
     return receiveQueue;
 }
 
@@ -196,6 +210,8 @@ void ServerSocket::setOnDisconnectedCallback(std::function<void()> callback){
 }
 
 void ServerSocket::receiveMessages(){
+    if (tracer) tracer->nameCurrentThread("socket.receive");
+
     while (running) {
         
         // Wait for connection to be established
@@ -211,7 +227,8 @@ void ServerSocket::receiveMessages(){
         ssize_t bytesReceived = recv(clientSocket, buffer, sizeof(buffer), 0);
         
         // If not recieved data, and errno indicates EAGAIN or EWOULDBLOCK, continue to next iteration
-        if (bytesReceived < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        // EINTR is transient too, e.g. SIGPROF from the sampling profiler
+        if (bytesReceived < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
             continue; 
         }
@@ -222,6 +239,9 @@ void ServerSocket::receiveMessages(){
             continue;
         }
 
+        auto receivedAt = std::chrono::steady_clock::now();
+        if (bytesReceivedTotal) bytesReceivedTotal->increment(bytesReceived);
+
         // Parse and enqueue received data
         try {
             std::string jsonStr(buffer, bytesReceived);
@@ -229,16 +249,22 @@ void ServerSocket::receiveMessages(){
             MessageFrame message = j.get<MessageFrame>();
             {
                 std::lock_guard<std::mutex> lock(receiveMutex);
-                receiveQueue.push(message);
+                if (tracer) tracer->record(message.header.messageId, "socket.receive", receivedAt, std::chrono::steady_clock::now());
+                receiveQueue.push({std::move(message), receivedAt});
+                if (receiveQueueDepth) receiveQueueDepth->add(1);
             }
+            if (framesReceivedTotal) framesReceivedTotal->increment();
             receiveCondition.notify_one();
         } catch (const std::exception& e) {
+            if (parseErrorsTotal) parseErrorsTotal->increment();
             std::cerr << "Error parsing received message: " << e.what() << std::endl;
         }
     }
 }
 
 void ServerSocket::sendMessages(){
+    if (tracer) tracer->nameCurrentThread("socket.send");
+
     while (running) {
         // Wait for connection to be established
         if (!connected) {
@@ -258,18 +284,23 @@ void ServerSocket::sendMessages(){
         if (!connected) continue;
         
         // Add all messages from sendQueue to a local queue
-        std::queue<MessageFrame> localQueue;
+        std::queue<QueuedFrame> localQueue;
         while (!sendQueue.empty()) {
             localQueue.push(sendQueue.front());
             sendQueue.pop();
         }
+        if (sendQueueDepth) sendQueueDepth->add(-static_cast<int64_t>(localQueue.size()));
         lock.unlock(); // Release lock before processing and sending
         
         // Process and send messages outside of lock
         while (!localQueue.empty()) {
-            MessageFrame message = localQueue.front();
+            MessageFrame message = std::move(localQueue.front().frame);
+            auto queuedAt = localQueue.front().queuedAt;
             localQueue.pop();
 
+            auto sendStart = std::chrono::steady_clock::now();
+            if (tracer) tracer->record(message.header.messageId, "socket.send_queue", queuedAt, sendStart);
+
             try {
                 // Serialize message to JSON
                 json j = message;
@@ -283,6 +314,9 @@ void ServerSocket::sendMessages(){
                 while (totalSent < toSend && running && connected) {
                     ssize_t bytesSent = send(clientSocket, data + totalSent, toSend - totalSent, 0);
                     if (bytesSent < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
                         if (errno == EAGAIN || errno == EWOULDBLOCK) {
                             std::this_thread::sleep_for(std::chrono::milliseconds(10));
                             continue;
@@ -296,6 +330,12 @@ void ServerSocket::sendMessages(){
                     }
                     totalSent += bytesSent;
                 }
+
+                if (totalSent == toSend) {
+                    if (framesSentTotal) framesSentTotal->increment();
+                    if (bytesSentTotal) bytesSentTotal->increment(totalSent);
+                }
+                if (tracer) tracer->record(message.header.messageId, "socket.send", sendStart, std::chrono::steady_clock::now());
             } catch (const std::exception& e) {
                 std::cerr << "Error serializing message: " << e.what() << std::endl;
             }
@@ -0,0 +1,84 @@
+#include "schedule/Assignment.hpp"
+
+namespace {
+    struct EventField {
+        const char* key;
+        const IdTable& (ProblemModel::*table)() const;
+        EntityId Placement::*target;
+    };
+
+    const EventField EVENT_FIELDS[] = {
+        {"subjectId", &ProblemModel::subjectIds, &Placement::subject},
+        {"teacherId", &ProblemModel::teacherIds, &Placement::teacher},
+        {"groupId", &ProblemModel::groupIds, &Placement::group},
+        {"roomId", &ProblemModel::roomIds, &Placement::room},
+        {"timeBlockId", &ProblemModel::timeBlockIds, &Placement::timeBlock}
+    };
+}
+
+Assignment Assignment::fromJson(const ProblemModel& model, const json& schedule, json& errors) {
+    Assignment assignment;
+    errors = json::array();
+
+    const json* events = &schedule;
+    if (schedule.is_object()) {
+        auto it = schedule.find("events");
+        events = it != schedule.end() ? &*it : nullptr;
+    }
+    if (!events || !events->is_array()) {
+        errors.push_back({{"index", nullptr}, {"field", "events"}, {"message", "Schedule has no events array"}});
+        return assignment;
+    }
+
+    assignment.events.reserve(events->size());
+    assignment.eventIds.reserve(events->size());
+    for (size_t i = 0; i < events->size(); ++i) {
+        const json& event = (*events)[i];
+        if (!event.is_object()) {
+            errors.push_back({{"index", i}, {"message", "Event is not an object"}});
+            continue;
+        }
+
+        Placement placement;
+        bool resolved = true;
+        for (const EventField& field : EVENT_FIELDS) {
+            auto value = event.find(field.key);
+            EntityId index = NO_ENTITY;
+            if (value != event.end() && value->is_string()) {
+                index = (model.*field.table)().find(value->get<std::string>());
+            }
+            if (index == NO_ENTITY) {
+                json error = {{"index", i}, {"field", field.key}, {"message", std::string(field.key) + " names no entity"}};
+                if (value != event.end()) {
+                    error["value"] = *value;
+                }
+                errors.push_back(std::move(error));
+                resolved = false;
+                break;
+            }
+            placement.*field.target = index;
+        }
+
+        if (resolved) {
+            assignment.events.push_back(placement);
+            assignment.eventIds.push_back(event.value("id", json(i)));
+        }
+    }
+    return assignment;
+}
+
+json Assignment::toJson(const ProblemModel& model) const {
+    json events = json::array();
+    for (size_t i = 0; i < this->events.size(); ++i) {
+        const Placement& placement = this->events[i];
+        events.push_back({
+            {"id", eventIds[i]},
+            {"subjectId", model.subjectIds().name(placement.subject)},
+            {"teacherId", model.teacherIds().name(placement.teacher)},
+            {"groupId", model.groupIds().name(placement.group)},
+            {"roomId", model.roomIds().name(placement.room)},
+            {"timeBlockId", model.timeBlockIds().name(placement.timeBlock)}
+        });
+    }
+    return {{"events", events}};
+}
@@ -0,0 +1,354 @@
+#include "schedule/BitKernels.hpp"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// AVX2 kernels are built either because the whole build targets AVX2, or per
+// function on x86-64 and picked at runtime when the CPU supports them
+#if defined(__AVX2__)
+#define BIT_KERNELS_AVX2
+#define AVX2_TARGET
+#elif defined(__x86_64__) && defined(__GNUC__)
+#define BIT_KERNELS_AVX2
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+namespace {
+#if defined(BIT_KERNELS_AVX2)
+    constexpr size_t AVX2_WORDS = 4;
+
+#if defined(__AVX2__)
+    constexpr bool hasAvx2 = true;
+#else
+    bool detectAvx2() {
+        // Required before __builtin_cpu_supports when running as a static initializer
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }
+
+    // Read before its initializer has run, it is false and the SSE2 path is taken
+    const bool hasAvx2 = detectAvx2();
+#endif
+
+    AVX2_TARGET inline __m256i load256(const uint64_t* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    AVX2_TARGET inline void store256(uint64_t* p, __m256i v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+
+    // Per-64-bit-lane popcount of v, via a 4-bit lookup table
+    AVX2_TARGET inline __m256i popcountLanes256(__m256i v) {
+        const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i lowNibble = _mm256_set1_epi8(0x0f);
+        __m256i low = _mm256_and_si256(v, lowNibble);
+        __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibble);
+        __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+        return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+    }
+
+    AVX2_TARGET inline size_t sumLanes256(__m256i v) {
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+        return static_cast<size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    }
+
+    // Each AVX2 kernel handles whole 256-bit blocks and returns the word index it stopped at;
+    // the caller finishes the remaining words with the SSE2 and scalar loops
+
+    AVX2_TARGET size_t andAssignAvx2(uint64_t* out, const uint64_t* a, size_t words) {
+        size_t i = 0;
+        for (; i + AVX2_WORDS <= words; i += AVX2_WORDS) {
+            store256(out + i, _mm256_and_si256(load256(out + i), load256(a + i)));
+        }
+        return i;
+    }
+
+    AVX2_TARGET size_t orAssignAvx2(uint64_t* out, const uint64_t* a, size_t words) {
+        size_t i = 0;
+        for (; i + AVX2_WORDS <= words; i += AVX2_WORDS) {
+            store256(out + i, _mm256_or_si256(load256(out + i), load256(a + i)));
+        }
+        return i;
+    }
+
+    AVX2_TARGET size_t andNotAssignAvx2(uint64_t* out, const uint64_t* a, size_t words) {
+        size_t i = 0;
+        for (; i + AVX2_WORDS <= words; i += AVX2_WORDS) {
+            // andnot computes ~first & second
+            store256(out + i, _mm256_andnot_si256(load256(a + i), load256(out + i)));
+        }
+        return i;
+    }
+
+    AVX2_TARGET size_t andIntoAvx2(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t words) {
+        size_t i = 0;
+        for (; i + AVX2_WORDS <= words; i += AVX2_WORDS) {
+            store256(out + i, _mm256_and_si256(load256(a + i), load256(b + i)));
+        }
+        return i;
+    }
+
+    AVX2_TARGET size_t popcountAvx2(const uint64_t* a, size_t words, size_t& count) {
+        size_t i = 0;
+        __m256i sums = _mm256_setzero_si256();
+        for (; i + AVX2_WORDS <= words; i += AVX2_WORDS) {
+            sums = _mm256_add_epi64(sums, popcountLanes256(load256(a + i)));
+        }
+        count += sumLanes256(sums);
+        return i;
+    }
+
+    AVX2_TARGET size_t andPopcountAvx2(const uint64_t* a, const uint64_t* b, size_t words, size_t& count) {
+        size_t i = 0;
+        __m256i sums = _mm256_setzero_si256();
+        for (; i + AVX2_WORDS <= words; i += AVX2_WORDS) {
+            sums = _mm256_add_epi64(sums, popcountLanes256(_mm256_and_si256(load256(a + i), load256(b + i))));
+        }
+        count += sumLanes256(sums);
+        return i;
+    }
+
+    // Stops at the first block with a bit set in a & b
+    AVX2_TARGET size_t skipDisjointAvx2(const uint64_t* a, const uint64_t* b, size_t words) {
+        size_t i = 0;
+        for (; i + AVX2_WORDS <= words; i += AVX2_WORDS) {
+            if (!_mm256_testz_si256(load256(a + i), load256(b + i))) {
+                break;
+            }
+        }
+        return i;
+    }
+
+    // Stops at the first block with a bit set
+    AVX2_TARGET size_t skipEmptyAvx2(const uint64_t* a, size_t words) {
+        size_t i = 0;
+        for (; i + AVX2_WORDS <= words; i += AVX2_WORDS) {
+            __m256i v = load256(a + i);
+            if (!_mm256_testz_si256(v, v)) {
+                break;
+            }
+        }
+        return i;
+    }
+#endif
+
+#if defined(__SSE2__)
+    constexpr size_t SSE2_WORDS = 2;
+
+    inline __m128i load(const uint64_t* p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    }
+
+    inline void store(uint64_t* p, __m128i v) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+    }
+
+    inline bool isZero(__m128i v) {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xFFFF;
+    }
+
+    // Per-64-bit-lane popcount of v; SSE2 has no byte shuffle, so bits are summed in place (SWAR)
+    inline __m128i popcountLanes(__m128i v) {
+        const __m128i m1 = _mm_set1_epi8(0x55);
+        const __m128i m2 = _mm_set1_epi8(0x33);
+        const __m128i m4 = _mm_set1_epi8(0x0f);
+        v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi16(v, 1), m1));
+        v = _mm_add_epi8(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi16(v, 2), m2));
+        v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi16(v, 4)), m4);
+        return _mm_sad_epu8(v, _mm_setzero_si128());
+    }
+
+    inline size_t sumLanes(__m128i v) {
+        alignas(16) uint64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+        return static_cast<size_t>(lanes[0] + lanes[1]);
+    }
+#endif
+
+    inline size_t lowestBit(uint64_t word) {
+        return static_cast<size_t>(__builtin_ctzll(word));
+    }
+}
+
+void BitKernels::andAssign(uint64_t* out, const uint64_t* a, size_t words) {
+    size_t i = 0;
+#if defined(BIT_KERNELS_AVX2)
+    if (hasAvx2) {
+        i = andAssignAvx2(out, a, words);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + SSE2_WORDS <= words; i += SSE2_WORDS) {
+        store(out + i, _mm_and_si128(load(out + i), load(a + i)));
+    }
+#endif
+    for (; i < words; ++i) {
+        out[i] &= a[i];
+    }
+}
+
+void BitKernels::orAssign(uint64_t* out, const uint64_t* a, size_t words) {
+    size_t i = 0;
+#if defined(BIT_KERNELS_AVX2)
+    if (hasAvx2) {
+        i = orAssignAvx2(out, a, words);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + SSE2_WORDS <= words; i += SSE2_WORDS) {
+        store(out + i, _mm_or_si128(load(out + i), load(a + i)));
+    }
+#endif
+    for (; i < words; ++i) {
+        out[i] |= a[i];
+    }
+}
+
+void BitKernels::andNotAssign(uint64_t* out, const uint64_t* a, size_t words) {
+    size_t i = 0;
+#if defined(BIT_KERNELS_AVX2)
+    if (hasAvx2) {
+        i = andNotAssignAvx2(out, a, words);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + SSE2_WORDS <= words; i += SSE2_WORDS) {
+        // andnot computes ~first & second
+        store(out + i, _mm_andnot_si128(load(a + i), load(out + i)));
+    }
+#endif
+    for (; i < words; ++i) {
+        out[i] &= ~a[i];
+    }
+}
+
+void BitKernels::andInto(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t words) {
+    size_t i = 0;
+#if defined(BIT_KERNELS_AVX2)
+    if (hasAvx2) {
+        i = andIntoAvx2(out, a, b, words);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + SSE2_WORDS <= words; i += SSE2_WORDS) {
+        store(out + i, _mm_and_si128(load(a + i), load(b + i)));
+    }
+#endif
+    for (; i < words; ++i) {
+        out[i] = a[i] & b[i];
+    }
+}
+
+size_t BitKernels::popcount(const uint64_t* a, size_t words) {
+    size_t count = 0;
+    size_t i = 0;
+#if defined(BIT_KERNELS_AVX2)
+    if (hasAvx2) {
+        i = popcountAvx2(a, words, count);
+    }
+#endif
+#if defined(__SSE2__)
+    __m128i sums = _mm_setzero_si128();
+    for (; i + SSE2_WORDS <= words; i += SSE2_WORDS) {
+        sums = _mm_add_epi64(sums, popcountLanes(load(a + i)));
+    }
+    count += sumLanes(sums);
+#endif
+    for (; i < words; ++i) {
+        count += static_cast<size_t>(__builtin_popcountll(a[i]));
+    }
+    return count;
+}
+
+size_t BitKernels::andPopcount(const uint64_t* a, const uint64_t* b, size_t words) {
+    size_t count = 0;
+    size_t i = 0;
+#if defined(BIT_KERNELS_AVX2)
+    if (hasAvx2) {
+        i = andPopcountAvx2(a, b, words, count);
+    }
+#endif
+#if defined(__SSE2__)
+    __m128i sums = _mm_setzero_si128();
+    for (; i + SSE2_WORDS <= words; i += SSE2_WORDS) {
+        sums = _mm_add_epi64(sums, popcountLanes(_mm_and_si128(load(a + i), load(b + i))));
+    }
+    count += sumLanes(sums);
+#endif
+    for (; i < words; ++i) {
+        count += static_cast<size_t>(__builtin_popcountll(a[i] & b[i]));
+    }
+    return count;
+}
+
+bool BitKernels::intersects(const uint64_t* a, const uint64_t* b, size_t words) {
+    size_t i = 0;
+#if defined(BIT_KERNELS_AVX2)
+    if (hasAvx2) {
+        i = skipDisjointAvx2(a, b, words);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + SSE2_WORDS <= words; i += SSE2_WORDS) {
+        if (!isZero(_mm_and_si128(load(a + i), load(b + i)))) {
+            return true;
+        }
+    }
+#endif
+    for (; i < words; ++i) {
+        if (a[i] & b[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t BitKernels::firstSet(const uint64_t* a, size_t words) {
+    size_t i = 0;
+#if defined(BIT_KERNELS_AVX2)
+    if (hasAvx2) {
+        i = skipEmptyAvx2(a, words);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + SSE2_WORDS <= words; i += SSE2_WORDS) {
+        if (!isZero(load(a + i))) {
+            break;
+        }
+    }
+#endif
+    // The vector loops only skip empty blocks; the set word is found here
+    for (; i < words; ++i) {
+        if (a[i]) {
+            return i * 64 + lowestBit(a[i]);
+        }
+    }
+    return NPOS;
+}
+
+size_t BitKernels::firstSetAnd(const uint64_t* a, const uint64_t* b, size_t words) {
+    size_t i = 0;
+#if defined(BIT_KERNELS_AVX2)
+    if (hasAvx2) {
+        i = skipDisjointAvx2(a, b, words);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + SSE2_WORDS <= words; i += SSE2_WORDS) {
+        if (!isZero(_mm_and_si128(load(a + i), load(b + i)))) {
+            break;
+        }
+    }
+#endif
+    for (; i < words; ++i) {
+        uint64_t both = a[i] & b[i];
+        if (both) {
+            return i * 64 + lowestBit(both);
+        }
+    }
+    return NPOS;
+}
@@ -0,0 +1,50 @@
+#include "schedule/BitMatrix.hpp"
+
+BitMatrix::BitMatrix(size_t rows, size_t columns, bool value)
+    : rowCount(rows), columnCount(columns), wordsPerRow(wordsFor(columns)), bits(rows * wordsPerRow, 0) {
+    if (value) {
+        for (size_t r = 0; r < rows; ++r) {
+            fillRow(r);
+        }
+    }
+}
+
+size_t BitMatrix::wordsFor(size_t columns) {
+    size_t words = (columns + WORD_BITS - 1) / WORD_BITS;
+    return (words + ROW_ALIGN_WORDS - 1) / ROW_ALIGN_WORDS * ROW_ALIGN_WORDS;
+}
+
+void BitMatrix::fillRow(size_t r) {
+    uint64_t* words = row(r);
+    size_t full = columnCount / WORD_BITS;
+    for (size_t i = 0; i < full; ++i) {
+        words[i] = ~uint64_t(0);
+    }
+    if (columnCount % WORD_BITS) {
+        words[full] = (uint64_t(1) << (columnCount % WORD_BITS)) - 1;
+    }
+}
+
+BitMatrix BitMatrix::transposed() const {
+    BitMatrix result(columnCount, rowCount);
+    for (size_t r = 0; r < rowCount; ++r) {
+        const uint64_t* words = row(r);
+        for (size_t w = 0; w < wordsPerRow; ++w) {
+            for (uint64_t word = words[w]; word; word &= word - 1) {
+                result.set(w * WORD_BITS + static_cast<size_t>(__builtin_ctzll(word)), r);
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<uint32_t> BitMatrix::columnsOf(size_t r) const {
+    std::vector<uint32_t> result;
+    const uint64_t* words = row(r);
+    for (size_t w = 0; w < wordsPerRow; ++w) {
+        for (uint64_t word = words[w]; word; word &= word - 1) {
+            result.push_back(static_cast<uint32_t>(w * WORD_BITS + static_cast<size_t>(__builtin_ctzll(word))));
+        }
+    }
+    return result;
+}
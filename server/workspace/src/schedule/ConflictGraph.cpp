@@ -0,0 +1,323 @@
+#include "schedule/ConflictGraph.hpp"
+#include "schedule/BitKernels.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+/**
+ * @brief Builds a ConflictGraph; one instance per build
+ */
+class ConflictGraphBuilder {
+public:
+    ConflictGraphBuilder(const ProblemModel& model, const LessonDemand& demand, const LessonDomains& domains,
+                         ConflictGraph& graph)
+        : model(model), demand(demand), domains(domains), graph(graph) {
+    }
+
+    void run() {
+        numberLessons();
+        collectCliques();
+
+        size_t lessons = graph.lessons();
+        size_t threads = 1;
+        if (lessons >= ConflictGraph::PARALLEL_THRESHOLD) {
+            threads = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, ConflictGraph::MAX_THREADS);
+        }
+        graph.threadCount = threads;
+        rangeSize = std::max<size_t>(1, (lessons + threads - 1) / threads);
+        buckets.assign(threads, std::vector<std::vector<uint64_t>>(threads));
+        sorted.resize(threads);
+
+        parallel(threads, [this](size_t worker) { emit(worker); });
+        parallel(threads, [this](size_t range) { sortRange(range); });
+        assemble(threads);
+        orderByDegree();
+    }
+
+private:
+    struct Clique {
+        uint32_t begin;  // Range in cliqueRequirements
+        uint32_t end;
+        uint64_t lessons;
+        bool group;      // Parallel sections of a split may share blocks
+    };
+
+    const ProblemModel& model;
+    const LessonDemand& demand;
+    const LessonDomains& domains;
+    ConflictGraph& graph;
+
+    std::vector<Clique> cliques;
+    std::vector<uint32_t> cliqueRequirements;
+    std::atomic<size_t> nextClique{0};
+    size_t rangeSize = 1;
+    std::vector<std::vector<std::vector<uint64_t>>> buckets;  // [worker][range], pairs as source << 32 | target
+    std::vector<std::vector<uint64_t>> sorted;                // Per range, deduplicated
+
+    template <typename Work>
+    static void parallel(size_t threads, Work work) {
+        if (threads == 1) {
+            work(0);
+            return;
+        }
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([&work, i]() { work(i); });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void numberLessons() {
+        const auto& requirements = demand.requirements();
+        graph.requirementLessons.resize(requirements.size() + 1);
+        graph.requirementIndex.reserve(demand.totalLessons());
+        graph.splitOf.resize(requirements.size());
+        for (size_t r = 0; r < requirements.size(); ++r) {
+            // Sections of one parallel split were expanded in a row, from the same first requirement
+            graph.splitOf[r] = requirements[r].parallel ? static_cast<uint32_t>(r - requirements[r].section)
+                                                        : ConflictGraph::NO_SPLIT;
+            graph.requirementLessons[r] = static_cast<EntityId>(graph.requirementIndex.size());
+            graph.requirementIndex.insert(graph.requirementIndex.end(), requirements[r].lessons,
+                                          static_cast<uint32_t>(r));
+        }
+        graph.requirementLessons.back() = static_cast<EntityId>(graph.requirementIndex.size());
+    }
+
+    void collectCliques() {
+        const auto& requirements = demand.requirements();
+        size_t groupCount = model.groups().size();
+
+        // The chain of a group without descendants holds the chain of every group above it
+        std::vector<std::vector<uint32_t>> byGroup(groupCount);
+        for (size_t r = 0; r < requirements.size(); ++r) {
+            byGroup[requirements[r].group].push_back(static_cast<uint32_t>(r));
+        }
+        const BitMatrix& descendants = model.groupDescendants();
+        for (EntityId g = 0; g < groupCount; ++g) {
+            if (BitKernels::popcount(descendants.row(g), descendants.rowWords()) != 0) {
+                continue;
+            }
+            uint32_t begin = static_cast<uint32_t>(cliqueRequirements.size());
+            cliqueRequirements.insert(cliqueRequirements.end(), byGroup[g].begin(), byGroup[g].end());
+            for (uint32_t a : model.groupAncestors().columnsOf(g)) {
+                cliqueRequirements.insert(cliqueRequirements.end(), byGroup[a].begin(), byGroup[a].end());
+            }
+            addClique(begin, true);
+        }
+
+        addFixedCliques(domains.teachers(), model.teachers().size());
+        addFixedCliques(domains.rooms(), model.rooms().size());
+        admitWithinBudget();
+        graph.cliqueCount = cliques.size();
+    }
+
+    // A few huge cliques (one teacher for a whole school) would outweigh all others together; expanding
+    // the small ones first keeps the most edges for the memory, the rest are walked on demand
+    void admitWithinBudget() {
+        std::stable_sort(cliques.begin(), cliques.end(), [](const Clique& a, const Clique& b) {
+            return a.lessons < b.lessons;
+        });
+        uint64_t pairs = 0;
+        size_t admitted = 0;
+        while (admitted < cliques.size()) {
+            uint64_t lessons = cliques[admitted].lessons;
+            if (pairs + lessons * (lessons - 1) > ConflictGraph::MAX_PAIRS) {
+                break;
+            }
+            pairs += lessons * (lessons - 1);
+            ++admitted;
+        }
+        keepImplicit(admitted);
+        cliques.resize(admitted);
+    }
+
+    void keepImplicit(size_t first) {
+        size_t requirementCount = demand.requirements().size();
+        graph.cliqueOffsets.assign(requirementCount + 1, 0);
+        graph.implicitDegree.assign(requirementCount, 0);
+
+        for (size_t c = first; c < cliques.size(); ++c) {
+            const Clique& clique = cliques[c];
+            uint32_t begin = static_cast<uint32_t>(graph.implicitRequirements.size());
+            graph.implicitRequirements.insert(graph.implicitRequirements.end(),
+                                              cliqueRequirements.begin() + clique.begin,
+                                              cliqueRequirements.begin() + clique.end);
+            graph.implicitCliques.push_back({begin, static_cast<uint32_t>(graph.implicitRequirements.size()),
+                                             clique.group});
+
+            for (uint32_t i = clique.begin; i < clique.end; ++i) {
+                uint32_t a = cliqueRequirements[i];
+                ++graph.cliqueOffsets[a + 1];
+
+                // Every other lesson of the clique, less the same lesson of each parallel section
+                uint64_t joined = clique.lessons - 1;
+                if (clique.group) {
+                    for (uint32_t j = clique.begin; j < clique.end; ++j) {
+                        uint32_t b = cliqueRequirements[j];
+                        joined -= b != a && graph.sameSplit(a, b);
+                    }
+                }
+                graph.implicitDegree[a] += static_cast<uint32_t>(joined);
+            }
+        }
+
+        for (size_t r = 0; r < requirementCount; ++r) {
+            graph.cliqueOffsets[r + 1] += graph.cliqueOffsets[r];
+        }
+        graph.cliqueIds.resize(graph.cliqueOffsets.back());
+        std::vector<uint64_t> next(graph.cliqueOffsets.begin(), graph.cliqueOffsets.end() - 1);
+        for (size_t c = 0; c < graph.implicitCliques.size(); ++c) {
+            const ConflictGraph::ImplicitClique& clique = graph.implicitCliques[c];
+            for (uint32_t i = clique.begin; i < clique.end; ++i) {
+                graph.cliqueIds[next[graph.implicitRequirements[i]]++] = static_cast<uint32_t>(c);
+            }
+        }
+    }
+
+    // Requirements left with exactly one teacher (or room) clash with every other requirement left with it
+    void addFixedCliques(const BitMatrix& domain, size_t resources) {
+        std::vector<std::vector<uint32_t>> byResource(resources);
+        for (size_t r = 0; r < domain.rows(); ++r) {
+            if (BitKernels::popcount(domain.row(r), domain.rowWords()) == 1) {
+                byResource[BitKernels::firstSet(domain.row(r), domain.rowWords())].push_back(static_cast<uint32_t>(r));
+            }
+        }
+        for (const auto& members : byResource) {
+            uint32_t begin = static_cast<uint32_t>(cliqueRequirements.size());
+            cliqueRequirements.insert(cliqueRequirements.end(), members.begin(), members.end());
+            addClique(begin, false);
+        }
+    }
+
+    void addClique(uint32_t begin, bool group) {
+        uint32_t end = static_cast<uint32_t>(cliqueRequirements.size());
+        size_t lessons = 0;
+        for (uint32_t i = begin; i < end; ++i) {
+            lessons += demand.requirements()[cliqueRequirements[i]].lessons;
+        }
+        if (lessons < 2) {
+            cliqueRequirements.resize(begin);
+            return;
+        }
+        // Cannot all be placed, which InfeasibilityDiagnosis explains; the edges still order the search
+        graph.oversizedCliques += lessons > model.timeBlocks().size();
+        cliques.push_back({begin, end, lessons, group});
+    }
+
+    void emit(size_t worker) {
+        auto& out = buckets[worker];
+        for (size_t c = nextClique++; c < cliques.size(); c = nextClique++) {
+            const Clique& clique = cliques[c];
+            for (uint32_t i = clique.begin; i < clique.end; ++i) {
+                uint32_t a = cliqueRequirements[i];
+                for (uint32_t j = clique.begin; j < clique.end; ++j) {
+                    uint32_t b = cliqueRequirements[j];
+                    bool parallel = clique.group && graph.sameSplit(a, b);
+                    for (EntityId u = graph.requirementLessons[a]; u < graph.requirementLessons[a + 1]; ++u) {
+                        auto& bucket = out[u / rangeSize];
+                        EntityId k = u - graph.requirementLessons[a];
+                        for (EntityId v = graph.requirementLessons[b]; v < graph.requirementLessons[b + 1]; ++v) {
+                            if (u != v && !(parallel && v - graph.requirementLessons[b] == k)) {
+                                bucket.push_back(static_cast<uint64_t>(u) << 32 | v);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void sortRange(size_t range) {
+        size_t total = 0;
+        for (const auto& worker : buckets) {
+            total += worker[range].size();
+        }
+        auto& pairs = sorted[range];
+        pairs.reserve(total);
+        for (auto& worker : buckets) {
+            pairs.insert(pairs.end(), worker[range].begin(), worker[range].end());
+            std::vector<uint64_t>().swap(worker[range]);
+        }
+        std::sort(pairs.begin(), pairs.end());
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+    }
+
+    void assemble(size_t threads) {
+        size_t lessons = graph.lessons();
+        graph.offsets.assign(lessons + 1, 0);
+        size_t total = 0;
+        for (const auto& pairs : sorted) {
+            for (uint64_t pair : pairs) {
+                ++graph.offsets[(pair >> 32) + 1];
+            }
+            total += pairs.size();
+        }
+        for (size_t u = 0; u < lessons; ++u) {
+            graph.offsets[u + 1] += graph.offsets[u];
+        }
+
+        // Ranges are ascending by source, so each one lands in its own contiguous slice
+        graph.neighbourIds.resize(total);
+        parallel(threads, [this](size_t range) {
+            auto& pairs = sorted[range];
+            if (pairs.empty()) {
+                return;
+            }
+            EntityId* out = graph.neighbourIds.data() + graph.offsets[pairs.front() >> 32];
+            for (uint64_t pair : pairs) {
+                *out++ = static_cast<EntityId>(pair);
+            }
+            std::vector<uint64_t>().swap(pairs);
+        });
+    }
+
+    void orderByDegree() {
+        size_t lessons = graph.lessons();
+        for (EntityId u = 0; u < lessons; ++u) {
+            graph.highestDegree = std::max(graph.highestDegree, graph.degree(u));
+        }
+        std::vector<uint32_t> starts(graph.highestDegree + 2, 0);
+        for (EntityId u = 0; u < lessons; ++u) {
+            ++starts[graph.highestDegree - graph.degree(u) + 1];
+        }
+        for (size_t d = 1; d < starts.size(); ++d) {
+            starts[d] += starts[d - 1];
+        }
+        graph.byDegree.resize(lessons);
+        for (EntityId u = 0; u < lessons; ++u) {
+            graph.byDegree[starts[graph.highestDegree - graph.degree(u)]++] = u;
+        }
+    }
+};
+
+std::shared_ptr<const ConflictGraph> ConflictGraph::build(const ProblemModel& model, const LessonDemand& demand,
+                                                          const LessonDomains& domains) {
+    auto started = std::chrono::steady_clock::now();
+    auto graph = std::make_shared<ConflictGraph>();
+    ConflictGraphBuilder(model, demand, domains, *graph).run();
+    graph->buildMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count();
+    return graph;
+}
+
+json ConflictGraph::summary() const {
+    uint64_t degrees = 0;
+    for (EntityId u = 0; u < lessons(); ++u) {
+        degrees += degree(u);
+    }
+    return {
+        {"lessons", lessons()},
+        {"edges", edges()},
+        {"max_degree", highestDegree},
+        {"mean_degree", lessons() ? static_cast<double>(degrees) / lessons() : 0.0},
+        {"cliques", cliqueCount},
+        {"oversized_cliques", oversizedCliques},
+        {"implicit_cliques", implicitCliques.size()},
+        {"threads", threadCount},
+        {"build_us", buildMicros}
+    };
+}
@@ -0,0 +1,457 @@
+#include "schedule/ConstraintCompiler.hpp"
+#include "schedule/ConstraintData.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    using Scope = ConstraintData::Scope;
+
+    constexpr int DEFAULT_BUFFER_PERCENT = 10;
+
+    const char* scopeName(RuleScope scope) {
+        switch (scope) {
+            case RuleScope::Event: return "event";
+            case RuleScope::TeacherDay: return "teacher_day";
+            case RuleScope::TeacherWeek: return "teacher_week";
+            case RuleScope::GroupDay: return "group_day";
+            case RuleScope::GroupWeek: return "group_week";
+            default: return "global";
+        }
+    }
+
+    /**
+     * Thrown by the compiler when a constraint lacks data it cannot do without
+     */
+    struct InvalidData {
+        std::string message;
+    };
+}
+
+/**
+ * @brief Turns the constraints of a ProblemModel into CompiledConstraints
+ */
+class ConstraintCompiler {
+public:
+    ConstraintCompiler(const ProblemModel& model, CompiledConstraints& compiled)
+        : model(model), compiled(compiled), selection(1, model.timeBlocks().size()) {
+    }
+
+    void run() {
+        buildTables();
+
+        const auto& constraints = model.constraints();
+        for (uint32_t i = 0; i < constraints.size(); ++i) {
+            const ProblemModel::ConstraintEntry& constraint = constraints[i];
+            auto dataIt = constraint.source->find("data");
+            const json& data = dataIt != constraint.source->end() && dataIt->is_object() ? *dataIt : emptyData;
+
+            try {
+                if (!compileOne(constraint, i, data)) {
+                    skip(constraint, "NOT_EVALUATED", "Constraint type describes permissions, not penalties");
+                }
+            } catch (const InvalidData& invalid) {
+                skip(constraint, "INVALID_CONSTRAINT_DATA", invalid.message);
+            } catch (const json::exception& e) {
+                skip(constraint, "INVALID_CONSTRAINT_DATA", e.what());
+            }
+        }
+
+        buildScopeIndex();
+    }
+
+private:
+    const ProblemModel& model;
+    CompiledConstraints& compiled;
+    BitMatrix selection;  // One row of time blocks, scratch
+    std::vector<EntityId> ids;
+    const json emptyData = json::object();
+
+    void buildTables() {
+        RuleTables& tables = compiled.ruleTables;
+        const auto& timeBlocks = model.timeBlocks();
+        tables.blockDay.resize(timeBlocks.size());
+        tables.blockStart.resize(timeBlocks.size());
+        tables.blockEnd.resize(timeBlocks.size());
+        for (size_t b = 0; b < timeBlocks.size(); ++b) {
+            tables.blockDay[b] = timeBlocks[b].day;
+            tables.blockStart[b] = timeBlocks[b].weekStart;
+            tables.blockEnd[b] = timeBlocks[b].weekEnd;
+        }
+
+        tables.roomCapacity.resize(model.rooms().size());
+        for (size_t r = 0; r < model.rooms().size(); ++r) {
+            tables.roomCapacity[r] = model.rooms()[r].capacity;
+        }
+
+        tables.qualified = BitMatrix(model.teachers().size(), model.subjects().size());
+        for (EntityId t = 0; t < model.teachers().size(); ++t) {
+            for (EntityId subject : model.teacherSubjects(t)) {
+                tables.qualified.set(t, subject);
+            }
+        }
+    }
+
+    void skip(const ProblemModel::ConstraintEntry& constraint, const char* code, const std::string& message) {
+        compiled.skippedList.push_back({
+            {"index", constraint.sourceIndex},
+            {"type", json(constraint.type)},
+            {"code", code},
+            {"message", message}
+        });
+    }
+
+    /**
+     * Entities named under keys; absent keys select everything when optional
+     */
+    EntitySet entities(const json& data, std::initializer_list<const char*> keys, const IdTable& table,
+                       bool optional = true) {
+        Scope scope = ConstraintData::resolveIds(data, keys, table, ids);
+        if (scope == Scope::Absent && !optional) {
+            throw InvalidData{std::string("Missing '") + *keys.begin() + "'"};
+        }
+        EntitySet set(table.size(), scope != Scope::Listed);
+        for (EntityId id : ids) {
+            set.add(id);
+        }
+        return set;
+    }
+
+    EntitySet subjectsOf(const json& data) {
+        return entities(data, {"subjectId", "subjectIds", "subjects"}, model.subjectIds());
+    }
+
+    EntitySet groupsOf(const json& data) {
+        return entities(data, {"groupId", "groupIds"}, model.groupIds());
+    }
+
+    EntitySet timeWindow(const json& data) {
+        ConstraintData::selectTimeBlocks(data, model, selection.row(0));
+        EntitySet window(model.timeBlocks().size());
+        for (EntityId b = 0; b < model.timeBlocks().size(); ++b) {
+            if (selection.test(0, b)) {
+                window.add(b);
+            }
+        }
+        return window;
+    }
+
+    EntityId subjectNamed(const json& data, const char* key) {
+        auto it = data.find(key);
+        if (it == data.end() || !it->is_string()) {
+            throw InvalidData{std::string("Missing '") + key + "'"};
+        }
+        EntityId subject = model.subjectIds().find(it->get<std::string>());
+        if (subject == NO_ENTITY) {
+            throw InvalidData{std::string("Unknown subject '") + it->get<std::string>() + "' in '" + key + "'"};
+        }
+        return subject;
+    }
+
+    static int32_t required(const json& data, const char* key) {
+        auto it = data.find(key);
+        if (it == data.end() || !it->is_number()) {
+            throw InvalidData{std::string("Missing '") + key + "'"};
+        }
+        return it->get<int32_t>();
+    }
+
+    template <typename Rule>
+    void add(Rule rule, const ProblemModel::ConstraintEntry& constraint, uint32_t index, const json& data) {
+        int64_t priority = std::clamp<int64_t>(data.value("priority", 1), 1, 10);
+        rule.constraint = index;
+        rule.tier = static_cast<PenaltyTier>(constraint.importance);
+        rule.weight = TIER_WEIGHTS[static_cast<size_t>(rule.tier)] * priority;
+        compiled.ruleList.emplace_back(std::move(rule));
+        compiled.ruleTypes.push_back(constraint.type);
+    }
+
+    /**
+     * @return false for types that are not evaluated
+     */
+    bool compileOne(const ProblemModel::ConstraintEntry& constraint, uint32_t index, const json& data) {
+        switch (constraint.type) {
+            case ConstraintType::TeacherUnavailable:
+            case ConstraintType::TeacherPreferred: {
+                TimeWindowRule rule;
+                rule.owners = entities(data, {"teacherId", "teacherIds"}, model.teacherIds(), false);
+                rule.subjects = subjectsOf(data);
+                rule.window = timeWindow(data);
+                rule.mustBeInside = constraint.type == ConstraintType::TeacherPreferred;
+                add(std::move(rule), constraint, index, data);
+                return true;
+            }
+            case ConstraintType::GroupUnavailable: {
+                TimeWindowRule rule;
+                rule.byTeacher = false;
+                rule.owners = entities(data, {"groupId", "groupIds"}, model.groupIds(), false);
+                rule.subjects = subjectsOf(data);
+                rule.window = timeWindow(data);
+                add(std::move(rule), constraint, index, data);
+                return true;
+            }
+            case ConstraintType::RequiredRoomFeature:
+                add(roomFeatureRule(data), constraint, index, data);
+                return true;
+            case ConstraintType::PreferredRoom:
+            case ConstraintType::ForbiddenRoom: {
+                RoomRule rule;
+                rule.subjects = subjectsOf(data);
+                rule.rooms = entities(data, {"roomId", "roomIds"}, model.roomIds(), false);
+                rule.mustBeInside = constraint.type == ConstraintType::PreferredRoom;
+                add(std::move(rule), constraint, index, data);
+                return true;
+            }
+            case ConstraintType::MinimumRoomCapacity:
+                add(capacityRule(data), constraint, index, data);
+                return true;
+            case ConstraintType::TeacherSubjectMatch: {
+                QualificationRule rule;
+                rule.teachers = entities(data, {"teacherId", "teacherIds"}, model.teacherIds());
+                rule.ownSubjects = !data.contains("allowedSubjects");
+                rule.allowedSubjects = entities(data, {"allowedSubjects"}, model.subjectIds());
+                add(std::move(rule), constraint, index, data);
+                return true;
+            }
+            case ConstraintType::MaxTeachingHours: {
+                auto maxHours = data.find("maxHours");
+                if (maxHours == data.end() || !maxHours->is_number()) {
+                    throw InvalidData{"Missing 'maxHours'"};
+                }
+                TeachingLoadRule rule;
+                rule.teachers = entities(data, {"teacherId", "teacherIds"}, model.teacherIds());
+                rule.maxMinutes = static_cast<int32_t>(std::lround(maxHours->get<double>() * 60));
+                rule.perWeek = data.value("period", "day") != "day";
+                add(std::move(rule), constraint, index, data);
+                return true;
+            }
+            case ConstraintType::MinBreakBetweenClasses: {
+                BreakRule rule;
+                rule.teachers = entities(data, {"teacherId", "teacherIds"}, model.teacherIds());
+                rule.minBreakMinutes = required(data, "minBreakMinutes");
+                add(std::move(rule), constraint, index, data);
+                return true;
+            }
+            case ConstraintType::MaxClassesPerDay: {
+                DailyLoadRule rule;
+                rule.groups = groupsOf(data);
+                rule.maxClasses = required(data, "maxClasses");
+                add(std::move(rule), constraint, index, data);
+                return true;
+            }
+            case ConstraintType::AvoidConsecutive: {
+                ConsecutiveRule rule;
+                rule.groups = groupsOf(data);
+                rule.subjects = subjectsOf(data);
+                rule.limit = std::max(1, data.value("maxConsecutive", 1));
+                add(std::move(rule), constraint, index, data);
+                return true;
+            }
+            case ConstraintType::ConsecutiveClasses: {
+                ConsecutiveRule rule;
+                rule.groups = groupsOf(data);
+                rule.subjects = subjectsOf(data);
+                rule.avoid = data.value("preference", "required") == "avoided";
+                rule.limit = rule.avoid ? 1 : std::max(1, data.value("consecutiveCount", 2));
+                add(std::move(rule), constraint, index, data);
+                return true;
+            }
+            case ConstraintType::SpreadAcrossWeek:
+            case ConstraintType::SameDayClasses: {
+                SpreadRule rule;
+                rule.groups = groupsOf(data);
+                rule.subjects = subjectsOf(data);
+                rule.sameDay = constraint.type == ConstraintType::SameDayClasses;
+                rule.minDaysBetween = std::max(1, data.value("minDaysBetween", 1));
+                rule.preferredDays = entities(data, {"preferredDays"}, model.days());
+                add(std::move(rule), constraint, index, data);
+                return true;
+            }
+            case ConstraintType::ClassBefore:
+            case ConstraintType::ClassAfter: {
+                PrecedenceRule rule;
+                rule.groups = groupsOf(data);
+                rule.before = subjectNamed(data, "beforeSubject");
+                rule.after = subjectNamed(data, "afterSubject");
+                rule.sameDay = data.value("sameDay", false);
+                rule.minGapMinutes = data.value("minGapMinutes", 0);
+                rule.maxGapMinutes = data.value("maxGapMinutes", -1);
+                add(std::move(rule), constraint, index, data);
+                return true;
+            }
+            case ConstraintType::SameTeacherForSubject: {
+                SameTeacherRule rule;
+                rule.groups = groupsOf(data);
+                rule.subjects = subjectsOf(data);
+                add(std::move(rule), constraint, index, data);
+                return true;
+            }
+            case ConstraintType::SameTimeSlot: {
+                SameTimeRule rule;
+                rule.groups = groupsOf(data);
+                rule.subjects = entities(data, {"subjectId", "subjectIds", "subjects"}, model.subjectIds(), false);
+                add(std::move(rule), constraint, index, data);
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    RoomRule roomFeatureRule(const json& data) {
+        auto features = data.find("features");
+        bool hasFeatures = features != data.end() && features->is_array();
+        if (!hasFeatures && !data.contains("minCapacity")) {
+            throw InvalidData{"Missing 'features'"};
+        }
+        bool any = data.value("operator", "AND") == "OR";
+        int minCapacity = data.value("minCapacity", 0);
+
+        std::vector<EntityId> wanted;
+        bool unknownFeature = false;
+        if (hasFeatures) {
+            for (const json& name : *features) {
+                EntityId feature = name.is_string() ? model.features().find(name.get<std::string>()) : NO_ENTITY;
+                if (feature == NO_ENTITY) {
+                    unknownFeature = true;
+                } else {
+                    wanted.push_back(feature);
+                }
+            }
+        }
+
+        RoomRule rule;
+        rule.subjects = subjectsOf(data);
+        rule.rooms = EntitySet(model.rooms().size());
+        for (EntityId r = 0; r < model.rooms().size(); ++r) {
+            if (model.rooms()[r].capacity < minCapacity) {
+                continue;
+            }
+            IdRange has = model.roomFeatures(r);
+            size_t matched = std::count_if(wanted.begin(), wanted.end(), [&](EntityId feature) {
+                return std::find(has.begin(), has.end(), feature) != has.end();
+            });
+            bool suitable = !hasFeatures || (any ? matched > 0 : !unknownFeature && matched == wanted.size());
+            if (suitable) {
+                rule.rooms.add(r);
+            }
+        }
+        return rule;
+    }
+
+    CapacityRule capacityRule(const json& data) {
+        EntitySet groups = groupsOf(data);
+        auto minCapacity = data.find("minCapacity");
+        bool explicitMinimum = minCapacity != data.end() && minCapacity->is_number();
+        int buffer = data.value("includeBuffer", false) ? data.value("bufferPercentage", DEFAULT_BUFFER_PERCENT) : 0;
+
+        CapacityRule rule;
+        rule.required.assign(model.groups().size(), 0);
+        for (EntityId g = 0; g < model.groups().size(); ++g) {
+            if (!groups.contains(g)) {
+                continue;
+            }
+            int base = explicitMinimum ? minCapacity->get<int>() : model.groups()[g].size;
+            rule.required[g] = (base * (100 + buffer) + 99) / 100;
+        }
+        return rule;
+    }
+
+    /**
+     * Owner lists of every rule, laid out per scope as offsets + rule indices
+     */
+    void buildScopeIndex() {
+        size_t owners[RULE_SCOPES] = {1, model.teachers().size(), model.teachers().size(),
+                                      model.groups().size(), model.groups().size(), 1};
+        std::vector<std::vector<EntityId>> lists[RULE_SCOPES];
+        for (size_t s = 0; s < RULE_SCOPES; ++s) {
+            lists[s].resize(owners[s]);
+        }
+
+        for (EntityId r = 0; r < compiled.ruleList.size(); ++r) {
+            const ConstraintRule& rule = compiled.ruleList[r];
+            size_t scope = static_cast<size_t>(CompiledConstraints::scopeOf(rule));
+            const EntitySet* ownerSet = std::visit([](const auto& typed) -> const EntitySet* {
+                using Rule = std::decay_t<decltype(typed)>;
+                if constexpr (std::is_same_v<Rule, TeachingLoadRule> || std::is_same_v<Rule, BreakRule>) {
+                    return &typed.teachers;
+                } else if constexpr (isEventRule<Rule> || std::is_same_v<Rule, SameTimeRule>) {
+                    return nullptr;
+                } else {
+                    return &typed.groups;
+                }
+            }, rule);
+
+            for (EntityId owner = 0; owner < owners[scope]; ++owner) {
+                if (!ownerSet || ownerSet->contains(owner)) {
+                    lists[scope][owner].push_back(r);
+                }
+            }
+        }
+
+        for (size_t s = 0; s < RULE_SCOPES; ++s) {
+            CompiledConstraints::ScopeIndex& index = compiled.scopes[s];
+            index.offsets.assign(1, 0);
+            for (const auto& list : lists[s]) {
+                index.rules.insert(index.rules.end(), list.begin(), list.end());
+                index.offsets.push_back(static_cast<uint32_t>(index.rules.size()));
+            }
+        }
+    }
+};
+
+std::shared_ptr<const CompiledConstraints> CompiledConstraints::compile(const ProblemModel& model) {
+    auto compiled = std::make_shared<CompiledConstraints>();
+    ConstraintCompiler(model, *compiled).run();
+    return compiled;
+}
+
+IdRange CompiledConstraints::rulesFor(RuleScope scope, EntityId owner) const {
+    const ScopeIndex& index = scopes[static_cast<size_t>(scope)];
+    if (owner + 1 >= index.offsets.size()) {
+        return {};
+    }
+    return {index.rules.data() + index.offsets[owner], index.rules.data() + index.offsets[owner + 1]};
+}
+
+RuleScope CompiledConstraints::scopeOf(const ConstraintRule& rule) {
+    return std::visit([](const auto& typed) {
+        using Rule = std::decay_t<decltype(typed)>;
+        if constexpr (isEventRule<Rule>) {
+            return RuleScope::Event;
+        } else if constexpr (std::is_same_v<Rule, TeachingLoadRule>) {
+            return typed.perWeek ? RuleScope::TeacherWeek : RuleScope::TeacherDay;
+        } else if constexpr (std::is_same_v<Rule, BreakRule>) {
+            return RuleScope::TeacherDay;
+        } else if constexpr (std::is_same_v<Rule, DailyLoadRule> || std::is_same_v<Rule, ConsecutiveRule>) {
+            return RuleScope::GroupDay;
+        } else if constexpr (std::is_same_v<Rule, PrecedenceRule>) {
+            return typed.sameDay ? RuleScope::GroupDay : RuleScope::GroupWeek;
+        } else if constexpr (std::is_same_v<Rule, SameTimeRule>) {
+            return RuleScope::Global;
+        } else {
+            return RuleScope::GroupWeek;
+        }
+    }, rule);
+}
+
+json CompiledConstraints::summary() const {
+    json byType = json::object();
+    json byTier = json::object();
+    json byScope = json::object();
+    for (size_t r = 0; r < ruleList.size(); ++r) {
+        std::string type = json(ruleTypes[r]).get<std::string>();
+        const char* tier = tierName(ruleBase(ruleList[r]).tier);
+        const char* scope = scopeName(scopeOf(ruleList[r]));
+        byType[type] = byType.value(type, 0) + 1;
+        byTier[tier] = byTier.value(tier, 0) + 1;
+        byScope[scope] = byScope.value(scope, 0) + 1;
+    }
+
+    return {
+        {"rules", ruleList.size()},
+        {"rules_by_type", byType},
+        {"rules_by_tier", byTier},
+        {"rules_by_scope", byScope},
+        {"skipped", skippedList}
+    };
+}
@@ -0,0 +1,115 @@
+#include "schedule/ConstraintData.hpp"
+#include "schedule/BitMatrix.hpp"
+#include "schedule/TimeIndex.hpp"
+#include <algorithm>
+
+namespace {
+    constexpr const char* WILDCARD = "*";
+
+    void setBit(uint64_t* row, size_t bit) {
+        row[bit / BitMatrix::WORD_BITS] |= uint64_t(1) << (bit % BitMatrix::WORD_BITS);
+    }
+}
+
+ConstraintData::Scope ConstraintData::resolveIds(const json& data, std::initializer_list<const char*> keys,
+                                                 const IdTable& table, std::vector<EntityId>& ids) {
+    ids.clear();
+    Scope scope = Scope::Absent;
+    auto add = [&](const json& value) {
+        if (!value.is_string()) {
+            return;
+        }
+        const std::string& id = value.get_ref<const std::string&>();
+        if (id == WILDCARD) {
+            scope = Scope::All;
+            return;
+        }
+        EntityId index = table.find(id);
+        if (index != NO_ENTITY) {
+            ids.push_back(index);
+        }
+    };
+
+    for (const char* key : keys) {
+        auto it = data.find(key);
+        if (it == data.end()) {
+            continue;
+        }
+        if (scope == Scope::Absent) {
+            scope = Scope::Listed;
+        }
+        if (it->is_array()) {
+            for (const json& value : *it) {
+                add(value);
+            }
+        } else {
+            add(*it);
+        }
+    }
+    return scope;
+}
+
+void ConstraintData::selectTimeBlocks(const json& data, const ProblemModel& model, uint64_t* row) {
+    const auto& timeBlocks = model.timeBlocks();
+    std::fill(row, row + BitMatrix::wordsFor(timeBlocks.size()), 0);
+
+    auto blocks = data.find("timeBlocks");
+    auto days = data.find("days");
+    auto ranges = data.find("timeRanges");
+    bool hasDays = days != data.end() && days->is_array();
+    bool hasRanges = ranges != data.end() && ranges->is_array();
+
+    if (blocks == data.end() && !hasDays && !hasRanges) {
+        for (size_t b = 0; b < timeBlocks.size(); ++b) {
+            setBit(row, b);
+        }
+        return;
+    }
+
+    if (blocks != data.end() && blocks->is_array()) {
+        for (const json& id : *blocks) {
+            EntityId block = id.is_string() ? model.timeBlockIds().find(id.get<std::string>()) : NO_ENTITY;
+            if (block != NO_ENTITY) {
+                setBit(row, block);
+            }
+        }
+    }
+
+    if (!hasDays && !hasRanges) {
+        return;
+    }
+
+    std::vector<bool> dayMatches(model.days().size(), !hasDays);
+    if (hasDays) {
+        for (const json& day : *days) {
+            EntityId index = day.is_string() ? model.days().find(day.get<std::string>()) : NO_ENTITY;
+            if (index != NO_ENTITY) {
+                dayMatches[index] = true;
+            }
+        }
+    }
+
+    const TimeIndex& times = model.timeIndex();
+    std::vector<EntityId> found;
+    for (EntityId day = 0; day < dayMatches.size(); ++day) {
+        if (!dayMatches[day]) {
+            continue;
+        }
+        if (!hasRanges) {
+            for (EntityId b : times.dayBlocks(day)) {
+                setBit(row, b);
+            }
+            continue;
+        }
+        for (const json& range : *ranges) {
+            if (!range.is_object()) {
+                continue;
+            }
+            found.clear();
+            times.intersecting(day, minutesOf(range.value("start", 0)), minutesOf(range.value("end", 2400)), found);
+            for (EntityId b : found) {
+                setBit(row, b);
+            }
+        }
+    }
+}
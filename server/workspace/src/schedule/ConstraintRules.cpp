@@ -0,0 +1,143 @@
+#include "schedule/ConstraintRules.hpp"
+#include <algorithm>
+
+namespace {
+    // Classes at most this far apart count as back to back (covers short breaks between periods)
+    constexpr int32_t CONSECUTIVE_GAP_MINUTES = 15;
+    constexpr int32_t MINUTES_PER_HOUR = 60;
+}
+
+int64_t TeachingLoadRule::violations(const EventRange& events, const RuleTables& tables) const {
+    int32_t minutes = 0;
+    for (size_t i = 0; i < events.size(); ++i) {
+        minutes += tables.blockEnd[events[i].timeBlock] - tables.blockStart[events[i].timeBlock];
+    }
+    int32_t excess = minutes - maxMinutes;
+    return excess > 0 ? (excess + MINUTES_PER_HOUR - 1) / MINUTES_PER_HOUR : 0;
+}
+
+int64_t BreakRule::violations(const EventRange& events, const RuleTables& tables) const {
+    int64_t count = 0;
+    for (size_t i = 1; i < events.size(); ++i) {
+        int32_t gap = tables.blockStart[events[i].timeBlock] - tables.blockEnd[events[i - 1].timeBlock];
+        if (gap >= 0 && gap < minBreakMinutes) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+int64_t ConsecutiveRule::violations(const EventRange& events, const RuleTables& tables) const {
+    int64_t count = 0;
+    int32_t run = 0;
+    int32_t runEnd = 0;
+    auto closeRun = [&]() {
+        if (run == 0) {
+            return;
+        }
+        if (avoid) {
+            count += run > limit ? run - limit : 0;
+        } else if (run < limit) {
+            ++count;
+        }
+        run = 0;
+    };
+
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Placement& event = events[i];
+        if (!subjects.contains(event.subject)) {
+            closeRun();
+            continue;
+        }
+        int32_t start = tables.blockStart[event.timeBlock];
+        if (run > 0 && (start - runEnd < 0 || start - runEnd > CONSECUTIVE_GAP_MINUTES)) {
+            closeRun();
+        }
+        ++run;
+        runEnd = tables.blockEnd[event.timeBlock];
+    }
+    closeRun();
+    return count;
+}
+
+int64_t SpreadRule::violations(const EventRange& events, const RuleTables& tables) const {
+    // Events are in time order, so the previous class of a subject is the nearest earlier match
+    int64_t count = 0;
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Placement& event = events[i];
+        if (!subjects.contains(event.subject)) {
+            continue;
+        }
+        EntityId day = tables.blockDay[event.timeBlock];
+        if (!sameDay && !preferredDays.contains(day)) {
+            ++count;
+        }
+        size_t previous = i;
+        while (previous > 0 && events[previous - 1].subject != event.subject) {
+            --previous;
+        }
+        if (previous == 0) {
+            continue;
+        }
+        int32_t gap = static_cast<int32_t>(day - tables.blockDay[events[previous - 1].timeBlock]);
+        if (sameDay ? gap != 0 : gap < minDaysBetween) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+int64_t PrecedenceRule::violations(const EventRange& events, const RuleTables& tables) const {
+    int64_t count = 0;
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Placement& later = events[i];
+        if (later.subject != after) {
+            continue;
+        }
+        int32_t laterStart = tables.blockStart[later.timeBlock];
+        bool satisfied = false;
+        for (size_t j = 0; j < events.size() && !satisfied; ++j) {
+            const Placement& earlier = events[j];
+            if (earlier.subject != before || (sameDay && tables.blockDay[earlier.timeBlock] != tables.blockDay[later.timeBlock])) {
+                continue;
+            }
+            int32_t gap = laterStart - tables.blockEnd[earlier.timeBlock];
+            satisfied = gap >= minGapMinutes && (maxGapMinutes < 0 || gap <= maxGapMinutes);
+        }
+        count += satisfied ? 0 : 1;
+    }
+    return count;
+}
+
+int64_t SameTeacherRule::violations(const EventRange& events, const RuleTables&) const {
+    // A class counts when its subject was taught before, but never by its teacher
+    int64_t count = 0;
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Placement& event = events[i];
+        if (!subjects.contains(event.subject)) {
+            continue;
+        }
+        bool subjectSeen = false;
+        bool teacherSeen = false;
+        for (size_t j = 0; j < i && !teacherSeen; ++j) {
+            if (events[j].subject == event.subject) {
+                subjectSeen = true;
+                teacherSeen = events[j].teacher == event.teacher;
+            }
+        }
+        count += subjectSeen && !teacherSeen ? 1 : 0;
+    }
+    return count;
+}
+
+int64_t SameTimeRule::violations(const EventRange& events, const RuleTables&) const {
+    std::vector<EntityId> blocks;
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (matches(events[i])) {
+            blocks.push_back(events[i].timeBlock);
+        }
+    }
+    std::sort(blocks.begin(), blocks.end());
+    int64_t distinct = std::unique(blocks.begin(), blocks.end()) - blocks.begin();
+    return distinct > 1 ? distinct - 1 : 0;
+}
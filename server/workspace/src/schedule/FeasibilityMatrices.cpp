@@ -0,0 +1,215 @@
+#include "schedule/FeasibilityMatrices.hpp"
+#include "schedule/BitKernels.hpp"
+#include "schedule/ConstraintData.hpp"
+#include <chrono>
+
+namespace {
+    using Scope = ConstraintData::Scope;
+}
+
+/**
+ * @brief Fills FeasibilityMatrices from a model and its Critical constraints
+ */
+class FeasibilityBuilder {
+public:
+    FeasibilityBuilder(const ProblemModel& model, FeasibilityMatrices& matrices)
+        : model(model), matrices(matrices), selection(1, model.timeBlocks().size()) {
+    }
+
+    void run() {
+        size_t timeBlocks = model.timeBlocks().size();
+        size_t rooms = model.rooms().size();
+
+        matrices.teacherTimes = BitMatrix(model.teachers().size(), timeBlocks);
+        for (EntityId t = 0; t < model.teachers().size(); ++t) {
+            if (!model.teachers()[t].availabilityListed) {
+                matrices.teacherTimes.fillRow(t);
+            }
+            for (EntityId block : model.teacherAvailability(t)) {
+                matrices.teacherTimes.set(t, block);
+            }
+        }
+
+        matrices.groupTimes = BitMatrix(model.groups().size(), timeBlocks, true);
+
+        matrices.roomFeatureBits = BitMatrix(rooms, model.features().size());
+        for (EntityId r = 0; r < rooms; ++r) {
+            for (EntityId feature : model.roomFeatures(r)) {
+                matrices.roomFeatureBits.set(r, feature);
+            }
+        }
+        matrices.featureRoomBits = matrices.roomFeatureBits.transposed();
+
+        matrices.subjectRoomBits = BitMatrix(model.subjects().size(), rooms, true);
+        matrices.timeBlockRoomBits = BitMatrix(timeBlocks, rooms, true);
+
+        for (const ProblemModel::ConstraintEntry& constraint : model.constraints()) {
+            if (constraint.importance != ConstraintImportance::Critical) {
+                continue;
+            }
+            auto data = constraint.source->find("data");
+            if (data == constraint.source->end() || !data->is_object()) {
+                continue;
+            }
+
+            switch (constraint.type) {
+                case ConstraintType::TeacherUnavailable:
+                    clearTimes(*data, {"teacherId", "teacherIds"}, model.teacherIds(), matrices.teacherTimes);
+                    break;
+                case ConstraintType::GroupUnavailable:
+                    clearTimes(*data, {"groupId", "groupIds"}, model.groupIds(), matrices.groupTimes);
+                    break;
+                case ConstraintType::RequiredRoomFeature:
+                    requireFeatures(*data);
+                    break;
+                case ConstraintType::ForbiddenRoom:
+                    forbidRooms(*data);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+private:
+    const ProblemModel& model;
+    FeasibilityMatrices& matrices;
+    BitMatrix selection;  // One row of time blocks, scratch
+    std::vector<EntityId> ids;
+
+    void clearTimes(const json& data, std::initializer_list<const char*> keys, const IdTable& table, BitMatrix& times) {
+        Scope scope = ConstraintData::resolveIds(data, keys, table, ids);
+        if (scope == Scope::Absent) {
+            return;
+        }
+        ConstraintData::selectTimeBlocks(data, model, selection.row(0));
+
+        if (scope == Scope::All) {
+            for (size_t r = 0; r < times.rows(); ++r) {
+                BitKernels::andNotAssign(times.row(r), selection.row(0), times.rowWords());
+            }
+            return;
+        }
+        for (EntityId entity : ids) {
+            BitKernels::andNotAssign(times.row(entity), selection.row(0), times.rowWords());
+        }
+    }
+
+    /**
+     * Subjects named by the constraint; no subject key means every subject
+     */
+    std::vector<EntityId> subjectsOf(const json& data) {
+        std::vector<EntityId> subjects;
+        Scope scope = ConstraintData::resolveIds(data, {"subjectId", "subjectIds", "subjects"}, model.subjectIds(),
+                                                 subjects);
+        if (scope != Scope::Listed) {
+            subjects.resize(model.subjects().size());
+            for (EntityId s = 0; s < subjects.size(); ++s) {
+                subjects[s] = s;
+            }
+        }
+        return subjects;
+    }
+
+    void requireFeatures(const json& data) {
+        auto features = data.find("features");
+        if (features == data.end() || !features->is_array()) {
+            return;
+        }
+        bool any = data.value("operator", "AND") == "OR";
+        size_t words = matrices.featureRoomBits.rowWords();
+
+        // AND starts from every room and intersects, OR starts from none and unites
+        BitMatrix suitable(1, model.rooms().size(), !any);
+        for (const json& name : *features) {
+            EntityId feature = name.is_string() ? model.features().find(name.get<std::string>()) : NO_ENTITY;
+            if (feature == NO_ENTITY) {
+                // No room has it
+                if (!any) {
+                    suitable = BitMatrix(1, model.rooms().size());
+                    break;
+                }
+                continue;
+            }
+            if (any) {
+                BitKernels::orAssign(suitable.row(0), matrices.featureRoomBits.row(feature), words);
+            } else {
+                BitKernels::andAssign(suitable.row(0), matrices.featureRoomBits.row(feature), words);
+            }
+        }
+
+        for (EntityId subject : subjectsOf(data)) {
+            BitKernels::andAssign(matrices.subjectRoomBits.row(subject), suitable.row(0), words);
+        }
+    }
+
+    void forbidRooms(const json& data) {
+        std::vector<EntityId> rooms;
+        Scope scope = ConstraintData::resolveIds(data, {"roomId", "roomIds"}, model.roomIds(), rooms);
+        if (scope == Scope::Absent) {
+            return;
+        }
+
+        BitMatrix forbidden(1, model.rooms().size(), scope == Scope::All);
+        for (EntityId room : rooms) {
+            forbidden.set(0, room);
+        }
+        for (EntityId subject : subjectsOf(data)) {
+            BitKernels::andNotAssign(matrices.subjectRoomBits.row(subject), forbidden.row(0), forbidden.rowWords());
+        }
+    }
+};
+
+std::shared_ptr<const FeasibilityMatrices> FeasibilityMatrices::build(const ProblemModel& model) {
+    auto started = std::chrono::steady_clock::now();
+    auto matrices = std::make_shared<FeasibilityMatrices>();
+    FeasibilityBuilder(model, *matrices).run();
+    matrices->buildMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count();
+    return matrices;
+}
+
+void FeasibilityMatrices::feasibleRooms(EntityId subject, EntityId timeBlock, uint64_t* out) const {
+    BitKernels::andInto(out, subjectRoomBits.row(subject), timeBlockRoomBits.row(timeBlock), roomWords());
+}
+
+size_t FeasibilityMatrices::countFeasibleRooms(EntityId subject, EntityId timeBlock) const {
+    return BitKernels::andPopcount(subjectRoomBits.row(subject), timeBlockRoomBits.row(timeBlock), roomWords());
+}
+
+EntityId FeasibilityMatrices::firstFeasibleRoom(EntityId subject, EntityId timeBlock) const {
+    size_t room = BitKernels::firstSetAnd(subjectRoomBits.row(subject), timeBlockRoomBits.row(timeBlock), roomWords());
+    return room == BitKernels::NPOS ? NO_ENTITY : static_cast<EntityId>(room);
+}
+
+json FeasibilityMatrices::summary(const ProblemModel& model) const {
+    json subjectRoomCounts = json::object();
+    for (EntityId s = 0; s < subjectRoomBits.rows(); ++s) {
+        subjectRoomCounts[model.subjectIds().name(s)] = BitKernels::popcount(subjectRoomBits.row(s), roomWords());
+    }
+    json teacherSlotCounts = json::object();
+    for (EntityId t = 0; t < teacherTimes.rows(); ++t) {
+        teacherSlotCounts[model.teacherIds().name(t)] =
+            BitKernels::popcount(teacherTimes.row(t), teacherTimes.rowWords());
+    }
+
+    // Every subject x time block room query, timed as a whole
+    size_t pairsWithoutRoom = 0;
+    auto started = std::chrono::steady_clock::now();
+    for (EntityId s = 0; s < subjectRoomBits.rows(); ++s) {
+        for (EntityId b = 0; b < timeBlockRoomBits.rows(); ++b) {
+            pairsWithoutRoom += countFeasibleRooms(s, b) == 0 ? 1 : 0;
+        }
+    }
+    auto queryMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count();
+
+    return {
+        {"build_us", buildMicros},
+        {"rooms_per_subject", subjectRoomCounts},
+        {"slots_per_teacher", teacherSlotCounts},
+        {"subject_time_pairs", subjectRoomBits.rows() * timeBlockRoomBits.rows()},
+        {"pairs_without_room", pairsWithoutRoom},
+        {"all_pairs_query_us", queryMicros}
+    };
+}
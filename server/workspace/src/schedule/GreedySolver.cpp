@@ -0,0 +1,325 @@
+#include "schedule/GreedySolver.hpp"
+#include "schedule/BitKernels.hpp"
+#include "schedule/ScheduleEvaluator.hpp"
+#include "schedule/TimeIndex.hpp"
+#include <chrono>
+#include <queue>
+#include <tuple>
+
+/**
+ * @brief State of one GreedySolver run
+ */
+class GreedyConstruction {
+public:
+    GreedyConstruction(const CompiledDataset& compiled, const json& config)
+        : model(*compiled.model), feasibility(*compiled.feasibility), demand(*compiled.demand),
+          domains(*compiled.domains), graph(*compiled.conflicts), times(compiled.model->timeIndex()),
+          blockCount(model.timeBlocks().size()), blockWords(BitMatrix::wordsFor(blockCount)),
+          roomWords(BitMatrix::wordsFor(model.rooms().size())),
+          maxPerDay(std::max(0, config.value("maxLessonsPerDay", 0))),
+          blockOf(graph.lessons(), NO_ENTITY), teacherOf(graph.lessons(), NO_ENTITY),
+          roomOf(graph.lessons(), NO_ENTITY), requirementTeacher(demand.requirements().size(), NO_ENTITY),
+          available(graph.lessons()), blocked(graph.lessons(), blockCount),
+          busyTeachers(blockCount, model.teachers().size()), busyRooms(blockCount, model.rooms().size()),
+          busyGroups(blockCount, model.groups().size()),
+          dayLessons(demand.requirements().size() * model.days().size(), 0),
+          teacherLoad(model.teachers().size(), 0), freeRooms(roomWords), givenUp(graph.lessons(), false) {
+    }
+
+    /**
+     * @return Lessons placed; shouldStop returning true ends the run early
+     */
+    size_t run(const GreedySolver::ShouldStop& shouldStop, const GreedySolver::Report& report) {
+        for (EntityId u = 0; u < graph.lessons(); ++u) {
+            const uint64_t* domain = domains.timeBlocks().row(graph.requirementOf(u));
+            available[u] = static_cast<uint32_t>(BitKernels::popcount(domain, blockWords));
+            open.push({available[u], -static_cast<int64_t>(graph.degree(u)), u});
+        }
+
+        size_t done = 0;
+        size_t step = std::max<size_t>(1, graph.lessons() / 10);
+        while (!open.empty()) {
+            auto [left, degree, u] = open.top();
+            open.pop();
+            if (blockOf[u] != NO_ENTITY || givenUp[u] || left != available[u]) {
+                continue;  // Placed, given up, or a stale entry
+            }
+            if (!place(u, NO_ENTITY)) {
+                givenUp[u] = true;
+                unplaced.push_back(u);
+            }
+            if (++done % step == 0) {
+                if (shouldStop && shouldStop()) {
+                    break;
+                }
+                if (report) {
+                    report(static_cast<float>(done) / graph.lessons(), "placing");
+                }
+            }
+        }
+        return placed;
+    }
+
+    Assignment assignment() const {
+        Assignment result;
+        for (EntityId u = 0; u < graph.lessons(); ++u) {
+            if (blockOf[u] == NO_ENTITY) {
+                continue;
+            }
+            const LessonRequirement& requirement = demand.requirements()[graph.requirementOf(u)];
+            result.events.push_back({requirement.subject, teacherOf[u], requirement.group, roomOf[u], blockOf[u]});
+            result.eventIds.push_back(u + 1);
+        }
+        return result;
+    }
+
+    json toResult(const Assignment& schedule, const Evaluation& evaluation, int64_t micros) const {
+        json listed = json::array();
+        for (size_t i = 0; i < unplaced.size() && i < GreedySolver::MAX_LISTED_UNPLACED; ++i) {
+            EntityId u = unplaced[i];
+            size_t r = graph.requirementOf(u);
+            const LessonRequirement& requirement = demand.requirements()[r];
+            listed.push_back({
+                {"subjectId", model.subjectIds().name(requirement.subject)},
+                {"groupId", model.groupIds().name(requirement.group)},
+                {"section", requirement.section},
+                {"lesson", u - graph.firstLesson(r)}
+            });
+        }
+
+        size_t lessons = graph.lessons();
+        int64_t violations = 0;
+        for (int64_t tier : evaluation.tierViolations) {
+            violations += tier;
+        }
+        return {
+            {"status", placed == lessons ? "success" : "partial"},
+            {"schedule", schedule.toJson(model)},
+            {"metadata", {
+                {"algorithmName", GreedySolver::NAME},
+                {"version", GreedySolver::VERSION},
+                {"executionTimeMs", micros / 1000},
+                {"qualityScore", lessons ? static_cast<double>(placed) / lessons : 1.0},
+                {"constraintViolations", violations},
+                {"customMetrics", {
+                    {"lessons", lessons},
+                    {"placed", placed},
+                    {"unplaced", lessons - placed},
+                    {"teacherChanges", teacherChanges},
+                    {"cost", evaluation.cost},
+                    {"solveUs", micros}
+                }},
+                {"unplacedLessons", listed}
+            }}
+        };
+    }
+
+private:
+    using Entry = std::tuple<uint32_t, int64_t, EntityId>;  // Blocks left, minus degree, lesson
+
+    const ProblemModel& model;
+    const FeasibilityMatrices& feasibility;
+    const LessonDemand& demand;
+    const LessonDomains& domains;
+    const ConflictGraph& graph;
+    const TimeIndex& times;
+    size_t blockCount;
+    size_t blockWords;
+    size_t roomWords;
+    int maxPerDay;
+
+    std::vector<EntityId> blockOf;             // Per lesson, NO_ENTITY while unplaced
+    std::vector<EntityId> teacherOf;
+    std::vector<EntityId> roomOf;
+    std::vector<EntityId> requirementTeacher;  // Teacher of the requirement's first placed lesson
+    std::vector<uint32_t> available;           // Per lesson: domain blocks not taken by placed neighbours
+    BitMatrix blocked;                         // Lessons x time blocks taken by placed neighbours
+    BitMatrix busyTeachers;                    // Time blocks x teachers, marked on every overlapping block
+    BitMatrix busyRooms;
+    BitMatrix busyGroups;
+    std::vector<uint16_t> dayLessons;          // Requirements x days
+    std::vector<uint32_t> teacherLoad;
+    std::vector<uint64_t> freeRooms;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    std::vector<bool> givenUp;  // No block was found; not retried
+    std::vector<EntityId> unplaced;
+    size_t placed = 0;
+    size_t teacherChanges = 0;
+
+    /**
+     * @brief Places a lesson, at only one block if given
+     * @return Whether a block with a free group, teacher and room was found
+     */
+    bool place(EntityId u, EntityId onlyBlock) {
+        size_t r = graph.requirementOf(u);
+        const LessonRequirement& requirement = demand.requirements()[r];
+        EntityId lesson = u - graph.firstLesson(r);
+
+        // The same lesson of parallel sections shares a block
+        EntityId aligned = NO_ENTITY;
+        if (requirement.parallel) {
+            size_t first = r - requirement.section;
+            for (size_t s = first; s < first + requirement.sections; ++s) {
+                EntityId sibling = graph.firstLesson(s) + lesson;
+                if (s != r && blockOf[sibling] != NO_ENTITY) {
+                    aligned = blockOf[sibling];
+                    break;
+                }
+            }
+        }
+
+        const uint64_t* domain = domains.timeBlocks().row(r);
+        const uint64_t* taken = blocked.row(u);
+        for (int pass = 0; pass < 2; ++pass) {
+            // First keep the requirement's teacher; failing that, any teacher of the domain
+            if (pass == 1 && requirementTeacher[r] == NO_ENTITY) {
+                break;
+            }
+            bool anyTeacher = pass == 1 || requirementTeacher[r] == NO_ENTITY;
+
+            EntityId best = NO_ENTITY;
+            EntityId bestTeacher = NO_ENTITY;
+            EntityId bestRoom = NO_ENTITY;
+            std::pair<bool, uint16_t> bestScore{true, UINT16_MAX};
+            for (EntityId b = 0; b < blockCount; ++b) {
+                if (onlyBlock != NO_ENTITY && b != onlyBlock) {
+                    continue;
+                }
+                if (!((domain[b / 64] >> (b % 64)) & 1) || ((taken[b / 64] >> (b % 64)) & 1)) {
+                    continue;
+                }
+                uint16_t onDay = dayLessons[r * model.days().size() + model.timeBlocks()[b].day];
+                std::pair<bool, uint16_t> score{b != aligned, onDay};
+                if (!(score < bestScore) || (maxPerDay > 0 && onDay >= maxPerDay)) {
+                    continue;
+                }
+                // Parallel sections of one group share the aligned block
+                if (b != aligned && BitKernels::intersects(model.relatedGroups().row(requirement.group),
+                                                           busyGroups.row(b), busyGroups.rowWords())) {
+                    continue;
+                }
+                EntityId teacher = pickTeacher(r, b, anyTeacher);
+                EntityId room = teacher == NO_ENTITY ? NO_ENTITY : pickRoom(r, b, requirement.students);
+                if (room == NO_ENTITY) {
+                    continue;
+                }
+                best = b;
+                bestTeacher = teacher;
+                bestRoom = room;
+                bestScore = score;
+            }
+
+            if (best != NO_ENTITY) {
+                teacherChanges += requirementTeacher[r] != NO_ENTITY && bestTeacher != requirementTeacher[r];
+                commit(u, r, best, bestTeacher, bestRoom);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    EntityId pickTeacher(size_t r, EntityId b, bool anyTeacher) const {
+        if (!anyTeacher) {
+            EntityId t = requirementTeacher[r];
+            return feasibility.teacherAvailable(t, b) && !busyTeachers.test(b, t) ? t : NO_ENTITY;
+        }
+        EntityId best = NO_ENTITY;
+        for (uint32_t t : domains.teachers().columnsOf(r)) {
+            if (feasibility.teacherAvailable(t, b) && !busyTeachers.test(b, t) &&
+                (best == NO_ENTITY || teacherLoad[t] < teacherLoad[best])) {
+                best = t;
+            }
+        }
+        return best;
+    }
+
+    EntityId pickRoom(size_t r, EntityId b, uint32_t students) {
+        BitKernels::andInto(freeRooms.data(), domains.rooms().row(r), feasibility.timeBlockRooms().row(b), roomWords);
+        BitKernels::andNotAssign(freeRooms.data(), busyRooms.row(b), roomWords);
+        EntityId best = NO_ENTITY;
+        for (size_t w = 0; w < roomWords; ++w) {
+            for (uint64_t word = freeRooms[w]; word; word &= word - 1) {
+                EntityId room = static_cast<EntityId>(w * 64 + __builtin_ctzll(word));
+                if (best == NO_ENTITY || fitsBetter(room, best, students)) {
+                    best = room;
+                }
+            }
+        }
+        return best;
+    }
+
+    // Seating everyone beats not; among rooms that do the smallest wins, among those that do not the largest
+    bool fitsBetter(EntityId room, EntityId than, uint32_t students) const {
+        int capacity = model.rooms()[room].capacity;
+        int other = model.rooms()[than].capacity;
+        bool fits = capacity >= static_cast<int>(students);
+        bool otherFits = other >= static_cast<int>(students);
+        if (fits != otherFits) {
+            return fits;
+        }
+        return fits ? capacity < other : capacity > other;
+    }
+
+    void commit(EntityId u, size_t r, EntityId b, EntityId teacher, EntityId room) {
+        const LessonRequirement& requirement = demand.requirements()[r];
+        blockOf[u] = b;
+        teacherOf[u] = teacher;
+        roomOf[u] = room;
+        if (requirementTeacher[r] == NO_ENTITY) {
+            requirementTeacher[r] = teacher;
+        }
+        ++teacherLoad[teacher];
+        ++dayLessons[r * model.days().size() + model.timeBlocks()[b].day];
+        ++placed;
+
+        for (EntityId o : times.overlapping(b)) {
+            busyTeachers.set(o, teacher);
+            busyRooms.set(o, room);
+            busyGroups.set(o, requirement.group);
+        }
+
+        // Neighbours lose this block and the blocks overlapping it; a repeated visit changes nothing
+        graph.forEachNeighbour(u, [&](EntityId v) {
+            if (blockOf[v] != NO_ENTITY) {
+                return;
+            }
+            const uint64_t* domain = domains.timeBlocks().row(graph.requirementOf(v));
+            bool changed = false;
+            for (EntityId o : times.overlapping(b)) {
+                if (((domain[o / 64] >> (o % 64)) & 1) && !blocked.test(v, o)) {
+                    blocked.set(v, o);
+                    --available[v];
+                    changed = true;
+                }
+            }
+            if (changed) {
+                open.push({available[v], -static_cast<int64_t>(graph.degree(v)), v});
+            }
+        });
+
+        // Place the same lesson of the other parallel sections right away, at this block
+        if (requirement.parallel) {
+            EntityId lesson = u - graph.firstLesson(r);
+            size_t first = r - requirement.section;
+            for (size_t s = first; s < first + requirement.sections; ++s) {
+                EntityId sibling = graph.firstLesson(s) + lesson;
+                if (s != r && blockOf[sibling] == NO_ENTITY && !givenUp[sibling]) {
+                    place(sibling, b);
+                }
+            }
+        }
+    }
+};
+
+json GreedySolver::solve(const CompiledDataset& compiled, const json& config, const ShouldStop& shouldStop,
+                         const Report& report) {
+    auto started = std::chrono::steady_clock::now();
+    GreedyConstruction construction(compiled, config);
+    construction.run(shouldStop, report);
+    int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count();
+
+    Assignment schedule = construction.assignment();
+    Evaluation evaluation = ScheduleEvaluator::evaluate(*compiled.model, *compiled.constraints, schedule);
+    return construction.toResult(schedule, evaluation, micros);
+}
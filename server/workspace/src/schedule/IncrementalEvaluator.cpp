@@ -0,0 +1,285 @@
+#include "schedule/IncrementalEvaluator.hpp"
+#include <algorithm>
+
+namespace {
+    // A swap moves two events, a reassignment one
+    constexpr size_t MAX_RELOCATIONS = 2;
+}
+
+IncrementalEvaluator::IncrementalEvaluator(const ProblemModel& model, const CompiledConstraints& constraints,
+                                           Assignment assignment)
+    : constraints(constraints), tables(constraints.tables()), schedule(std::move(assignment)), occupancyIndex(model),
+      dayCount(std::max<size_t>(1, model.days().size())), eventRules(constraints.rulesFor(RuleScope::Event, 0)) {
+    const std::vector<ConstraintRule>& rules = constraints.rules();
+    current.violations.assign(rules.size(), 0);
+    weights.reserve(rules.size());
+    tiers.reserve(rules.size());
+    for (const ConstraintRule& rule : rules) {
+        weights.push_back(ruleBase(rule).weight);
+        tiers.push_back(static_cast<size_t>(ruleBase(rule).tier));
+    }
+
+    scopes = {
+        {RuleScope::TeacherDay, true, true, false, {}, {}},
+        {RuleScope::TeacherWeek, false, true, false, {}, {}},
+        {RuleScope::GroupDay, true, false, false, {}, {}},
+        {RuleScope::GroupWeek, false, false, false, {}, {}}
+    };
+    for (BucketScope& scope : scopes) {
+        scope.active = constraints.hasRules(scope.scope);
+        if (!scope.active) {
+            continue;
+        }
+        size_t owners = scope.byTeacher ? model.teachers().size() : model.groups().size();
+        size_t buckets = owners * (scope.daily ? dayCount : 1);
+        scope.timelines.resize(buckets);
+        scope.cached.resize(buckets);
+        for (size_t b = 0; b < buckets; ++b) {
+            scope.cached[b].assign(constraints.rulesFor(scope.scope, ownerOf(scope, b)).size(), 0);
+        }
+    }
+
+    for (EntityId r : constraints.rulesFor(RuleScope::Global, 0)) {
+        counters.push_back({r, std::vector<uint32_t>(model.timeBlocks().size(), 0)});
+    }
+
+    for (uint32_t e = 0; e < schedule.events.size(); ++e) {
+        const Placement& event = schedule.events[e];
+        changeEventRules(event, 1);
+        changeCounters(event, true, true);
+        occupancyIndex.add(event);
+        for (BucketScope& scope : scopes) {
+            if (scope.active) {
+                insert(scope, bucketOf(scope, event), e);
+            }
+        }
+    }
+    for (size_t s = 0; s < scopes.size(); ++s) {
+        for (size_t b = 0; b < scopes[s].timelines.size(); ++b) {
+            if (!scopes[s].timelines[b].empty()) {
+                rerun(s, b);
+            }
+        }
+    }
+    syncClashes();
+}
+
+int64_t IncrementalEvaluator::delta(const Move& move) {
+    int64_t change = apply(move);
+    undo(move);
+    return change;
+}
+
+int64_t IncrementalEvaluator::apply(const Move& move) {
+    Relocation moves[MAX_RELOCATIONS];
+    size_t count = 0;
+    const Placement& first = schedule.events[move.event];
+
+    frames.push_back({placementLog.size(), violationLog.size(), cachedLog.size()});
+    if (move.kind == Move::Kind::Reassign) {
+        moves[count++] = {move.event, move.timeBlock == NO_ENTITY ? first.timeBlock : move.timeBlock,
+                          move.room == NO_ENTITY ? first.room : move.room};
+        placementLog.push_back({move.event, first.timeBlock, first.room});
+    } else {
+        const Placement& second = schedule.events[move.other];
+        moves[count++] = {move.event, second.timeBlock, second.room};
+        moves[count++] = {move.other, first.timeBlock, first.room};
+        placementLog.push_back({move.event, first.timeBlock, first.room});
+        placementLog.push_back({move.other, second.timeBlock, second.room});
+    }
+    return relocate(moves, count, true);
+}
+
+void IncrementalEvaluator::undo(const Move& move) {
+    Frame frame = frames.back();
+    frames.pop_back();
+
+    size_t count = move.kind == Move::Kind::Swap ? 2 : 1;
+    Relocation moves[MAX_RELOCATIONS];
+    std::copy(placementLog.begin() + frame.placements, placementLog.begin() + frame.placements + count, moves);
+    placementLog.resize(frame.placements);
+    relocate(moves, count, false);
+
+    for (size_t i = violationLog.size(); i-- > frame.violations;) {
+        countViolations(violationLog[i].first, -violationLog[i].second);
+    }
+    violationLog.resize(frame.violations);
+
+    for (size_t i = cachedLog.size(); i-- > frame.cached;) {
+        const CachedChange& change = cachedLog[i];
+        scopes[change.scope].cached[change.bucket][change.slot] = change.previous;
+    }
+    cachedLog.resize(frame.cached);
+}
+
+void IncrementalEvaluator::commit() {
+    frames.clear();
+    placementLog.clear();
+    violationLog.clear();
+    cachedLog.clear();
+}
+
+int64_t IncrementalEvaluator::relocate(const Relocation* moves, size_t count, bool evaluate) {
+    int64_t before = current.cost;
+    bool timeChanged[MAX_RELOCATIONS];
+    touched.clear();
+    auto touch = [&](size_t scope, size_t bucket) {
+        std::pair<size_t, size_t> key{scope, bucket};
+        if (std::find(touched.begin(), touched.end(), key) == touched.end()) {
+            touched.push_back(key);
+        }
+    };
+
+    // Take the events out of everything that depends on where they are
+    for (size_t i = 0; i < count; ++i) {
+        const Placement& event = schedule.events[moves[i].event];
+        timeChanged[i] = event.timeBlock != moves[i].timeBlock;
+        occupancyIndex.remove(event);
+        if (evaluate) {
+            changeEventRules(event, -1);
+        }
+        if (!timeChanged[i]) {
+            continue;
+        }
+        changeCounters(event, false, evaluate);
+        for (size_t s = 0; s < scopes.size(); ++s) {
+            if (scopes[s].active) {
+                size_t bucket = bucketOf(scopes[s], event);
+                erase(scopes[s], bucket, moves[i].event);
+                touch(s, bucket);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        schedule.events[moves[i].event].timeBlock = moves[i].timeBlock;
+        schedule.events[moves[i].event].room = moves[i].room;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const Placement& event = schedule.events[moves[i].event];
+        occupancyIndex.add(event);
+        if (evaluate) {
+            changeEventRules(event, 1);
+        }
+        if (!timeChanged[i]) {
+            continue;
+        }
+        changeCounters(event, true, evaluate);
+        for (size_t s = 0; s < scopes.size(); ++s) {
+            if (scopes[s].active) {
+                size_t bucket = bucketOf(scopes[s], event);
+                insert(scopes[s], bucket, moves[i].event);
+                touch(s, bucket);
+            }
+        }
+    }
+
+    if (evaluate) {
+        for (const auto& [scope, bucket] : touched) {
+            rerun(scope, bucket);
+        }
+    }
+    syncClashes();
+    return current.cost - before;
+}
+
+size_t IncrementalEvaluator::bucketOf(const BucketScope& scope, const Placement& event) const {
+    size_t owner = scope.byTeacher ? event.teacher : event.group;
+    return scope.daily ? owner * dayCount + tables.blockDay[event.timeBlock] : owner;
+}
+
+EntityId IncrementalEvaluator::ownerOf(const BucketScope& scope, size_t bucket) const {
+    return static_cast<EntityId>(scope.daily ? bucket / dayCount : bucket);
+}
+
+void IncrementalEvaluator::insert(BucketScope& scope, size_t bucket, uint32_t event) {
+    std::vector<uint32_t>& timeline = scope.timelines[bucket];
+    auto startOf = [&](uint32_t e) { return tables.blockStart[schedule.events[e].timeBlock]; };
+    auto position = std::upper_bound(timeline.begin(), timeline.end(), event, [&](uint32_t a, uint32_t b) {
+        return startOf(a) < startOf(b) || (startOf(a) == startOf(b) && a < b);
+    });
+    timeline.insert(position, event);
+}
+
+void IncrementalEvaluator::erase(BucketScope& scope, size_t bucket, uint32_t event) {
+    std::vector<uint32_t>& timeline = scope.timelines[bucket];
+    timeline.erase(std::find(timeline.begin(), timeline.end(), event));
+}
+
+void IncrementalEvaluator::rerun(size_t scopeIndex, size_t bucket) {
+    BucketScope& scope = scopes[scopeIndex];
+    IdRange rules = constraints.rulesFor(scope.scope, ownerOf(scope, bucket));
+    const std::vector<uint32_t>& timeline = scope.timelines[bucket];
+    EventRange range{timeline.data(), timeline.data() + timeline.size(), schedule.events.data()};
+    std::vector<int64_t>& cached = scope.cached[bucket];
+
+    for (size_t i = 0; i < rules.size(); ++i) {
+        EntityId r = rules.first[i];
+        int64_t violations = ruleViolations(constraints.rules()[r], range, tables);
+        if (violations != cached[i]) {
+            addViolations(r, violations - cached[i]);
+            if (!frames.empty()) {
+                cachedLog.push_back({static_cast<uint32_t>(scopeIndex), static_cast<uint32_t>(i), bucket, cached[i]});
+            }
+            cached[i] = violations;
+        }
+    }
+}
+
+void IncrementalEvaluator::changeEventRules(const Placement& event, int64_t sign) {
+    for (EntityId r : eventRules) {
+        int64_t violations = ruleViolations(constraints.rules()[r], event, tables);
+        if (violations != 0) {
+            addViolations(r, sign * violations);
+        }
+    }
+}
+
+void IncrementalEvaluator::changeCounters(const Placement& event, bool add, bool evaluate) {
+    for (BlockCounter& counter : counters) {
+        // Global rules are SameTimeSlot only; violations are the time blocks used beyond the first
+        const auto* rule = std::get_if<SameTimeRule>(&constraints.rules()[counter.rule]);
+        if (!rule || !rule->matches(event)) {
+            continue;
+        }
+        int64_t before = std::max<int64_t>(0, counter.usedBlocks - 1);
+        uint32_t& events = counter.events[event.timeBlock];
+        if (add) {
+            counter.usedBlocks += events++ == 0 ? 1 : 0;
+        } else {
+            counter.usedBlocks -= --events == 0 ? 1 : 0;
+        }
+        int64_t after = std::max<int64_t>(0, counter.usedBlocks - 1);
+        if (evaluate && after != before) {
+            addViolations(counter.rule, after - before);
+        }
+    }
+}
+
+void IncrementalEvaluator::syncClashes() {
+    // Clash totals are exact in the index after apply and undo alike, so they are copied, not logged
+    size_t hard = static_cast<size_t>(PenaltyTier::Hard);
+    for (size_t r = 0; r < RESOURCE_KINDS; ++r) {
+        int64_t change = occupancyIndex.clashes(static_cast<Resource>(r)) - current.clashes[r];
+        current.clashes[r] += change;
+        current.tierViolations[hard] += change;
+        current.tierCost[hard] += change * CLASH_WEIGHT;
+        current.cost += change * CLASH_WEIGHT;
+    }
+}
+
+void IncrementalEvaluator::addViolations(EntityId rule, int64_t violations) {
+    if (!frames.empty()) {
+        violationLog.emplace_back(rule, violations);
+    }
+    countViolations(rule, violations);
+}
+
+void IncrementalEvaluator::countViolations(EntityId rule, int64_t violations) {
+    int64_t cost = violations * weights[rule];
+    current.violations[rule] += violations;
+    current.tierViolations[tiers[rule]] += violations;
+    current.tierCost[tiers[rule]] += cost;
+    current.cost += cost;
+}
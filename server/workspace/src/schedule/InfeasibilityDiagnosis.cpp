@@ -0,0 +1,388 @@
+#include "schedule/InfeasibilityDiagnosis.hpp"
+#include "schedule/BitKernels.hpp"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <numeric>
+#include <queue>
+
+namespace {
+    constexpr int64_t UNLIMITED = std::numeric_limits<int64_t>::max() / 4;
+
+    /**
+     * @brief Dinic max flow over a small layered network: source, requirements, resources, sink
+     */
+    class FlowNetwork {
+    public:
+        explicit FlowNetwork(size_t nodes) : adjacency(nodes), level(nodes), cursor(nodes) {
+        }
+
+        void add(uint32_t from, uint32_t to, int64_t capacity) {
+            adjacency[from].push_back(static_cast<uint32_t>(edges.size()));
+            edges.push_back({to, capacity});
+            adjacency[to].push_back(static_cast<uint32_t>(edges.size()));
+            edges.push_back({from, 0});
+        }
+
+        int64_t maxFlow(uint32_t source, uint32_t sink) {
+            int64_t flow = 0;
+            while (levels(source, sink)) {
+                std::fill(cursor.begin(), cursor.end(), 0);
+                while (int64_t pushed = push(source, sink, UNLIMITED)) {
+                    flow += pushed;
+                }
+            }
+            return flow;
+        }
+
+        /**
+         * @brief Nodes still reachable from the source in the residual network: the source side of a minimum cut
+         */
+        std::vector<bool> sourceSide(uint32_t source) {
+            levels(source, NO_ENTITY);
+            std::vector<bool> side(level.size());
+            for (size_t node = 0; node < level.size(); ++node) {
+                side[node] = level[node] >= 0;
+            }
+            return side;
+        }
+
+    private:
+        struct Edge {
+            uint32_t to;
+            int64_t capacity;  // Residual
+        };
+
+        std::vector<Edge> edges;  // Each edge followed by its reverse
+        std::vector<std::vector<uint32_t>> adjacency;
+        std::vector<int32_t> level;
+        std::vector<size_t> cursor;
+
+        bool levels(uint32_t source, uint32_t sink) {
+            std::fill(level.begin(), level.end(), -1);
+            std::queue<uint32_t> open;
+            level[source] = 0;
+            open.push(source);
+            while (!open.empty()) {
+                uint32_t node = open.front();
+                open.pop();
+                for (uint32_t e : adjacency[node]) {
+                    if (edges[e].capacity > 0 && level[edges[e].to] < 0) {
+                        level[edges[e].to] = level[node] + 1;
+                        open.push(edges[e].to);
+                    }
+                }
+            }
+            return sink != NO_ENTITY && level[sink] >= 0;
+        }
+
+        int64_t push(uint32_t node, uint32_t sink, int64_t limit) {
+            if (node == sink) {
+                return limit;
+            }
+            for (size_t& i = cursor[node]; i < adjacency[node].size(); ++i) {
+                Edge& edge = edges[adjacency[node][i]];
+                if (edge.capacity <= 0 || level[edge.to] != level[node] + 1) {
+                    continue;
+                }
+                if (int64_t pushed = push(edge.to, sink, std::min(limit, edge.capacity))) {
+                    edge.capacity -= pushed;
+                    edges[adjacency[node][i] ^ 1].capacity += pushed;
+                    return pushed;
+                }
+            }
+            return 0;
+        }
+    };
+}
+
+/**
+ * @brief Computes an InfeasibilityDiagnosis; one instance per dataset version
+ */
+class Diagnoser {
+public:
+    Diagnoser(const ProblemModel& model, const FeasibilityMatrices& feasibility, const LessonDemand& demand,
+              InfeasibilityDiagnosis& diagnosis)
+        : model(model), feasibility(feasibility), demand(demand), diagnosis(diagnosis),
+          blockWords(BitMatrix::wordsFor(model.timeBlocks().size())) {
+    }
+
+    void run() {
+        byEnd.resize(model.timeBlocks().size());
+        std::iota(byEnd.begin(), byEnd.end(), 0);
+        std::stable_sort(byEnd.begin(), byEnd.end(), [this](EntityId a, EntityId b) {
+            return model.timeBlocks()[a].weekEnd < model.timeBlocks()[b].weekEnd;
+        });
+
+        checkGroups();
+        checkTeachers();
+        checkRooms();
+        checkBlocks();
+    }
+
+private:
+    const ProblemModel& model;
+    const FeasibilityMatrices& feasibility;
+    const LessonDemand& demand;
+    InfeasibilityDiagnosis& diagnosis;
+    size_t blockWords;
+    std::vector<EntityId> byEnd;  // Time blocks by end of week minute
+
+    /**
+     * @return Most blocks of a row that can be used without two overlapping (earliest end first)
+     */
+    int64_t disjointBlocks(const uint64_t* blocks) const {
+        int64_t count = 0;
+        int32_t end = std::numeric_limits<int32_t>::min();
+        for (EntityId b : byEnd) {
+            const auto& block = model.timeBlocks()[b];
+            if ((blocks[b / 64] >> (b % 64)) & 1 && block.weekStart >= end) {
+                ++count;
+                end = block.weekEnd;
+            }
+        }
+        return count;
+    }
+
+    json describe(size_t r) const {
+        const LessonRequirement& requirement = demand.requirements()[r];
+        return {
+            {"subjectId", model.subjectIds().name(requirement.subject)},
+            {"groupId", model.groupIds().name(requirement.group)},
+            {"section", requirement.section}
+        };
+    }
+
+    void certify(const char* check, int64_t need, int64_t supply, const std::vector<size_t>& requirements,
+                 const std::vector<EntityId>& resources, const IdTable& names, const std::string& message) {
+        json listedRequirements = json::array();
+        json listedResources = json::array();
+        for (size_t i = 0; i < requirements.size() && i < InfeasibilityDiagnosis::MAX_LISTED; ++i) {
+            listedRequirements.push_back(describe(requirements[i]));
+        }
+        for (size_t i = 0; i < resources.size() && i < InfeasibilityDiagnosis::MAX_LISTED; ++i) {
+            listedResources.push_back(names.name(resources[i]));
+        }
+        diagnosis.certificateList.push_back({
+            {"check", check},
+            {"message", message},
+            {"demand", need},
+            {"supply", supply},
+            {"requirements", listedRequirements},
+            {"resources", listedResources},
+            {"truncated", requirements.size() > InfeasibilityDiagnosis::MAX_LISTED ||
+                          resources.size() > InfeasibilityDiagnosis::MAX_LISTED}
+        });
+    }
+
+    void checkGroups() {
+        const auto& requirements = demand.requirements();
+        std::vector<uint64_t> blocks(blockWords);
+        std::vector<size_t> chainRequirements;
+        std::vector<EntityId> chain;
+        size_t failed = 0;
+
+        for (EntityId g = 0; g < model.groups().size(); ++g) {
+            const uint64_t* ancestors = model.groupAncestors().row(g);
+            chain = model.groupAncestors().columnsOf(g);
+            chain.insert(chain.begin(), g);
+            std::fill(blocks.begin(), blocks.end(), 0);
+            for (EntityId a : chain) {
+                BitKernels::orAssign(blocks.data(), feasibility.groupTimeBlocks().row(a), blockWords);
+            }
+
+            int64_t lessons = 0;
+            chainRequirements.clear();
+            for (size_t r = 0; r < requirements.size(); ++r) {
+                const LessonRequirement& requirement = requirements[r];
+                if (requirement.group != g && !((ancestors[requirement.group / 64] >> (requirement.group % 64)) & 1)) {
+                    continue;
+                }
+                chainRequirements.push_back(r);
+                // Parallel sections of one group share their blocks
+                const LessonRequirement* previous = r > 0 ? &requirements[r - 1] : nullptr;
+                bool sameLesson = requirement.parallel && previous && previous->parallel &&
+                                  previous->subject == requirement.subject && previous->group == requirement.group;
+                if (!sameLesson) {
+                    lessons += requirement.lessons;
+                }
+            }
+
+            int64_t supply = disjointBlocks(blocks.data());
+            if (lessons <= supply) {
+                continue;
+            }
+            if (++failed <= InfeasibilityDiagnosis::MAX_CERTIFICATES) {
+                certify("group_time", lessons, supply, chainRequirements, chain, model.groupIds(),
+                        "Group " + model.groupIds().name(g) + " has " + std::to_string(lessons) +
+                        " lessons but only " + std::to_string(supply) + " non-overlapping time blocks");
+            }
+        }
+        diagnosis.checkList["group_time"] = {{"groups", model.groups().size()}, {"failed", failed}};
+    }
+
+    void checkTeachers() {
+        const auto& requirements = demand.requirements();
+        std::vector<std::vector<EntityId>> neighbours(requirements.size());
+        for (size_t r = 0; r < requirements.size(); ++r) {
+            for (EntityId t : demand.candidates(requirements[r])) {
+                neighbours[r].push_back(t);
+            }
+        }
+        std::vector<int64_t> capacity(model.teachers().size());
+        for (EntityId t = 0; t < capacity.size(); ++t) {
+            capacity[t] = disjointBlocks(feasibility.teacherTimeBlocks().row(t));
+        }
+        checkFlow("teacher_hours", neighbours, capacity, model.teacherIds(), "teachers");
+    }
+
+    void checkRooms() {
+        const auto& requirements = demand.requirements();
+        std::vector<std::vector<EntityId>> neighbours(requirements.size());
+        for (size_t r = 0; r < requirements.size(); ++r) {
+            for (uint32_t room : feasibility.subjectRooms().columnsOf(requirements[r].subject)) {
+                neighbours[r].push_back(room);
+            }
+        }
+        BitMatrix roomBlocks = feasibility.timeBlockRooms().transposed();
+        std::vector<int64_t> capacity(model.rooms().size());
+        for (EntityId room = 0; room < capacity.size(); ++room) {
+            capacity[room] = disjointBlocks(roomBlocks.row(room));
+        }
+        checkFlow("room_supply", neighbours, capacity, model.roomIds(), "rooms with the required features");
+    }
+
+    void checkBlocks() {
+        const auto& requirements = demand.requirements();
+        std::vector<std::vector<EntityId>> neighbours(requirements.size());
+        for (size_t r = 0; r < requirements.size(); ++r) {
+            for (uint32_t b : feasibility.groupTimeBlocks().columnsOf(requirements[r].group)) {
+                neighbours[r].push_back(b);
+            }
+        }
+        BitMatrix blockTeachers = feasibility.teacherTimeBlocks().transposed();
+        const BitMatrix& blockRooms = feasibility.timeBlockRooms();
+        std::vector<int64_t> capacity(model.timeBlocks().size());
+        for (EntityId b = 0; b < capacity.size(); ++b) {
+            capacity[b] = static_cast<int64_t>(std::min(
+                BitKernels::popcount(blockRooms.row(b), blockRooms.rowWords()),
+                BitKernels::popcount(blockTeachers.row(b), blockTeachers.rowWords())));
+        }
+        checkFlow("block_supply", neighbours, capacity, model.timeBlockIds(), "time blocks");
+    }
+
+    /**
+     * @brief Routes every lesson to a resource; on a shortfall, certifies each deficient part of the minimum cut
+     */
+    void checkFlow(const char* check, const std::vector<std::vector<EntityId>>& neighbours,
+                   const std::vector<int64_t>& capacity, const IdTable& names, const char* resourceKind) {
+        const auto& requirements = demand.requirements();
+        uint32_t source = 0;
+        uint32_t firstResource = static_cast<uint32_t>(1 + requirements.size());
+        uint32_t sink = static_cast<uint32_t>(firstResource + capacity.size());
+        FlowNetwork network(sink + 1);
+
+        int64_t lessons = 0;
+        for (size_t r = 0; r < requirements.size(); ++r) {
+            lessons += requirements[r].lessons;
+            network.add(source, static_cast<uint32_t>(1 + r), requirements[r].lessons);
+            for (EntityId resource : neighbours[r]) {
+                network.add(static_cast<uint32_t>(1 + r), firstResource + resource, UNLIMITED);
+            }
+        }
+        for (EntityId resource = 0; resource < capacity.size(); ++resource) {
+            network.add(firstResource + resource, sink, capacity[resource]);
+        }
+
+        int64_t flow = network.maxFlow(source, sink);
+        diagnosis.checkList[check] = {{"demand", lessons}, {"max_flow", flow}};
+        if (flow >= lessons) {
+            return;
+        }
+
+        // Requirements on the source side reach only resources on it, which are all full; split them into
+        // independent parts so each bottleneck gets its own certificate
+        std::vector<bool> side = network.sourceSide(source);
+        std::vector<uint32_t> parent(sink + 1);
+        std::iota(parent.begin(), parent.end(), 0);
+        auto find = [&parent](uint32_t node) {
+            while (parent[node] != node) {
+                node = parent[node] = parent[parent[node]];
+            }
+            return node;
+        };
+        for (size_t r = 0; r < requirements.size(); ++r) {
+            if (side[1 + r]) {
+                for (EntityId resource : neighbours[r]) {
+                    parent[find(firstResource + resource)] = find(static_cast<uint32_t>(1 + r));
+                }
+            }
+        }
+
+        struct Part {
+            int64_t need = 0;
+            int64_t supply = 0;
+            std::vector<size_t> requirements;
+            std::vector<EntityId> resources;
+        };
+        std::vector<Part> parts;
+        std::vector<size_t> partOf(sink + 1, SIZE_MAX);
+        auto partFor = [&](uint32_t node) -> Part& {
+            uint32_t root = find(node);
+            if (partOf[root] == SIZE_MAX) {
+                partOf[root] = parts.size();
+                parts.emplace_back();
+            }
+            return parts[partOf[root]];
+        };
+        for (size_t r = 0; r < requirements.size(); ++r) {
+            if (side[1 + r] && requirements[r].lessons > 0) {
+                Part& part = partFor(static_cast<uint32_t>(1 + r));
+                part.need += requirements[r].lessons;
+                part.requirements.push_back(r);
+            }
+        }
+        for (EntityId resource = 0; resource < capacity.size(); ++resource) {
+            if (side[firstResource + resource] && partOf[find(firstResource + resource)] != SIZE_MAX) {
+                Part& part = partFor(firstResource + resource);
+                part.supply += capacity[resource];
+                part.resources.push_back(resource);
+            }
+        }
+
+        std::stable_sort(parts.begin(), parts.end(), [](const Part& a, const Part& b) {
+            return a.need - a.supply > b.need - b.supply;
+        });
+        size_t certified = 0;
+        for (const Part& part : parts) {
+            if (part.need <= part.supply || certified == InfeasibilityDiagnosis::MAX_CERTIFICATES) {
+                continue;
+            }
+            ++certified;
+            certify(check, part.need, part.supply, part.requirements, part.resources, names,
+                    std::to_string(part.need) + " lessons of " + std::to_string(part.requirements.size()) +
+                    " requirement(s), but the " + resourceKind + " they can use have room for " +
+                    std::to_string(part.supply));
+        }
+    }
+};
+
+std::shared_ptr<const InfeasibilityDiagnosis> InfeasibilityDiagnosis::diagnose(const ProblemModel& model,
+                                                                               const FeasibilityMatrices& feasibility,
+                                                                               const LessonDemand& demand) {
+    auto started = std::chrono::steady_clock::now();
+    auto diagnosis = std::make_shared<InfeasibilityDiagnosis>();
+    Diagnoser(model, feasibility, demand, *diagnosis).run();
+    diagnosis->diagnoseMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count();
+    return diagnosis;
+}
+
+json InfeasibilityDiagnosis::toJson() const {
+    return {
+        {"feasible", feasible()},
+        {"certificates", certificateList},
+        {"checks", checkList},
+        {"diagnose_us", diagnoseMicros}
+    };
+}
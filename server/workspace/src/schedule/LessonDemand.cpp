@@ -0,0 +1,219 @@
+#include "schedule/LessonDemand.hpp"
+#include "schedule/ConstraintData.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace {
+    constexpr int DEFAULT_LESSON_MINUTES = 60;
+
+    struct Split {
+        int maxSubgroupSize;
+        bool parallel;
+    };
+}
+
+/**
+ * @brief Builds a LessonDemand; one instance per expansion
+ */
+class DemandExpander {
+public:
+    DemandExpander(const ProblemModel& model, LessonDemand& demand)
+        : model(model), demand(demand) {
+    }
+
+    void run() {
+        demand.minutesPerLesson = commonDuration();
+        indexTeachers();
+        children.resize(model.groups().size());
+        for (EntityId g = 0; g < model.groups().size(); ++g) {
+            if (model.groups()[g].parent != NO_ENTITY) {
+                children[model.groups()[g].parent].push_back(g);
+            }
+        }
+        readSplits();
+
+        for (EntityId s = 0; s < model.subjects().size(); ++s) {
+            float minutes = model.subjects()[s].hoursPerWeek * 60.0f;
+            if (!(minutes > 0.0f)) {
+                continue;
+            }
+            // Rounded up, with slack for hours like 0.75 that are not exact in binary
+            double lessons = std::ceil(minutes / demand.minutesPerLesson - 1e-4);
+            uint16_t count = static_cast<uint16_t>(std::min<double>(lessons, UINT16_MAX));
+
+            for (EntityId g = 0; g < model.groups().size(); ++g) {
+                if (model.groups()[g].parent != NO_ENTITY) {
+                    continue;
+                }
+                auto split = splits.find({g, s});
+                if (split == splits.end()) {
+                    add(s, g, count, 0, 1, model.groups()[g].size, false);
+                } else if (!children[g].empty()) {
+                    uint16_t sections = static_cast<uint16_t>(children[g].size());
+                    for (uint16_t i = 0; i < sections; ++i) {
+                        EntityId child = children[g][i];
+                        add(s, child, count, i, sections, model.groups()[child].size, split->second.parallel);
+                    }
+                } else {
+                    int size = std::max(0, model.groups()[g].size);
+                    int sections = std::max(1, (size + split->second.maxSubgroupSize - 1) /
+                                                   split->second.maxSubgroupSize);
+                    sections = std::min<int>(sections, UINT16_MAX);
+                    for (int i = 0; i < sections; ++i) {
+                        int students = size / sections + (i < size % sections ? 1 : 0);
+                        add(s, g, count, static_cast<uint16_t>(i), static_cast<uint16_t>(sections), students,
+                            split->second.parallel);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    const ProblemModel& model;
+    LessonDemand& demand;
+    std::vector<uint32_t> subjectOffsets;  // Per subject, plus one, into demand.teacherIds
+    std::map<std::pair<EntityId, EntityId>, Split> splits;  // (group, subject)
+    std::vector<std::vector<EntityId>> children;            // Per group
+
+    uint16_t commonDuration() const {
+        std::map<int, size_t> counts;
+        for (const auto& block : model.timeBlocks()) {
+            int duration = block.duration > 0 ? block.duration : block.endMinute - block.startMinute;
+            if (duration > 0) {
+                ++counts[duration];
+            }
+        }
+        int common = DEFAULT_LESSON_MINUTES;
+        size_t best = 0;
+        for (const auto& [duration, count] : counts) {
+            if (count > best) {
+                common = duration;
+                best = count;
+            }
+        }
+        return static_cast<uint16_t>(std::min(common, static_cast<int>(UINT16_MAX)));
+    }
+
+    void indexTeachers() {
+        size_t subjectCount = model.subjects().size();
+        subjectOffsets.assign(subjectCount + 1, 0);
+        for (EntityId t = 0; t < model.teachers().size(); ++t) {
+            for (EntityId s : model.teacherSubjects(t)) {
+                ++subjectOffsets[s + 1];
+            }
+        }
+        for (size_t s = 0; s < subjectCount; ++s) {
+            subjectOffsets[s + 1] += subjectOffsets[s];
+        }
+        demand.teacherIds.resize(subjectOffsets.back());
+        std::vector<uint32_t> next(subjectOffsets.begin(), subjectOffsets.end() - 1);
+        for (EntityId t = 0; t < model.teachers().size(); ++t) {
+            for (EntityId s : model.teacherSubjects(t)) {
+                demand.teacherIds[next[s]++] = t;
+            }
+        }
+    }
+
+    void readSplits() {
+        std::vector<EntityId> groups;
+        std::vector<EntityId> subjects;
+        for (const auto& constraint : model.constraints()) {
+            if (constraint.type != ConstraintType::GroupSplit) {
+                continue;
+            }
+            auto data = constraint.source->find("data");
+            if (data == constraint.source->end() || !data->is_object()) {
+                continue;
+            }
+            auto maxSize = data->find("maxSubgroupSize");
+            auto parallel = data->find("parallelTeaching");
+            Split split{
+                maxSize != data->end() && maxSize->is_number() ? maxSize->get<int>() : 0,
+                parallel != data->end() && parallel->is_boolean() && parallel->get<bool>()
+            };
+
+            ConstraintData::Scope groupScope = ConstraintData::resolveIds(*data, {"groupId", "groupIds"},
+                                                                          model.groupIds(), groups);
+            ConstraintData::Scope subjectScope = ConstraintData::resolveIds(*data, {"subjectId", "subjectIds"},
+                                                                            model.subjectIds(), subjects);
+            if (groupScope == ConstraintData::Scope::All) {
+                fillAll(groups, model.groups().size());
+            }
+            if (subjectScope != ConstraintData::Scope::Listed) {
+                fillAll(subjects, model.subjects().size());
+            }
+            for (EntityId g : groups) {
+                if (split.maxSubgroupSize <= 0 && children[g].empty()) {
+                    continue;
+                }
+                for (EntityId s : subjects) {
+                    splits.emplace(std::make_pair(g, s), split);  // The first split of a pair wins
+                }
+            }
+        }
+    }
+
+    static void fillAll(std::vector<EntityId>& ids, size_t count) {
+        ids.resize(count);
+        for (EntityId i = 0; i < count; ++i) {
+            ids[i] = i;
+        }
+    }
+
+    void add(EntityId subject, EntityId group, uint16_t lessons, uint16_t section, uint16_t sections, int students,
+             bool parallel) {
+        demand.requirementList.push_back({
+            subject, group, lessons, demand.minutesPerLesson, section, sections,
+            static_cast<uint32_t>(std::max(0, students)), subjectOffsets[subject], subjectOffsets[subject + 1],
+            parallel && sections > 1
+        });
+        demand.lessonCount += lessons;
+    }
+};
+
+std::shared_ptr<const LessonDemand> LessonDemand::expand(const ProblemModel& model) {
+    auto demand = std::make_shared<LessonDemand>();
+    DemandExpander(model, *demand).run();
+    return demand;
+}
+
+json LessonDemand::toJson(const ProblemModel& model) const {
+    json items = json::array();
+    for (const LessonRequirement& requirement : requirementList) {
+        json teachers = json::array();
+        for (EntityId t : candidates(requirement)) {
+            teachers.push_back(model.teacherIds().name(t));
+        }
+        items.push_back({
+            {"subjectId", model.subjectIds().name(requirement.subject)},
+            {"groupId", model.groupIds().name(requirement.group)},
+            {"lessons", requirement.lessons},
+            {"duration", requirement.duration},
+            {"section", requirement.section},
+            {"sections", requirement.sections},
+            {"students", requirement.students},
+            {"parallel", requirement.parallel},
+            {"teacherIds", teachers}
+        });
+    }
+    return items;
+}
+
+json LessonDemand::summary(const ProblemModel& model) const {
+    json withoutTeacher = json::array();
+    EntityId last = NO_ENTITY;
+    for (const LessonRequirement& requirement : requirementList) {
+        if (requirement.teachersBegin == requirement.teachersEnd && requirement.subject != last) {
+            withoutTeacher.push_back(model.subjectIds().name(requirement.subject));
+            last = requirement.subject;
+        }
+    }
+    return {
+        {"requirements", requirementList.size()},
+        {"lessons", lessonCount},
+        {"lesson_minutes", minutesPerLesson},
+        {"subjects_without_teacher", withoutTeacher}
+    };
+}
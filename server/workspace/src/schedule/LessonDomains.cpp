@@ -0,0 +1,380 @@
+#include "schedule/LessonDomains.hpp"
+#include "schedule/BitKernels.hpp"
+#include "schedule/TimeIndex.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+    enum Dimension : size_t {
+        TIME_BLOCKS,
+        ROOMS,
+        TEACHERS
+    };
+
+    const char* dimensionName(size_t dimension) {
+        switch (dimension) {
+            case TIME_BLOCKS: return "time_blocks";
+            case ROOMS: return "rooms";
+            default: return "teachers";
+        }
+    }
+
+    double log10Size(size_t blocks, size_t rooms, size_t teachers) {
+        return std::log10(std::max<double>(1.0, static_cast<double>(blocks) * rooms * teachers));
+    }
+}
+
+/**
+ * @brief Computes LessonDomains; one instance per presolve
+ */
+class DomainPresolver {
+public:
+    DomainPresolver(const ProblemModel& model, const CompiledConstraints& constraints,
+                    const FeasibilityMatrices& feasibility, const LessonDemand& demand, LessonDomains& domains)
+        : model(model), constraints(constraints), feasibility(feasibility), demand(demand), domains(domains),
+          blockWords(BitMatrix::wordsFor(model.timeBlocks().size())),
+          roomWords(BitMatrix::wordsFor(model.rooms().size())),
+          teacherWords(BitMatrix::wordsFor(model.teachers().size())),
+          teacherRow(blockWords), reachable(blockWords), roomRow(roomWords), usableRooms(roomWords) {
+    }
+
+    void run() {
+        collectRules();
+        start();
+        propagate();
+        measure();
+    }
+
+private:
+    // A forced requirement: the blocks it takes, with their overlaps, and its only teacher if it has one
+    struct Forced {
+        size_t requirement;
+        EntityId teacher;
+        std::vector<uint64_t> blocks;
+    };
+
+    const ProblemModel& model;
+    const CompiledConstraints& constraints;
+    const FeasibilityMatrices& feasibility;
+    const LessonDemand& demand;
+    LessonDomains& domains;
+    size_t blockWords;
+    size_t roomWords;
+    size_t teacherWords;
+
+    std::vector<const TimeWindowRule*> teacherWindows;
+    std::vector<const TimeWindowRule*> groupWindows;
+    BitMatrix windowBits;  // Per entry of teacherWindows, then groupWindows
+    std::vector<const RoomRule*> roomRules;
+    std::vector<const CapacityRule*> capacityRules;
+    std::vector<const QualificationRule*> qualificationRules;
+
+    std::vector<Forced> forcedList;
+    std::vector<const char*> startReasons;  // Per requirement, set if a domain was empty from the start
+    std::vector<uint64_t> teacherRow;
+    std::vector<uint64_t> reachable;
+    std::vector<uint64_t> roomRow;
+    std::vector<uint64_t> usableRooms;
+
+    void collectRules() {
+        for (const ConstraintRule& rule : constraints.rules()) {
+            if (ruleBase(rule).tier != PenaltyTier::Hard) {
+                continue;
+            }
+            if (const auto* window = std::get_if<TimeWindowRule>(&rule)) {
+                (window->byTeacher ? teacherWindows : groupWindows).push_back(window);
+            } else if (const auto* room = std::get_if<RoomRule>(&rule)) {
+                roomRules.push_back(room);
+            } else if (const auto* capacity = std::get_if<CapacityRule>(&rule)) {
+                capacityRules.push_back(capacity);
+            } else if (const auto* qualification = std::get_if<QualificationRule>(&rule)) {
+                qualificationRules.push_back(qualification);
+            }
+        }
+
+        windowBits = BitMatrix(teacherWindows.size() + groupWindows.size(), model.timeBlocks().size());
+        for (size_t w = 0; w < windowBits.rows(); ++w) {
+            const TimeWindowRule* window = w < teacherWindows.size() ? teacherWindows[w]
+                                                                       : groupWindows[w - teacherWindows.size()];
+            for (EntityId b = 0; b < model.timeBlocks().size(); ++b) {
+                if (window->window.contains(b)) {
+                    windowBits.set(w, b);
+                }
+            }
+        }
+    }
+
+    /**
+     * Applies the windows that cover an owner and subject to a row of time blocks
+     */
+    void applyWindows(const std::vector<const TimeWindowRule*>& windows, size_t firstRow, EntityId owner,
+                      EntityId subject, uint64_t* row) const {
+        for (size_t w = 0; w < windows.size(); ++w) {
+            if (!windows[w]->owners.contains(owner) || !windows[w]->subjects.contains(subject)) {
+                continue;
+            }
+            if (windows[w]->mustBeInside) {
+                BitKernels::andAssign(row, windowBits.row(firstRow + w), blockWords);
+            } else {
+                BitKernels::andNotAssign(row, windowBits.row(firstRow + w), blockWords);
+            }
+        }
+    }
+
+    void start() {
+        const auto& requirements = demand.requirements();
+        domains.timeBits = BitMatrix(requirements.size(), model.timeBlocks().size());
+        domains.roomBits = BitMatrix(requirements.size(), model.rooms().size());
+        domains.teacherBits = BitMatrix(requirements.size(), model.teachers().size());
+        domains.forcedFlags.assign(requirements.size(), false);
+        startReasons.assign(requirements.size(), nullptr);
+
+        for (size_t r = 0; r < requirements.size(); ++r) {
+            const LessonRequirement& requirement = requirements[r];
+            uint64_t* time = domains.timeBits.row(r);
+            std::copy(feasibility.groupTimeBlocks().row(requirement.group),
+                      feasibility.groupTimeBlocks().row(requirement.group) + blockWords, time);
+            applyWindows(groupWindows, teacherWindows.size(), requirement.group, requirement.subject, time);
+
+            uint64_t* rooms = domains.roomBits.row(r);
+            std::copy(feasibility.subjectRooms().row(requirement.subject),
+                      feasibility.subjectRooms().row(requirement.subject) + roomWords, rooms);
+            for (EntityId room = 0; room < model.rooms().size(); ++room) {
+                if (!allowsRoom(requirement, room)) {
+                    domains.roomBits.reset(r, room);
+                }
+            }
+
+            for (EntityId t : demand.candidates(requirement)) {
+                if (qualified(t, requirement.subject)) {
+                    domains.teacherBits.set(r, t);
+                }
+            }
+
+            // Any empty domain empties the others during propagation; report the first cause
+            if (BitKernels::popcount(domains.teacherBits.row(r), teacherWords) == 0) {
+                startReasons[r] = "NO_TEACHER";
+            } else if (BitKernels::popcount(rooms, roomWords) == 0) {
+                startReasons[r] = "NO_ROOM";
+            } else if (BitKernels::popcount(time, blockWords) == 0) {
+                startReasons[r] = "NO_TIME_BLOCK";
+            }
+        }
+    }
+
+    bool allowsRoom(const LessonRequirement& requirement, EntityId room) const {
+        Placement placement;
+        placement.subject = requirement.subject;
+        placement.group = requirement.group;
+        placement.room = room;
+        for (const RoomRule* rule : roomRules) {
+            if (rule->violations(placement, constraints.tables()) != 0) {
+                return false;
+            }
+        }
+        for (const CapacityRule* rule : capacityRules) {
+            if (rule->violations(placement, constraints.tables()) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool qualified(EntityId teacher, EntityId subject) const {
+        Placement placement;
+        placement.subject = subject;
+        placement.teacher = teacher;
+        for (const QualificationRule* rule : qualificationRules) {
+            if (rule->violations(placement, constraints.tables()) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void propagate() {
+        const auto& requirements = demand.requirements();
+        const BitMatrix& related = model.relatedGroups();
+        bool changed = true;
+        while (changed && domains.rounds < LessonDomains::MAX_ROUNDS) {
+            changed = false;
+            ++domains.rounds;
+            collectForced();
+
+            for (size_t r = 0; r < requirements.size(); ++r) {
+                const LessonRequirement& requirement = requirements[r];
+                uint64_t* time = domains.timeBits.row(r);
+                size_t blocksBefore = BitKernels::popcount(time, blockWords);
+
+                // Blocks forced on a related group are gone, unless they are this lesson's parallel sections
+                for (const Forced& forced : forcedList) {
+                    const LessonRequirement& other = requirements[forced.requirement];
+                    bool sameLesson = other.subject == requirement.subject && other.group == requirement.group &&
+                                      requirement.parallel;
+                    if (forced.requirement != r && !sameLesson && related.test(requirement.group, other.group)) {
+                        BitKernels::andNotAssign(time, forced.blocks.data(), blockWords);
+                    }
+                }
+
+                // A block needs a teacher of the lesson who is free then
+                std::fill(reachable.begin(), reachable.end(), 0);
+                for (EntityId t : domains.teacherBits.columnsOf(r)) {
+                    teacherTime(r, t);
+                    if (BitKernels::intersects(teacherRow.data(), time, blockWords)) {
+                        BitKernels::orAssign(reachable.data(), teacherRow.data(), blockWords);
+                    } else {
+                        domains.teacherBits.reset(r, t);
+                        changed = true;
+                    }
+                }
+                BitKernels::andAssign(time, reachable.data(), blockWords);
+
+                // ... and a usable room
+                std::fill(usableRooms.begin(), usableRooms.end(), 0);
+                for (EntityId b : domains.timeBits.columnsOf(r)) {
+                    BitKernels::andInto(roomRow.data(), domains.roomBits.row(r), feasibility.timeBlockRooms().row(b),
+                                        roomWords);
+                    if (BitKernels::popcount(roomRow.data(), roomWords) == 0) {
+                        domains.timeBits.reset(r, b);
+                    } else {
+                        BitKernels::orAssign(usableRooms.data(), roomRow.data(), roomWords);
+                    }
+                }
+                size_t roomsBefore = BitKernels::popcount(domains.roomBits.row(r), roomWords);
+                BitKernels::andAssign(domains.roomBits.row(r), usableRooms.data(), roomWords);
+
+                changed = changed || BitKernels::popcount(time, blockWords) != blocksBefore ||
+                          BitKernels::popcount(domains.roomBits.row(r), roomWords) != roomsBefore;
+            }
+        }
+        collectForced();
+    }
+
+    /**
+     * Fills teacherRow with the blocks a teacher can give to requirement r
+     */
+    void teacherTime(size_t r, EntityId teacher) {
+        const LessonRequirement& requirement = demand.requirements()[r];
+        std::copy(feasibility.teacherTimeBlocks().row(teacher),
+                  feasibility.teacherTimeBlocks().row(teacher) + blockWords, teacherRow.begin());
+        applyWindows(teacherWindows, 0, teacher, requirement.subject, teacherRow.data());
+        for (const Forced& forced : forcedList) {
+            if (forced.teacher == teacher && forced.requirement != r) {
+                BitKernels::andNotAssign(teacherRow.data(), forced.blocks.data(), blockWords);
+            }
+        }
+    }
+
+    void collectForced() {
+        const auto& requirements = demand.requirements();
+        const TimeIndex& times = model.timeIndex();
+        forcedList.clear();
+        for (size_t r = 0; r < requirements.size(); ++r) {
+            size_t blocks = BitKernels::popcount(domains.timeBits.row(r), blockWords);
+            domains.forcedFlags[r] = requirements[r].lessons > 0 && blocks == requirements[r].lessons;
+            if (!domains.forcedFlags[r]) {
+                continue;
+            }
+            Forced forced{r, NO_ENTITY, std::vector<uint64_t>(blockWords, 0)};
+            for (EntityId b : domains.timeBits.columnsOf(r)) {
+                for (EntityId overlapping : times.overlapping(b)) {
+                    forced.blocks[overlapping / BitMatrix::WORD_BITS] |= uint64_t(1) << (overlapping % BitMatrix::WORD_BITS);
+                }
+            }
+            if (BitKernels::popcount(domains.teacherBits.row(r), teacherWords) == 1) {
+                forced.teacher = static_cast<EntityId>(BitKernels::firstSet(domains.teacherBits.row(r), teacherWords));
+            }
+            forcedList.push_back(std::move(forced));
+        }
+    }
+
+    void measure() {
+        const auto& requirements = demand.requirements();
+        size_t full[3] = {model.timeBlocks().size(), model.rooms().size(), model.teachers().size()};
+        for (size_t r = 0; r < requirements.size(); ++r) {
+            const LessonRequirement& requirement = requirements[r];
+            size_t sizes[3] = {
+                BitKernels::popcount(domains.timeBits.row(r), blockWords),
+                BitKernels::popcount(domains.roomBits.row(r), roomWords),
+                BitKernels::popcount(domains.teacherBits.row(r), teacherWords)
+            };
+            for (size_t d = 0; d < 3; ++d) {
+                domains.valuesBefore[d] += full[d];
+                domains.valuesAfter[d] += sizes[d];
+            }
+            domains.log10Before += requirement.lessons * log10Size(full[0], full[1], full[2]);
+            domains.log10After += requirement.lessons * log10Size(sizes[0], sizes[1], sizes[2]);
+
+            const char* reason = startReasons[r];
+            if (!reason && sizes[TIME_BLOCKS] < requirement.lessons) {
+                reason = sizes[TEACHERS] == 0 ? "NO_FREE_TEACHER" : "TOO_FEW_TIME_BLOCKS";
+            }
+            if (reason) {
+                domains.infeasibleList.push_back({
+                    {"requirement", r},
+                    {"subjectId", model.subjectIds().name(requirement.subject)},
+                    {"groupId", model.groupIds().name(requirement.group)},
+                    {"section", requirement.section},
+                    {"lessons", requirement.lessons},
+                    {"reason", reason},
+                    {dimensionName(TIME_BLOCKS), sizes[TIME_BLOCKS]},
+                    {dimensionName(ROOMS), sizes[ROOMS]},
+                    {dimensionName(TEACHERS), sizes[TEACHERS]}
+                });
+            }
+        }
+    }
+};
+
+std::shared_ptr<const LessonDomains> LessonDomains::presolve(const ProblemModel& model,
+                                                             const CompiledConstraints& constraints,
+                                                             const FeasibilityMatrices& feasibility,
+                                                             const LessonDemand& demand) {
+    auto started = std::chrono::steady_clock::now();
+    auto domains = std::make_shared<LessonDomains>();
+    DomainPresolver(model, constraints, feasibility, demand, *domains).run();
+    domains->presolveMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count();
+    return domains;
+}
+
+json LessonDomains::toJson(const ProblemModel& model) const {
+    auto names = [](const BitMatrix& bits, size_t row, const IdTable& table) {
+        json ids = json::array();
+        for (uint32_t column : bits.columnsOf(row)) {
+            ids.push_back(table.name(column));
+        }
+        return ids;
+    };
+
+    json items = json::array();
+    for (size_t r = 0; r < forcedFlags.size(); ++r) {
+        items.push_back({
+            {"timeBlockIds", names(timeBits, r, model.timeBlockIds())},
+            {"roomIds", names(roomBits, r, model.roomIds())},
+            {"teacherIds", names(teacherBits, r, model.teacherIds())},
+            {"forced", static_cast<bool>(forcedFlags[r])}
+        });
+    }
+    return items;
+}
+
+json LessonDomains::summary(const LessonDemand& demand) const {
+    size_t requirements = demand.requirements().size();
+    json sizes = json::object();
+    for (size_t d = 0; d < 3; ++d) {
+        double before = requirements ? static_cast<double>(valuesBefore[d]) / requirements : 0.0;
+        double after = requirements ? static_cast<double>(valuesAfter[d]) / requirements : 0.0;
+        sizes[dimensionName(d)] = {{"mean_before", before}, {"mean_after", after}};
+    }
+    return {
+        {"domain_sizes", sizes},
+        {"log10_search_space_before", log10Before},
+        {"log10_search_space_after", log10After},
+        {"forced_requirements", std::count(forcedFlags.begin(), forcedFlags.end(), true)},
+        {"infeasible", infeasibleList},
+        {"rounds", rounds},
+        {"presolve_us", presolveMicros}
+    };
+}
@@ -0,0 +1,57 @@
+#include "schedule/ModelCache.hpp"
+#include <chrono>
+
+ModelCache::ModelCache(MetricsRegistry& metrics)
+    : hits(metrics.counter("planner_model_cache_hits_total", {}, "Compiled dataset versions served from the cache")),
+      misses(metrics.counter("planner_model_cache_misses_total", {}, "Dataset versions compiled on first use")),
+      compileTimes(metrics.histogram("planner_model_compile_us", {},
+          "Time to compile a dataset version into its model, rules, lesson demand, domains, conflict graph and diagnosis")) {
+}
+
+std::shared_ptr<const CompiledDataset> ModelCache::get(const Dataset& dataset, std::string& error, bool* cached) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->first == dataset.contentHash) {
+                entries.splice(entries.begin(), entries, it);
+                hits.increment();
+                if (cached) {
+                    *cached = true;
+                }
+                return entries.front().second;
+            }
+        }
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    auto compiled = std::make_shared<CompiledDataset>();
+    compiled->model = ProblemModel::compile(dataset.sections(), error);
+    if (!compiled->model) {
+        return nullptr;
+    }
+    compiled->constraints = CompiledConstraints::compile(*compiled->model);
+    compiled->feasibility = FeasibilityMatrices::build(*compiled->model);
+    compiled->demand = LessonDemand::expand(*compiled->model);
+    compiled->domains = LessonDomains::presolve(*compiled->model, *compiled->constraints, *compiled->feasibility,
+                                                *compiled->demand);
+    compiled->conflicts = ConflictGraph::build(*compiled->model, *compiled->demand, *compiled->domains);
+    compiled->diagnosis = InfeasibilityDiagnosis::diagnose(*compiled->model, *compiled->feasibility, *compiled->demand);
+    compileTimes.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count()));
+    misses.increment();
+    if (cached) {
+        *cached = false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& entry : entries) {
+        if (entry.first == dataset.contentHash) {
+            return entry.second;
+        }
+    }
+    entries.emplace_front(dataset.contentHash, compiled);
+    if (entries.size() > MAX_ENTRIES) {
+        entries.pop_back();
+    }
+    return compiled;
+}
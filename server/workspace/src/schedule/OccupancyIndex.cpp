@@ -0,0 +1,99 @@
+#include "schedule/OccupancyIndex.hpp"
+#include "schedule/BitKernels.hpp"
+
+OccupancyIndex::OccupancyIndex(const ProblemModel& model)
+    : blockCount(model.timeBlocks().size()), times(model.timeIndex()), relatedGroups(model.relatedGroups()),
+      busyGroups(model.timeBlocks().size(), model.groups().size()) {
+    counters[static_cast<size_t>(Resource::Teacher)].assign(model.teachers().size() * blockCount, 0);
+    counters[static_cast<size_t>(Resource::Room)].assign(model.rooms().size() * blockCount, 0);
+    counters[static_cast<size_t>(Resource::Group)].assign(model.groups().size() * blockCount, 0);
+}
+
+void OccupancyIndex::add(const Placement& event) {
+    IdRange blocks = overlapping(event.timeBlock);
+    for (EntityId block : blocks) {
+        clashTotals[static_cast<size_t>(Resource::Teacher)] += count(Resource::Teacher, event.teacher, block);
+        clashTotals[static_cast<size_t>(Resource::Room)] += count(Resource::Room, event.room, block);
+        clashTotals[static_cast<size_t>(Resource::Group)] += relatedEvents(event.group, block);
+    }
+    changeCounter(Resource::Teacher, event.teacher, event.timeBlock, true);
+    changeCounter(Resource::Room, event.room, event.timeBlock, true);
+    changeCounter(Resource::Group, event.group, event.timeBlock, true);
+}
+
+void OccupancyIndex::remove(const Placement& event) {
+    changeCounter(Resource::Teacher, event.teacher, event.timeBlock, false);
+    changeCounter(Resource::Room, event.room, event.timeBlock, false);
+    changeCounter(Resource::Group, event.group, event.timeBlock, false);
+    IdRange blocks = overlapping(event.timeBlock);
+    for (EntityId block : blocks) {
+        clashTotals[static_cast<size_t>(Resource::Teacher)] -= count(Resource::Teacher, event.teacher, block);
+        clashTotals[static_cast<size_t>(Resource::Room)] -= count(Resource::Room, event.room, block);
+        clashTotals[static_cast<size_t>(Resource::Group)] -= relatedEvents(event.group, block);
+    }
+}
+
+void OccupancyIndex::changeCounter(Resource resource, EntityId entity, EntityId timeBlock, bool add) {
+    uint32_t& counter = counters[static_cast<size_t>(resource)][entity * blockCount + timeBlock];
+    counter += add ? 1 : -1;
+    if (resource == Resource::Group) {
+        if (counter == 0) {
+            busyGroups.reset(timeBlock, entity);
+        } else {
+            busyGroups.set(timeBlock, entity);
+        }
+    }
+}
+
+uint32_t OccupancyIndex::relatedEvents(EntityId group, EntityId timeBlock) const {
+    const uint64_t* related = relatedGroups.row(group);
+    const uint64_t* busy = busyGroups.row(timeBlock);
+    size_t words = busyGroups.rowWords();
+    if (!BitKernels::intersects(related, busy, words)) {
+        return 0;
+    }
+
+    const std::vector<uint32_t>& groupCounters = counters[static_cast<size_t>(Resource::Group)];
+    uint32_t events = 0;
+    for (size_t w = 0; w < words; ++w) {
+        for (uint64_t bits = related[w] & busy[w]; bits != 0; bits &= bits - 1) {
+            size_t other = w * BitMatrix::WORD_BITS + static_cast<size_t>(__builtin_ctzll(bits));
+            events += groupCounters[other * blockCount + timeBlock];
+        }
+    }
+    return events;
+}
+
+uint32_t OccupancyIndex::occupied(Resource resource, EntityId entity, EntityId timeBlock) const {
+    uint32_t events = 0;
+    for (EntityId block : overlapping(timeBlock)) {
+        events += resource == Resource::Group ? relatedEvents(entity, block) : count(resource, entity, block);
+    }
+    return events;
+}
+
+bool OccupancyIndex::groupBusy(EntityId group, EntityId timeBlock) const {
+    for (EntityId block : overlapping(timeBlock)) {
+        if (BitKernels::intersects(relatedGroups.row(group), busyGroups.row(block), busyGroups.rowWords())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t OccupancyIndex::conflicts(const Placement& event) const {
+    return occupied(Resource::Teacher, event.teacher, event.timeBlock) +
+           occupied(Resource::Room, event.room, event.timeBlock) +
+           occupied(Resource::Group, event.group, event.timeBlock);
+}
+
+json OccupancyIndex::summary() const {
+    json clashCounts = json::object();
+    for (size_t r = 0; r < RESOURCE_KINDS; ++r) {
+        clashCounts[resourceName(static_cast<Resource>(r))] = clashTotals[r];
+    }
+    return {
+        {"clashes", clashCounts},
+        {"overlapping_block_pairs", times.overlappingPairs()}
+    };
+}
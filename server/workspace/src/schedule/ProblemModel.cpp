@@ -0,0 +1,456 @@
+#include "schedule/ProblemModel.hpp"
+#include "schedule/BitKernels.hpp"
+#include "schedule/ConstraintData.hpp"
+#include "schedule/TimeIndex.hpp"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace {
+    constexpr size_t MAX_WARNINGS = 200;
+
+    constexpr int UNKNOWN_WEEKDAY = 7;
+
+    /**
+     * @return 0 for Monday through 6 for Sunday, matching full English names
+     * and their three-letter forms in any case, or UNKNOWN_WEEKDAY
+     */
+    int weekdayOf(const std::string& day) {
+        static const char* const names[] = {"monday", "tuesday", "wednesday", "thursday", "friday", "saturday", "sunday"};
+        std::string lower(day.size(), '\0');
+        std::transform(day.begin(), day.end(), lower.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        for (int i = 0; i < UNKNOWN_WEEKDAY; ++i) {
+            std::string name = names[i];
+            if (lower == name || lower == name.substr(0, 3)) {
+                return i;
+            }
+        }
+        return UNKNOWN_WEEKDAY;
+    }
+
+    bool validHhmm(int hhmm) {
+        return hhmm >= 0 && hhmm % 100 < 60 && ConstraintData::minutesOf(hhmm) <= MINUTES_PER_DAY;
+    }
+
+    /**
+     * @return Number formed by the trailing digits of id ("TB12" -> 12), or -1
+     */
+    int64_t numericSuffix(const std::string& id) {
+        size_t digits = id.size();
+        while (digits > 0 && id[digits - 1] >= '0' && id[digits - 1] <= '9') {
+            --digits;
+        }
+        if (digits == id.size() || id.size() - digits > 18) {
+            return -1;
+        }
+        return std::stoll(id.substr(digits));
+    }
+
+    ConstraintImportance importanceOf(const std::string& importance, bool& known) {
+        known = true;
+        if (importance == "Critical") return ConstraintImportance::Critical;
+        if (importance == "Important") return ConstraintImportance::Important;
+        known = importance == "Optional";
+        return ConstraintImportance::Optional;
+    }
+
+    const char* importanceName(ConstraintImportance importance) {
+        switch (importance) {
+            case ConstraintImportance::Critical: return "Critical";
+            case ConstraintImportance::Important: return "Important";
+            default: return "Optional";
+        }
+    }
+}
+
+EntityId IdTable::intern(const std::string& id) {
+    auto [it, inserted] = indices.emplace(id, static_cast<EntityId>(names.size()));
+    if (inserted) {
+        names.push_back(id);
+    }
+    return it->second;
+}
+
+EntityId IdTable::find(const std::string& id) const {
+    auto it = indices.find(id);
+    return it != indices.end() ? it->second : NO_ENTITY;
+}
+
+/**
+ * @brief Fills a ProblemModel section by section
+ *
+ * Ids are interned before references are resolved, so an entity may name
+ * one that comes later in the dataset.
+ */
+class ProblemCompiler {
+public:
+    ProblemCompiler(const DatasetSections& sections, ProblemModel& model)
+        : sections(sections), model(model) {
+    }
+
+    void run() {
+        std::vector<size_t> positions;
+        std::vector<TimeBlock> timeBlocks = read<TimeBlock>("timeBlocks", model.timeBlockTable, timeBlockPositions);
+        std::vector<Subject> subjects = read<Subject>("subjects", model.subjectTable, positions);
+        std::vector<Group> groups = read<Group>("groups", model.groupTable, groupPositions);
+        std::vector<Room> rooms = read<Room>("rooms", model.roomTable, positions);
+        std::vector<Teacher> teachers = read<Teacher>("teachers", model.teacherTable, teacherPositions);
+
+        compileTimeBlocks(timeBlocks);
+        model.times = TimeIndex::build(model);
+        for (const Subject& subject : subjects) {
+            model.subjectEntries.push_back({subject.hoursPerWeek, subject.difficultyLevel});
+        }
+        compileGroups(groups);
+        closeGroupHierarchy(groups);
+        compileRooms(rooms);
+        compileTeachers(teachers);
+        compileConstraints();
+    }
+
+private:
+    const DatasetSections& sections;
+    ProblemModel& model;
+    std::vector<size_t> timeBlockPositions;  // Section position of each compiled entity, for errors and warnings
+    std::vector<size_t> groupPositions;
+    std::vector<size_t> teacherPositions;
+    std::unordered_map<int64_t, EntityId> timeBlocksByNumber;
+
+    const DatasetSection* section(const char* name) const {
+        auto it = sections.find(name);
+        return it != sections.end() && it->second->isArray ? it->second.get() : nullptr;
+    }
+
+    void warn(const char* code, const std::string& sectionName, size_t index, const std::string& field,
+              const json& value, const std::string& message) {
+        if (model.warningList.size() >= MAX_WARNINGS) {
+            model.warningsTruncated = true;
+            return;
+        }
+        json warning = {{"code", code}, {"section", sectionName}, {"index", index}, {"message", message}};
+        if (!field.empty()) {
+            warning["field"] = field;
+        }
+        if (!value.is_null()) {
+            warning["value"] = value;
+        }
+        model.warningList.push_back(std::move(warning));
+    }
+
+    /**
+     * Converts the items of a section and interns their ids; items without
+     * an id or with a repeated id are skipped
+     */
+    template <typename T>
+    std::vector<T> read(const char* name, IdTable& ids, std::vector<size_t>& positions) {
+        std::vector<T> entities;
+        positions.clear();
+        const DatasetSection* items = section(name);
+        if (!items) {
+            return entities;
+        }
+
+        entities.reserve(items->items.size());
+        for (size_t i = 0; i < items->items.size(); ++i) {
+            const json& item = *items->items[i];
+            T entity;
+            try {
+                fromItem(item, entity);
+            } catch (const json::exception& e) {
+                throw std::runtime_error(std::string(name) + "[" + std::to_string(i) + "]: " + e.what());
+            }
+
+            if (entity.id.empty()) {
+                warn("MISSING_ID", name, i, "id", nullptr, std::string(name) + "[" + std::to_string(i) + "] has no id");
+                continue;
+            }
+            if (ids.find(entity.id) != NO_ENTITY) {
+                warn("DUPLICATE_ID", name, i, "id", entity.id,
+                     std::string(name) + "[" + std::to_string(i) + "] repeats id '" + entity.id + "'");
+                continue;
+            }
+            ids.intern(entity.id);
+            entities.push_back(std::move(entity));
+            positions.push_back(i);
+        }
+        return entities;
+    }
+
+    template <typename T>
+    static void fromItem(const json& item, T& entity) {
+        item.get_to(entity);
+    }
+
+    static void fromItem(const json& item, Group& group) {
+        // parentGroupId may be null for top-level groups
+        auto parent = item.is_object() ? item.find("parentGroupId") : item.end();
+        if (parent != item.end() && parent->is_null()) {
+            json copy = item;
+            copy.erase("parentGroupId");
+            copy.get_to(group);
+            return;
+        }
+        item.get_to(group);
+    }
+
+    /**
+     * Days are numbered Monday first whatever order the time blocks come in;
+     * labels that are not weekday names follow in the order they first
+     * appear. A time block whose start or end is not a valid hhmm, or that
+     * does not end after it starts, makes compile() fail: the overlap
+     * relation and the sorted timelines assume non-empty intervals.
+     */
+    void compileTimeBlocks(const std::vector<TimeBlock>& timeBlocks) {
+        std::vector<std::string> dayLabels;
+        std::unordered_map<std::string, int> seenDays;
+        for (EntityId i = 0; i < timeBlocks.size(); ++i) {
+            const TimeBlock& block = timeBlocks[i];
+            if (!validHhmm(block.start) || !validHhmm(block.end) || block.end <= block.start) {
+                throw std::runtime_error("timeBlocks[" + std::to_string(timeBlockPositions[i]) + "]: time block '" +
+                                         block.id + "' has invalid times " + std::to_string(block.start) + "-" +
+                                         std::to_string(block.end));
+            }
+            if (seenDays.emplace(block.day, weekdayOf(block.day)).second) {
+                dayLabels.push_back(block.day);
+            }
+        }
+        std::stable_sort(dayLabels.begin(), dayLabels.end(), [&](const std::string& a, const std::string& b) {
+            return seenDays[a] < seenDays[b];
+        });
+        for (const std::string& label : dayLabels) {
+            model.dayTable.intern(label);
+        }
+
+        bool numbered = false;
+        model.timeBlockEntries.reserve(timeBlocks.size());
+        for (EntityId i = 0; i < timeBlocks.size(); ++i) {
+            const TimeBlock& block = timeBlocks[i];
+            EntityId day = model.dayTable.find(block.day);
+            int32_t dayStart = static_cast<int32_t>(day) * MINUTES_PER_DAY;
+            int startMinute = ConstraintData::minutesOf(block.start);
+            int endMinute = ConstraintData::minutesOf(block.end);
+            model.timeBlockEntries.push_back({
+                day,
+                block.start,
+                block.end,
+                startMinute,
+                endMinute,
+                block.duration,
+                dayStart + startMinute,
+                dayStart + endMinute
+            });
+
+            int64_t number = numericSuffix(block.id);
+            if (number >= 0) {
+                numbered = true;
+                timeBlocksByNumber.emplace(number, i);
+            }
+        }
+
+        if (!numbered) {
+            for (EntityId i = 0; i < timeBlocks.size(); ++i) {
+                timeBlocksByNumber.emplace(static_cast<int64_t>(i) + 1, i);
+            }
+        }
+    }
+
+    void compileGroups(const std::vector<Group>& groups) {
+        model.groupEntries.reserve(groups.size());
+        for (EntityId g = 0; g < groups.size(); ++g) {
+            const Group& group = groups[g];
+            EntityId parent = NO_ENTITY;
+            if (!group.parentGroupId.empty()) {
+                parent = model.groupTable.find(group.parentGroupId);
+                if (parent == NO_ENTITY) {
+                    warn("UNKNOWN_REFERENCE", "groups", groupPositions[g], "parentGroupId", group.parentGroupId,
+                         "Group '" + group.id + "' names unknown parent '" + group.parentGroupId + "'");
+                }
+            }
+            model.groupEntries.push_back({group.size, parent});
+        }
+    }
+
+    /**
+     * Fills the ancestor, descendant and related matrices. Each group's
+     * ancestors are its parent's plus the parent, so walking up stops at the
+     * first group already closed and every link is followed once.
+     */
+    void closeGroupHierarchy(const std::vector<Group>& groups) {
+        size_t count = model.groupEntries.size();
+        model.ancestorBits = BitMatrix(count, count);
+        std::vector<uint8_t> state(count, 0);  // 0 open, 1 on the current chain, 2 closed
+        std::vector<EntityId> chain;
+
+        for (EntityId start = 0; start < count; ++start) {
+            chain.clear();
+            EntityId g = start;
+            while (g != NO_ENTITY && state[g] == 0) {
+                state[g] = 1;
+                chain.push_back(g);
+                EntityId parent = model.groupEntries[g].parent;
+                if (parent != NO_ENTITY && state[parent] == 1) {
+                    warn("GROUP_CYCLE", "groups", groupPositions[g], "parentGroupId", groups[g].parentGroupId,
+                         "Group '" + groups[g].id + "' closes a parent cycle, its parent link is ignored");
+                    model.groupEntries[g].parent = NO_ENTITY;
+                    parent = NO_ENTITY;
+                }
+                g = parent;
+            }
+
+            for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+                EntityId parent = model.groupEntries[*it].parent;
+                if (parent != NO_ENTITY) {
+                    BitKernels::orAssign(model.ancestorBits.row(*it), model.ancestorBits.row(parent),
+                                         model.ancestorBits.rowWords());
+                    model.ancestorBits.set(*it, parent);
+                }
+                state[*it] = 2;
+            }
+        }
+
+        model.descendantBits = model.ancestorBits.transposed();
+        model.relatedBits = model.ancestorBits;
+        for (EntityId g = 0; g < count; ++g) {
+            BitKernels::orAssign(model.relatedBits.row(g), model.descendantBits.row(g), model.relatedBits.rowWords());
+            model.relatedBits.set(g, g);
+        }
+    }
+
+    void compileRooms(const std::vector<Room>& rooms) {
+        model.roomEntries.reserve(rooms.size());
+        for (const Room& room : rooms) {
+            auto begin = static_cast<uint32_t>(model.roomFeatureIds.size());
+            for (const std::string& feature : room.features) {
+                model.roomFeatureIds.push_back(model.featureTable.intern(feature));
+            }
+            // std::set keeps features sorted by name; order the range by index instead
+            std::sort(model.roomFeatureIds.begin() + begin, model.roomFeatureIds.end());
+            model.roomEntries.push_back({room.capacity, begin, static_cast<uint32_t>(model.roomFeatureIds.size())});
+        }
+    }
+
+    void compileTeachers(const std::vector<Teacher>& teachers) {
+        model.teacherEntries.reserve(teachers.size());
+        for (EntityId t = 0; t < teachers.size(); ++t) {
+            const Teacher& teacher = teachers[t];
+            ProblemModel::TeacherEntry entry{};
+
+            entry.subjectsBegin = static_cast<uint32_t>(model.teacherSubjectIds.size());
+            for (const std::string& subjectId : teacher.subjects) {
+                EntityId subject = model.subjectTable.find(subjectId);
+                if (subject == NO_ENTITY) {
+                    warn("UNKNOWN_REFERENCE", "teachers", teacherPositions[t], "subjects", subjectId,
+                         "Teacher '" + teacher.id + "' names unknown subject '" + subjectId + "'");
+                    continue;
+                }
+                model.teacherSubjectIds.push_back(subject);
+            }
+            entry.subjectsEnd = static_cast<uint32_t>(model.teacherSubjectIds.size());
+
+            entry.availabilityBegin = static_cast<uint32_t>(model.teacherTimeBlockIds.size());
+            for (int number : teacher.availableTimeBlocks) {
+                auto block = timeBlocksByNumber.find(number);
+                if (block == timeBlocksByNumber.end()) {
+                    warn("UNKNOWN_REFERENCE", "teachers", teacherPositions[t], "availableTimeBlocks", number,
+                         "Teacher '" + teacher.id + "' is available in unknown time block " + std::to_string(number));
+                    continue;
+                }
+                model.teacherTimeBlockIds.push_back(block->second);
+            }
+            auto availability = model.teacherTimeBlockIds.begin() + entry.availabilityBegin;
+            std::sort(availability, model.teacherTimeBlockIds.end());
+            model.teacherTimeBlockIds.erase(std::unique(availability, model.teacherTimeBlockIds.end()),
+                                            model.teacherTimeBlockIds.end());
+            entry.availabilityEnd = static_cast<uint32_t>(model.teacherTimeBlockIds.size());
+            entry.availabilityListed = !teacher.availableTimeBlocks.empty();
+
+            model.teacherEntries.push_back(entry);
+        }
+    }
+
+    void compileConstraints() {
+        const DatasetSection* items = section("constraints");
+        if (!items) {
+            return;
+        }
+
+        model.constraintEntries.reserve(items->items.size());
+        for (size_t i = 0; i < items->items.size(); ++i) {
+            const json& item = *items->items[i];
+            if (!item.is_object()) {
+                warn("INVALID_CONSTRAINT", "constraints", i, "", nullptr, "Constraint is not an object");
+                continue;
+            }
+
+            std::string typeName = item.value("type", "");
+            ConstraintType type = json(typeName).get<ConstraintType>();
+            if (type == ConstraintType::Custom && typeName != "Custom") {
+                warn("UNKNOWN_CONSTRAINT_TYPE", "constraints", i, "type", typeName,
+                     "Unknown constraint type '" + typeName + "', treated as Custom");
+            }
+
+            bool known = true;
+            std::string importanceText = item.value("importance", "");
+            ConstraintImportance importance = importanceOf(importanceText, known);
+            if (!known) {
+                warn("UNKNOWN_IMPORTANCE", "constraints", i, "importance", importanceText,
+                     "Unknown importance '" + importanceText + "', treated as Optional");
+            }
+
+            model.constraintEntries.push_back({type, importance, static_cast<uint32_t>(i), items->items[i]});
+        }
+    }
+};
+
+std::shared_ptr<const ProblemModel> ProblemModel::compile(const DatasetSections& sections, std::string& error) {
+    auto model = std::make_shared<ProblemModel>();
+    try {
+        ProblemCompiler(sections, *model).run();
+    } catch (const std::exception& e) {
+        error = e.what();
+        return nullptr;
+    }
+    return model;
+}
+
+IdRange ProblemModel::roomFeatures(EntityId room) const {
+    const RoomEntry& entry = roomEntries[room];
+    return {roomFeatureIds.data() + entry.featuresBegin, roomFeatureIds.data() + entry.featuresEnd};
+}
+
+IdRange ProblemModel::teacherSubjects(EntityId teacher) const {
+    const TeacherEntry& entry = teacherEntries[teacher];
+    return {teacherSubjectIds.data() + entry.subjectsBegin, teacherSubjectIds.data() + entry.subjectsEnd};
+}
+
+IdRange ProblemModel::teacherAvailability(EntityId teacher) const {
+    const TeacherEntry& entry = teacherEntries[teacher];
+    return {teacherTimeBlockIds.data() + entry.availabilityBegin, teacherTimeBlockIds.data() + entry.availabilityEnd};
+}
+
+json ProblemModel::summary() const {
+    json constraintCounts = json::object();
+    for (const ConstraintEntry& constraint : constraintEntries) {
+        constraintCounts[importanceName(constraint.importance)] =
+            constraintCounts.value(importanceName(constraint.importance), 0) + 1;
+    }
+
+    return {
+        {"entities", {
+            {"timeBlocks", timeBlockEntries.size()},
+            {"subjects", subjectEntries.size()},
+            {"groups", groupEntries.size()},
+            {"rooms", roomEntries.size()},
+            {"teachers", teacherEntries.size()},
+            {"constraints", constraintEntries.size()},
+            {"days", dayTable.size()},
+            {"features", featureTable.size()}
+        }},
+        {"constraints_by_importance", constraintCounts},
+        {"teacher_availability_slots", teacherTimeBlockIds.size()},
+        {"time_blocks", times->summary()},
+        {"warnings", warningList},
+        {"warnings_truncated", warningsTruncated}
+    };
+}
@@ -0,0 +1,143 @@
+#include "schedule/ScheduleEvaluator.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+    /**
+     * Sorts event indices by owner, start and index, then calls
+     * visit(owner, range) for every bucket
+     */
+    template <typename Owner, typename Visit>
+    void forEachBucket(const Assignment& assignment, const RuleTables& tables, bool daily, Owner ownerOf,
+                       std::vector<uint32_t>& order, Visit visit) {
+        const std::vector<Placement>& events = assignment.events;
+        order.resize(events.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            EntityId ownerA = ownerOf(events[a]);
+            EntityId ownerB = ownerOf(events[b]);
+            if (ownerA != ownerB) {
+                return ownerA < ownerB;
+            }
+            int32_t startA = tables.blockStart[events[a].timeBlock];
+            int32_t startB = tables.blockStart[events[b].timeBlock];
+            // Events starting together (clashes) keep their schedule order, as in IncrementalEvaluator
+            return startA < startB || (startA == startB && a < b);
+        });
+
+        size_t first = 0;
+        while (first < order.size()) {
+            const Placement& head = events[order[first]];
+            size_t last = first + 1;
+            while (last < order.size()) {
+                const Placement& next = events[order[last]];
+                if (ownerOf(next) != ownerOf(head) ||
+                    (daily && tables.blockDay[next.timeBlock] != tables.blockDay[head.timeBlock])) {
+                    break;
+                }
+                ++last;
+            }
+            visit(ownerOf(head), EventRange{order.data() + first, order.data() + last, events.data()});
+            first = last;
+        }
+    }
+}
+
+Evaluation ScheduleEvaluator::evaluate(const ProblemModel& model, const CompiledConstraints& constraints,
+                                       const Assignment& assignment) {
+    const std::vector<ConstraintRule>& rules = constraints.rules();
+    const RuleTables& tables = constraints.tables();
+    Evaluation evaluation;
+    evaluation.violations.assign(rules.size(), 0);
+
+    IdRange eventRules = constraints.rulesFor(RuleScope::Event, 0);
+    if (!eventRules.empty()) {
+        for (const Placement& event : assignment.events) {
+            for (EntityId r : eventRules) {
+                evaluation.violations[r] += ruleViolations(rules[r], event, tables);
+            }
+        }
+    }
+
+    auto byTeacher = [](const Placement& event) { return event.teacher; };
+    auto byGroup = [](const Placement& event) { return event.group; };
+    auto everyone = [](const Placement&) { return EntityId(0); };
+
+    std::vector<uint32_t> order;
+    auto evaluateScope = [&](RuleScope scope, bool daily, auto ownerOf) {
+        if (!constraints.hasRules(scope)) {
+            return;
+        }
+        forEachBucket(assignment, tables, daily, ownerOf, order, [&](EntityId owner, const EventRange& range) {
+            for (EntityId r : constraints.rulesFor(scope, owner)) {
+                evaluation.violations[r] += ruleViolations(rules[r], range, tables);
+            }
+        });
+    };
+    evaluateScope(RuleScope::TeacherDay, true, byTeacher);
+    evaluateScope(RuleScope::TeacherWeek, false, byTeacher);
+    evaluateScope(RuleScope::GroupDay, true, byGroup);
+    evaluateScope(RuleScope::GroupWeek, false, byGroup);
+    evaluateScope(RuleScope::Global, false, everyone);
+
+    for (size_t r = 0; r < rules.size(); ++r) {
+        const RuleBase& base = ruleBase(rules[r]);
+        size_t tier = static_cast<size_t>(base.tier);
+        int64_t cost = evaluation.violations[r] * base.weight;
+        evaluation.tierViolations[tier] += evaluation.violations[r];
+        evaluation.tierCost[tier] += cost;
+        evaluation.cost += cost;
+    }
+
+    OccupancyIndex occupancy(model);
+    for (const Placement& event : assignment.events) {
+        occupancy.add(event);
+    }
+    size_t hard = static_cast<size_t>(PenaltyTier::Hard);
+    for (size_t r = 0; r < RESOURCE_KINDS; ++r) {
+        evaluation.clashes[r] = occupancy.clashes(static_cast<Resource>(r));
+        evaluation.tierViolations[hard] += evaluation.clashes[r];
+        evaluation.tierCost[hard] += evaluation.clashes[r] * CLASH_WEIGHT;
+        evaluation.cost += evaluation.clashes[r] * CLASH_WEIGHT;
+    }
+    return evaluation;
+}
+
+json ScheduleEvaluator::report(const ProblemModel& model, const CompiledConstraints& constraints,
+                               const Evaluation& evaluation) {
+    json tiers = json::object();
+    for (size_t t = 0; t < PENALTY_TIERS; ++t) {
+        tiers[tierName(static_cast<PenaltyTier>(t))] = {
+            {"violations", evaluation.tierViolations[t]},
+            {"cost", evaluation.tierCost[t]}
+        };
+    }
+
+    json clashes = json::object();
+    for (size_t r = 0; r < RESOURCE_KINDS; ++r) {
+        clashes[resourceName(static_cast<Resource>(r))] = evaluation.clashes[r];
+    }
+
+    json violated = json::array();
+    for (size_t r = 0; r < evaluation.violations.size(); ++r) {
+        if (evaluation.violations[r] == 0) {
+            continue;
+        }
+        const RuleBase& base = ruleBase(constraints.rules()[r]);
+        violated.push_back({
+            {"index", model.constraints()[base.constraint].sourceIndex},
+            {"type", json(constraints.typeOf(r))},
+            {"tier", tierName(base.tier)},
+            {"violations", evaluation.violations[r]},
+            {"cost", evaluation.violations[r] * base.weight}
+        });
+    }
+
+    return {
+        {"cost", evaluation.cost},
+        {"feasible", evaluation.feasible()},
+        {"tiers", tiers},
+        {"clashes", clashes},
+        {"violated", violated}
+    };
+}
@@ -0,0 +1,136 @@
+#include "schedule/TimeIndex.hpp"
+#include <algorithm>
+
+std::shared_ptr<const TimeIndex> TimeIndex::build(const ProblemModel& model) {
+    auto index = std::make_shared<TimeIndex>();
+    const auto& timeBlocks = model.timeBlocks();
+    size_t blockCount = timeBlocks.size();
+    size_t dayCount = model.days().size();
+
+    index->intervals.reserve(blockCount);
+    for (const auto& block : timeBlocks) {
+        index->intervals.push_back({block.day, block.weekStart, block.weekEnd});
+    }
+    const std::vector<Interval>& intervals = index->intervals;
+
+    index->byStart.resize(blockCount);
+    for (EntityId b = 0; b < blockCount; ++b) {
+        index->byStart[b] = b;
+    }
+    std::sort(index->byStart.begin(), index->byStart.end(), [&](EntityId a, EntityId b) {
+        if (intervals[a].day != intervals[b].day) {
+            return intervals[a].day < intervals[b].day;
+        }
+        if (intervals[a].start != intervals[b].start) {
+            return intervals[a].start < intervals[b].start;
+        }
+        return intervals[a].end != intervals[b].end ? intervals[a].end < intervals[b].end : a < b;
+    });
+
+    index->dayOffsets.assign(dayCount + 1, 0);
+    index->dayLongest.assign(dayCount, 0);
+    for (const Interval& interval : intervals) {
+        ++index->dayOffsets[interval.day + 1];
+        index->dayLongest[interval.day] = std::max(index->dayLongest[interval.day], interval.end - interval.start);
+    }
+    for (size_t d = 0; d < dayCount; ++d) {
+        index->dayOffsets[d + 1] += index->dayOffsets[d];
+    }
+
+    index->nextBlocks.resize(blockCount);
+    std::vector<std::vector<EntityId>> lists(blockCount);
+    for (size_t i = 0; i < blockCount; ++i) {
+        EntityId a = index->byStart[i];
+        const Interval& first = intervals[a];
+        lists[a].push_back(a);
+        // Later blocks of the day starting before this one ends overlap it
+        for (size_t j = i + 1; j < blockCount; ++j) {
+            EntityId b = index->byStart[j];
+            if (intervals[b].day != first.day || intervals[b].start >= first.end) {
+                break;
+            }
+            lists[a].push_back(b);
+            lists[b].push_back(a);
+        }
+        const EntityId* next = index->firstStarting(first.day, first.end);
+        index->nextBlocks[a] = next ? *next : NO_ENTITY;
+    }
+
+    index->overlapOffsets.assign(1, 0);
+    for (auto& list : lists) {
+        std::sort(list.begin(), list.end());
+        index->overlapBlocks.insert(index->overlapBlocks.end(), list.begin(), list.end());
+        index->overlapOffsets.push_back(static_cast<uint32_t>(index->overlapBlocks.size()));
+    }
+
+    if (blockCount <= MATRIX_LIMIT) {
+        index->overlapBits = BitMatrix(blockCount, blockCount);
+        for (EntityId a = 0; a < blockCount; ++a) {
+            for (EntityId b : index->overlapping(a)) {
+                index->overlapBits.set(a, b);
+            }
+        }
+    }
+    return index;
+}
+
+bool TimeIndex::overlaps(EntityId a, EntityId b) const {
+    if (overlapBits.rows() != 0) {
+        return overlapBits.test(a, b);
+    }
+    const Interval& first = intervals[a];
+    const Interval& second = intervals[b];
+    return a == b || (first.day == second.day && first.start < second.end && second.start < first.end);
+}
+
+int32_t TimeIndex::gap(EntityId a, EntityId b) const {
+    if (intervals[a].day != intervals[b].day) {
+        return NO_GAP;
+    }
+    return intervals[b].start - intervals[a].end;
+}
+
+const EntityId* TimeIndex::firstStarting(EntityId day, int32_t weekMinute) const {
+    IdRange blocks = dayBlocks(day);
+    const EntityId* found = std::lower_bound(blocks.begin(), blocks.end(), weekMinute, [&](EntityId b, int32_t minute) {
+        return intervals[b].start < minute;
+    });
+    return found == blocks.end() ? nullptr : found;
+}
+
+EntityId TimeIndex::firstStartingAt(EntityId day, int32_t minute) const {
+    const EntityId* found = firstStarting(day, static_cast<int32_t>(day) * MINUTES_PER_DAY + minute);
+    return found ? *found : NO_ENTITY;
+}
+
+void TimeIndex::intersecting(EntityId day, int32_t startMinute, int32_t endMinute, std::vector<EntityId>& out) const {
+    int32_t dayStart = static_cast<int32_t>(day) * MINUTES_PER_DAY;
+    int32_t start = dayStart + startMinute;
+    int32_t end = dayStart + endMinute;
+    IdRange blocks = dayBlocks(day);
+
+    // No block is longer than dayLongest, so earlier starts end at or before start
+    const EntityId* first = firstStarting(day, start - dayLongest[day] + 1);
+    for (const EntityId* it = first ? first : blocks.end(); it != blocks.end() && intervals[*it].start < end; ++it) {
+        if (intervals[*it].end > start) {
+            out.push_back(*it);
+        }
+    }
+}
+
+json TimeIndex::summary() const {
+    bool uniform = true;
+    for (const Interval& interval : intervals) {
+        uniform = uniform && interval.end - interval.start == intervals.front().end - intervals.front().start;
+    }
+    size_t busiestDay = 0;
+    for (size_t d = 0; d + 1 < dayOffsets.size(); ++d) {
+        busiestDay = std::max<size_t>(busiestDay, dayOffsets[d + 1] - dayOffsets[d]);
+    }
+    return {
+        {"uniform_lengths", uniform},
+        {"max_blocks_per_day", busiestDay},
+        {"overlapping_block_pairs", overlappingPairs()},
+        {"overlap_matrix", overlapBits.rows() != 0}
+    };
+}
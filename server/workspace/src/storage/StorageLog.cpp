@@ -0,0 +1,167 @@
+#include "storage/StorageLog.hpp"
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+
+StorageLog::~StorageLog() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+bool StorageLog::open(const std::string& logPath, const std::function<void(const json&)>& replay, std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex);
+    path = logPath;
+    records = 0;
+
+    // Only the final line can be torn: it lacks its newline. A bad line before it means the file was
+    // damaged, and cutting there would silently drop every later record
+    uint64_t validLength = 0;
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::string line;
+        size_t lineNumber = 0;
+        while (std::getline(in, line)) {
+            ++lineNumber;
+            if (in.eof()) {
+                break;
+            }
+
+            json record;
+            try {
+                record = json::parse(line);
+            } catch (const json::parse_error& e) {
+                error = path + " is corrupt at line " + std::to_string(lineNumber) + ": " + e.what();
+                return false;
+            }
+            replay(record);
+            ++records;
+            validLength += line.size() + 1;
+        }
+    }
+
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = "Cannot open " + path + ": " + strerror(errno);
+        return false;
+    }
+
+    off_t length = lseek(fd, 0, SEEK_END);
+    if (length > static_cast<off_t>(validLength)) {
+        std::cerr << "StorageLog: dropping " << (length - static_cast<off_t>(validLength))
+                  << " bytes of incomplete records from " << path << std::endl;
+        if (ftruncate(fd, static_cast<off_t>(validLength)) != 0) {
+            error = "Cannot truncate " + path + ": " + strerror(errno);
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StorageLog::append(const json& record) {
+    std::string line = record.dump() + "\n";
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd < 0) {
+        return false;
+    }
+    off_t length = lseek(fd, 0, SEEK_END);
+    if (length < 0) {
+        std::cerr << "StorageLog: append to " << path << " failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (!writeAll(fd, line) || fdatasync(fd) != 0) {
+        std::cerr << "StorageLog: append to " << path << " failed: " << strerror(errno) << std::endl;
+        // A partial line in the middle of the log would make the next open() refuse the file
+        if (ftruncate(fd, length) != 0) {
+            std::cerr << "StorageLog: cannot cut the failed append from " << path << ": " << strerror(errno)
+                      << ", closing the log" << std::endl;
+            ::close(fd);
+            fd = -1;
+        }
+        return false;
+    }
+    ++records;
+    return true;
+}
+
+bool StorageLog::rewrite(const std::vector<json>& replacement) {
+    std::string bytes;
+    for (const auto& record : replacement) {
+        bytes += record.dump();
+        bytes += '\n';
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd < 0) {
+        return false;
+    }
+
+    std::string temporaryPath = path + ".tmp";
+    int temporary = ::open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (temporary < 0) {
+        return false;
+    }
+    bool written = writeAll(temporary, bytes) && fsync(temporary) == 0;
+    ::close(temporary);
+    if (!written || ::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::filesystem::remove(temporaryPath);
+        return false;
+    }
+    // The rename itself is only durable once the directory is synced
+    if (!syncDirectory()) {
+        std::cerr << "StorageLog: cannot sync the directory of " << path << ": " << strerror(errno) << std::endl;
+    }
+
+    // Appends must go to the new file from now on
+    int reopened = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (reopened < 0) {
+        return false;
+    }
+    ::close(fd);
+    fd = reopened;
+    records = replacement.size();
+    return true;
+}
+
+bool StorageLog::isOpen() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fd >= 0;
+}
+
+size_t StorageLog::recordCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return records;
+}
+
+bool StorageLog::syncDirectory() const {
+    std::string directory = std::filesystem::path(path).parent_path().string();
+    int directoryFd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directoryFd < 0) {
+        return false;
+    }
+    bool synced = fsync(directoryFd) == 0;
+    ::close(directoryFd);
+    return synced;
+}
+
+bool StorageLog::writeAll(int target, const std::string& bytes) {
+    size_t written = 0;
+    while (written < bytes.size()) {
+        ssize_t result = ::write(target, bytes.data() + written, bytes.size() - written);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        written += static_cast<size_t>(result);
+    }
+    return true;
+}